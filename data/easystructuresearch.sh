@@ -8,12 +8,29 @@ notExists() {
 	[ ! -f "$1" ]
 }
 
-if notExists "${TMP_PATH}/query.dbtype"; then
+QUERY="${TMP_PATH}/query"
+if [ -n "${QUERY_CACHE}" ] && [ -f "${QUERY_CACHE}/query.dbtype" ]; then
+    QUERY="${QUERY_CACHE}/query"
+elif notExists "${TMP_PATH}/query.dbtype"; then
     # shellcheck disable=SC2086
     "$MMSEQS" createdb "$@" "${TMP_PATH}/query" ${CREATEDB_PAR} \
         || fail "query createdb died"
 fi
 
+if [ -n "${QUERY_CACHE}" ] && notExists "${QUERY_CACHE}/query.dbtype"; then
+    mkdir -p "${QUERY_CACHE}"
+    # files are renamed into place and query.dbtype comes last, so other runs never use a partial entry
+    for DB in query query_h query_ss query_ca; do
+        for SUFFIX in "" .index .dbtype .lookup .source; do
+            NAME="${DB}${SUFFIX}"
+            if [ "${NAME}" != "query.dbtype" ] && [ -f "${TMP_PATH}/${NAME}" ]; then
+                cp -f "${TMP_PATH}/${NAME}" "${QUERY_CACHE}/${NAME}.$$" && mv -f "${QUERY_CACHE}/${NAME}.$$" "${QUERY_CACHE}/${NAME}"
+            fi
+        done
+    done
+    cp -f "${TMP_PATH}/query.dbtype" "${QUERY_CACHE}/query.dbtype.$$" && mv -f "${QUERY_CACHE}/query.dbtype.$$" "${QUERY_CACHE}/query.dbtype"
+fi
+
 if notExists "${TARGET}.dbtype"; then
     if notExists "${TMP_PATH}/target"; then
         # shellcheck disable=SC2086
@@ -27,7 +44,7 @@ fi
 INTERMEDIATE="${TMP_PATH}/result"
 if notExists "${INTERMEDIATE}.dbtype"; then
     # shellcheck disable=SC2086
-    "$MMSEQS" search "${TMP_PATH}/query" "${TARGET}" "${INTERMEDIATE}" "${TMP_PATH}/search_tmp" ${SEARCH_PAR} \
+    "$MMSEQS" search "${QUERY}" "${TARGET}" "${INTERMEDIATE}" "${TMP_PATH}/search_tmp" ${SEARCH_PAR} \
         || fail "Search died"
 fi
 
@@ -42,11 +59,17 @@ fi
 
 if notExists "${TMP_PATH}/alis.dbtype"; then
     # shellcheck disable=SC2086
-    "$MMSEQS" convertalis "${TMP_PATH}/query" "${TARGET}${INDEXEXT}" "${INTERMEDIATE}" "${RESULTS}" ${CONVERT_PAR} \
+    "$MMSEQS" convertalis "${QUERY}" "${TARGET}${INDEXEXT}" "${INTERMEDIATE}" "${RESULTS}" ${CONVERT_PAR} \
         || fail "Convert Alignments died"
 fi
 
 
+if [ -n "${TIMING_REPORT}" ] && [ -f "${TIMING_REPORT}" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" timingsummary "${TIMING_REPORT}" ${VERBOSITY} \
+        || fail "Timing summary died"
+fi
+
 if [ -n "${REMOVE_TMP}" ]; then
     if [ -n "${GREEDY_BEST_HITS}" ]; then
         # shellcheck disable=SC2086
@@ -65,14 +88,16 @@ if [ -n "${REMOVE_TMP}" ]; then
             # shellcheck disable=SC2086
             "$MMSEQS" rmdb "${TMP_PATH}/target_ss" ${VERBOSITY}
         fi
-        # shellcheck disable=SC2086
-        "$MMSEQS" rmdb "${TMP_PATH}/query" ${VERBOSITY}
-        # shellcheck disable=SC2086
-        "$MMSEQS" rmdb "${TMP_PATH}/query_h" ${VERBOSITY}
-        # shellcheck disable=SC2086
-        "$MMSEQS" rmdb "${TMP_PATH}/query_ca" ${VERBOSITY}
-        # shellcheck disable=SC2086
-        "$MMSEQS" rmdb "${TMP_PATH}/query_ss" ${VERBOSITY}
+        if [ -f "${TMP_PATH}/query.dbtype" ]; then
+            # shellcheck disable=SC2086
+            "$MMSEQS" rmdb "${TMP_PATH}/query" ${VERBOSITY}
+            # shellcheck disable=SC2086
+            "$MMSEQS" rmdb "${TMP_PATH}/query_h" ${VERBOSITY}
+            # shellcheck disable=SC2086
+            "$MMSEQS" rmdb "${TMP_PATH}/query_ca" ${VERBOSITY}
+            # shellcheck disable=SC2086
+            "$MMSEQS" rmdb "${TMP_PATH}/query_ss" ${VERBOSITY}
+        fi
     fi
     rm -rf "${TMP_PATH}/search_tmp"
     rm -f "${TMP_PATH}/easystructuresearch.sh"
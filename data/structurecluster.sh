@@ -58,7 +58,7 @@ if [ "${RUN_LINCLUST}" = "1" ]; then
   # 1. Finding exact $k$-mer matches.
   if notExists "${TMP_PATH}/pref.dbtype"; then
       # shellcheck disable=SC2086
-      $RUNNER "$MMSEQS" kmermatcher "${INPUT}_ss" "${TMP_PATH}/pref" ${KMERMATCHER_PAR} \
+      $RUNNER "$MMSEQS" structurekmermatcher "${INPUT}" "${TMP_PATH}/pref" ${KMERMATCHER_PAR} \
           || fail "kmermatcher died"
   fi
 
@@ -377,6 +377,12 @@ if [ -n "$REASSIGN" ]; then
 fi
 
 
+if [ -n "${TIMING_REPORT}" ] && [ -f "${TIMING_REPORT}" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" timingsummary "${TIMING_REPORT}" ${VERBOSITY} \
+        || fail "Timing summary died"
+fi
+
 if [ -n "$REMOVE_TMP" ]; then
     if [ "${RUN_ITERATIVE}" = "1" ]; then
       # shellcheck disable=SC2086
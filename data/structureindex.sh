@@ -19,6 +19,19 @@ TMP_PATH="$2"
 "$MMSEQS" mmcreateindex "${DB}_ss" "${TMP_PATH}" ${CREATEINDEX_PAR} --index-subset 1 \
     || fail "createindex died"
 
+CA_DB="${DB}_ca"
+if [ -n "${INDEX_PADDED_CA}" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" makepaddedcadb "${DB}" "${TMP_PATH}/ca_padded" ${THREADS_PAR} \
+        || fail "makepaddedcadb died"
+    CA_DB="${TMP_PATH}/ca_padded"
+fi
+
 # shellcheck disable=SC2086
-"$MMSEQS" appenddbtoindex "${DB}_ca" "${DB}.idx" --id-list ${INDEX_DB_CA_KEY} ${VERBOSITY_PAR} \
+"$MMSEQS" appenddbtoindex "${CA_DB}" "${DB}.idx" --id-list ${INDEX_DB_CA_KEY} ${VERBOSITY_PAR} \
     || fail "appenddbtoindex died"
+
+if [ -n "${REMOVE_TMP}" ] && [ -n "${INDEX_PADDED_CA}" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" rmdb "${TMP_PATH}/ca_padded" ${VERBOSITY_PAR}
+fi
@@ -93,6 +93,12 @@ while [ "$STEP" -lt "$NUM_IT" ]; do
 	STEP=$((STEP+1))
 done
 
+if [ -n "${TIMING_REPORT}" ] && [ -f "${TIMING_REPORT}" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" timingsummary "${TIMING_REPORT}" ${VERBOSITY} \
+        || fail "Timing summary died"
+fi
+
 if [ -n "$REMOVE_TMP" ]; then
     STEP=0
     while [ "${STEP}" -lt "${NUM_IT}" ]; do
@@ -12,7 +12,7 @@ notExists() {
 # 1. Finding exact $k$-mer matches.
 if notExists "${TMP_PATH}/pref.dbtype"; then
     # shellcheck disable=SC2086
-    $RUNNER "$MMSEQS" prefilter "${QUERY_PREFILTER}" "${TARGET_PREFILTER}${INDEXEXT}" "${TMP_PATH}/pref" ${PREFILTER_PAR} \
+    $RUNNER "$MMSEQS" $PREFILTER_ALGO "${QUERY_PREFILTER}" "${TARGET_PREFILTER}${INDEXEXT}" "${TMP_PATH}/pref" ${PREFILTER_PAR} \
         || fail "Kmer matching step died"
 fi
 
@@ -48,6 +48,12 @@ fi
 # shellcheck disable=SC2086
 "$MMSEQS" mvdb "${TMP_PATH}/aln" "${RESULTS}" ${VERBOSITY}
 
+if [ -n "${TIMING_REPORT}" ] && [ -f "${TIMING_REPORT}" ]; then
+    # shellcheck disable=SC2086
+    "$MMSEQS" timingsummary "${TIMING_REPORT}" ${VERBOSITY} \
+        || fail "Timing summary died"
+fi
+
 if [ -n "$REMOVE_TMP" ]; then
     echo "Removing temporary files"
     # shellcheck disable=SC2086
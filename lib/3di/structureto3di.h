@@ -100,10 +100,20 @@ public:
         }
     };
 
-    std::vector<Feature> getFeatures(){
+    // valid for the chain of the last structure2states call
+    const std::vector<Feature> & getFeatures() const {
         return features;
     }
 
+    const std::vector<Embedding> & getEmbeddings() const {
+        return embeddings;
+    }
+
+    // residues without conformational descriptors are false, their features and embeddings are not initialized
+    const std::vector<bool> & getMask() const {
+        return mask;
+    }
+
 private:
     // Encoding
     KerasModel encoder;
@@ -681,7 +681,7 @@ std::vector<Command> baseCommands = {
 
 
 
-        {"compress",             compress,             &par.onlythreads,          COMMAND_STORAGE,
+        {"compress",             compress,             &par.compressdb,           COMMAND_STORAGE,
                 "Compress DB entries",
                 NULL,
                 "Milot Mirdita <milot@mirdita.de>",
@@ -3,6 +3,7 @@
 #include "Matcher.h"
 #include "Util.h"
 #include "Parameters.h"
+#include "DBReader.h"
 #include "StripedSmithWaterman.h"
 
 
@@ -147,11 +148,183 @@ void Matcher::readAlignmentResults(std::vector<result_t> &result, char *data, bo
     }
 
     while(*data != '\0'){
+        if (isBinaryResultBlock(data)) {
+            const size_t count = binaryResultCount(data);
+            for (size_t i = 0; i < count; i++) {
+                result.emplace_back(parseBinaryRecord(data, i, readCompressed));
+            }
+            data = const_cast<char *>(skipBinaryResultBlock(data));
+            continue;
+        }
         result.emplace_back(parseAlignmentRecord(data, readCompressed));
         data = Util::skipLine(data);
     }
 }
 
+static inline uint32_t readBinaryHeaderField(const char *data, size_t field) {
+    uint32_t value;
+    memcpy(&value, data + 4 + field * sizeof(uint32_t), sizeof(uint32_t));
+    return value;
+}
+
+// header fields after the magic
+enum { BINARY_HEADER_SCHEMA = 0, BINARY_HEADER_RECORD_SIZE, BINARY_HEADER_COUNT, BINARY_HEADER_BLOB_SIZE };
+
+size_t Matcher::binaryResultCount(const char *data) {
+    return readBinaryHeaderField(data, BINARY_HEADER_COUNT);
+}
+
+void Matcher::checkTextResultDbtype(int dbtype, const std::string &dbName) {
+    if (DBReader<unsigned int>::getExtendedDbtype(dbtype) & Parameters::DBTYPE_EXTENDED_BINARY_ALIGNMENT) {
+        Debug(Debug::ERROR) << "Database " << dbName << " contains binary alignment results, which this module cannot read. "
+                            << "Recompute it with --binary-alignment-db 0\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+
+Matcher::result_bin_t Matcher::binaryResultAt(const char *data, size_t i) {
+    const size_t recordSize = readBinaryHeaderField(data, BINARY_HEADER_RECORD_SIZE);
+    result_bin_t record;
+    memset(&record, 0, sizeof(result_bin_t));
+    // newer writers may append columns to the record
+    memcpy(&record, data + BINARY_RESULT_HEADER_SIZE + i * recordSize, std::min(recordSize, sizeof(result_bin_t)));
+    return record;
+}
+
+const char *Matcher::skipBinaryResultBlock(const char *data) {
+    return data + BINARY_RESULT_HEADER_SIZE
+           + static_cast<size_t>(readBinaryHeaderField(data, BINARY_HEADER_RECORD_SIZE)) * readBinaryHeaderField(data, BINARY_HEADER_COUNT)
+           + readBinaryHeaderField(data, BINARY_HEADER_BLOB_SIZE);
+}
+
+size_t Matcher::countAlignmentResults(const char *data, size_t length) {
+    const char *end = data + length;
+    size_t count = 0;
+    while (data < end) {
+        if (static_cast<size_t>(end - data) >= BINARY_RESULT_HEADER_SIZE && isBinaryResultBlock(data)) {
+            count += binaryResultCount(data);
+            data = skipBinaryResultBlock(data);
+            continue;
+        }
+        const char *newline = static_cast<const char *>(memchr(data, '\n', end - data));
+        if (newline == NULL) {
+            break;
+        }
+        count++;
+        data = newline + 1;
+    }
+    return count;
+}
+
+Matcher::result_t Matcher::parseBinaryRecord(const char *data, size_t i, bool readCompressed) {
+    const uint32_t schema = readBinaryHeaderField(data, BINARY_HEADER_SCHEMA);
+    const result_bin_t record = binaryResultAt(data, i);
+    // same derived values as parseAlignmentRecord
+    int adjustQstart = (record.qStartPos == -1) ? 0 : record.qStartPos;
+    int adjustDBstart = (record.dbStartPos == -1) ? 0 : record.dbStartPos;
+    double qCov = SmithWaterman::computeCov(adjustQstart, record.qEndPos, record.qLen);
+    double dbCov = SmithWaterman::computeCov(adjustDBstart, record.dbEndPos, record.dbLen);
+    size_t alnLength = Matcher::computeAlnLength(adjustQstart, record.qEndPos, adjustDBstart, record.dbEndPos);
+    std::string backtrace;
+    if (schema & BINARY_RESULT_BACKTRACE) {
+        const char *blob = data + BINARY_RESULT_HEADER_SIZE
+                           + static_cast<size_t>(readBinaryHeaderField(data, BINARY_HEADER_RECORD_SIZE)) * readBinaryHeaderField(data, BINARY_HEADER_COUNT);
+        backtrace.assign(blob + record.backtraceOffset, record.backtraceLength);
+        if (readCompressed == false) {
+            backtrace = uncompressAlignment(backtrace);
+        }
+    }
+    const bool hasOrf = (schema & BINARY_RESULT_ORF_POSITION) != 0;
+    return Matcher::result_t(record.dbKey, record.score, qCov, dbCov, record.seqId, record.eval,
+                             alnLength, record.qStartPos, record.qEndPos, record.qLen, record.dbStartPos, record.dbEndPos,
+                             record.dbLen,
+                             hasOrf ? record.queryOrfStartPos : -1, hasOrf ? record.queryOrfEndPos : -1,
+                             hasOrf ? record.dbOrfStartPos : -1, hasOrf ? record.dbOrfEndPos : -1,
+                             backtrace);
+}
+
+void Matcher::resultsToBinaryBuffer(std::string &buffer, const std::vector<result_t> &results, bool addBacktrace,
+                                    bool compress, bool addOrfPosition) {
+    // empty entries stay empty, like in the text format
+    if (results.empty()) {
+        return;
+    }
+    const size_t start = buffer.size();
+    const size_t recordStart = start + BINARY_RESULT_HEADER_SIZE;
+    buffer.resize(recordStart + results.size() * sizeof(result_bin_t));
+    const size_t blobStart = buffer.size();
+    for (size_t i = 0; i < results.size(); i++) {
+        const result_t &res = results[i];
+        result_bin_t record;
+        // zero the padding to get reproducible output
+        memset(&record, 0, sizeof(result_bin_t));
+        record.eval = res.eval;
+        record.dbKey = res.dbKey;
+        record.score = res.score;
+        // the text format writes seqId with 3 digits (see Util::fastSeqIdToBuffer)
+        record.seqId = (res.seqId == 1.0) ? 1.0f : static_cast<float>(static_cast<int>(res.seqId * 1000) / 1000.0);
+        record.qStartPos = res.qStartPos;
+        record.qEndPos = res.qEndPos;
+        record.qLen = res.qLen;
+        record.dbStartPos = res.dbStartPos;
+        record.dbEndPos = res.dbEndPos;
+        record.dbLen = res.dbLen;
+        record.queryOrfStartPos = addOrfPosition ? res.queryOrfStartPos : -1;
+        record.queryOrfEndPos = addOrfPosition ? res.queryOrfEndPos : -1;
+        record.dbOrfStartPos = addOrfPosition ? res.dbOrfStartPos : -1;
+        record.dbOrfEndPos = addOrfPosition ? res.dbOrfEndPos : -1;
+        if (addBacktrace) {
+            record.backtraceOffset = static_cast<uint32_t>(buffer.size() - blobStart);
+            if (compress) {
+                buffer.append(Matcher::compressAlignment(res.backtrace));
+            } else {
+                buffer.append(res.backtrace);
+            }
+            record.backtraceLength = static_cast<uint32_t>(buffer.size() - blobStart - record.backtraceOffset);
+        }
+        memcpy(&buffer[recordStart + i * sizeof(result_bin_t)], &record, sizeof(result_bin_t));
+    }
+    const uint32_t header[4] = {
+        (addOrfPosition ? BINARY_RESULT_ORF_POSITION : 0) | (addBacktrace ? BINARY_RESULT_BACKTRACE : 0),
+        static_cast<uint32_t>(sizeof(result_bin_t)),
+        static_cast<uint32_t>(results.size()),
+        static_cast<uint32_t>(buffer.size() - blobStart)
+    };
+    memcpy(&buffer[start], "\x01" "ALN", 4);
+    memcpy(&buffer[start + 4], header, sizeof(header));
+}
+
+void Matcher::binaryRecordsToBuffer(std::string &buffer, const std::vector<std::pair<const char *, size_t>> &records) {
+    if (records.empty()) {
+        return;
+    }
+    const uint32_t schema = readBinaryHeaderField(records[0].first, BINARY_HEADER_SCHEMA);
+    const size_t start = buffer.size();
+    const size_t recordStart = start + BINARY_RESULT_HEADER_SIZE;
+    buffer.resize(recordStart + records.size() * sizeof(result_bin_t));
+    const size_t blobStart = buffer.size();
+    for (size_t i = 0; i < records.size(); i++) {
+        const char *block = records[i].first;
+        result_bin_t record = binaryResultAt(block, records[i].second);
+        if (schema & BINARY_RESULT_BACKTRACE) {
+            const char *blob = block + BINARY_RESULT_HEADER_SIZE
+                               + static_cast<size_t>(readBinaryHeaderField(block, BINARY_HEADER_RECORD_SIZE)) * readBinaryHeaderField(block, BINARY_HEADER_COUNT);
+            const size_t backtraceOffset = buffer.size() - blobStart;
+            buffer.append(blob + record.backtraceOffset, record.backtraceLength);
+            record.backtraceOffset = static_cast<uint32_t>(backtraceOffset);
+        }
+        memcpy(&buffer[recordStart + i * sizeof(result_bin_t)], &record, sizeof(result_bin_t));
+    }
+    const uint32_t header[4] = {
+        schema,
+        static_cast<uint32_t>(sizeof(result_bin_t)),
+        static_cast<uint32_t>(records.size()),
+        static_cast<uint32_t>(buffer.size() - blobStart)
+    };
+    memcpy(&buffer[start], "\x01" "ALN", 4);
+    memcpy(&buffer[start + 4], header, sizeof(header));
+}
+
 int Matcher::computeAlnLength(int qStart, int qEnd, int dbStart, int dbEnd) {
     return std::max(abs(qEnd - qStart), abs(dbEnd - dbStart)) + 1;
 }
@@ -10,6 +10,8 @@
 #include <cfloat>
 #include <algorithm>
 #include <vector>
+#include <string>
+#include <stdint.h>
 #include "itoa.h"
 
 #include "Sequence.h"
@@ -218,6 +220,63 @@ public:
 
     static size_t resultToBuffer(char * buffer, const result_t &result, bool addBacktrace, bool compress  = true, bool addOrfPosition = false);
 
+    // Binary alignment results: an entry consists of one or more blocks (e.g. after mergedbs) of
+    // BINARY_RESULT_HEADER_SIZE bytes header (magic, column schema, record size, record count, blob size),
+    // the fixed width records and a blob with the backtraces. Records are decoded with the same
+    // semantics as the text format (seqId has 3 digits, coverage and alnLength follow from the positions),
+    // only e-values keep their full precision. Text entries and binary blocks can be mixed in one entry.
+    struct result_bin_t {
+        double eval;
+        uint32_t dbKey;
+        int32_t score;
+        float seqId;
+        int32_t qStartPos;
+        int32_t qEndPos;
+        uint32_t qLen;
+        int32_t dbStartPos;
+        int32_t dbEndPos;
+        uint32_t dbLen;
+        int32_t queryOrfStartPos;
+        int32_t queryOrfEndPos;
+        int32_t dbOrfStartPos;
+        int32_t dbOrfEndPos;
+        // position and length of the backtrace in the blob of the block
+        uint32_t backtraceOffset;
+        uint32_t backtraceLength;
+    };
+    // column schema of a block
+    static const unsigned int BINARY_RESULT_ORF_POSITION = 1;
+    static const unsigned int BINARY_RESULT_BACKTRACE = 2;
+    static const size_t BINARY_RESULT_HEADER_SIZE = 20;
+
+    static void resultsToBinaryBuffer(std::string &buffer, const std::vector<result_t> &results, bool addBacktrace,
+                                      bool compress = true, bool addOrfPosition = false);
+
+    static bool isBinaryResultBlock(const char *data) {
+        return data[0] == '\x01' && data[1] == 'A' && data[2] == 'L' && data[3] == 'N';
+    }
+
+    // number of records in the block starting at data
+    static size_t binaryResultCount(const char *data);
+
+    // record i of the block starting at data
+    static result_bin_t binaryResultAt(const char *data, size_t i);
+
+    // exits if dbtype marks binary alignment results, for tools that only parse text results
+    static void checkTextResultDbtype(int dbtype, const std::string &dbName);
+
+    // first byte after the block starting at data
+    static const char *skipBinaryResultBlock(const char *data);
+
+    // number of alignment records of a text, binary or mixed entry, equal to Util::countLines for text
+    static size_t countAlignmentResults(const char *data, size_t length);
+
+    static result_t parseBinaryRecord(const char *data, size_t i, bool readCompressed = false);
+
+    // writes the records (block, record index) as one block into buffer, the records and their backtraces
+    // are copied verbatim. All blocks have to use the same column schema.
+    static void binaryRecordsToBuffer(std::string &buffer, const std::vector<std::pair<const char *, size_t>> &records);
+
     static int computeAlnLength(int anEnd, int start, int dbEnd, int dbStart);
 
     static void updateResultByRescoringBacktrace(const char *querySeq, const char *targetSeq, const char **subMat, EvalueComputation &evaluer,
@@ -177,7 +177,7 @@ int doRescorediagonal(Parameters &par,
                             queryRevSeq[(queryLen - 1) - pos] = subMat->num2aa[nuclMatrix->reverseResidue(res)];
                         }
                     }
-                    if (sameQTDB && qdbr->isCompressed()) {
+                    if (sameQTDB && (qdbr->isCompressed() || qdbr->isPacked())) {
                         queryBuffer.clear();
                         queryBuffer.append(querySeq, queryLen);
                         querySeq = (char *) queryBuffer.c_str();
@@ -9,7 +9,9 @@
 #include "Util.h"
 #include "Debug.h"
 #include "FastSort.h"
+#include "Matcher.h"
 #include <cmath>
+#include <vector>
 
 #ifdef OPENMP
 #include <omp.h>
@@ -17,6 +19,20 @@
 
 #define LEN(x, y) (x[y+1] - x[y])
 
+static bool compareLinkId(const std::pair<unsigned int, unsigned short> &a, const std::pair<unsigned int, unsigned short> &b) {
+    return a.first < b.first;
+}
+
+// start of a column, so numbers can be parsed in place without copying the field
+static inline const char *columnStart(const char *data, int position) {
+    for (int i = 0; i < position; ++i) {
+        data += Util::skipNoneWhitespace(data);
+        data += Util::skipWhitespace(data);
+    }
+    // atof/atoi would skip the line break of an empty field
+    return (*data == '\n') ? "" : data;
+}
+
 void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsigned int>*seqDbr,
                                    unsigned int **elementLookupTable, unsigned short **elementScoreTable,
                                    int scoretype, size_t *offsets) {
@@ -66,34 +82,62 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
                 size_t setSize = LEN(offsets, i);
                 size_t writePos = 0;
                 while (*data != '\0') {
+                    if (Matcher::isBinaryResultBlock(data)) {
+                        const size_t count = Matcher::binaryResultCount(data);
+                        if (writePos + count > setSize) {
+                            Debug(Debug::ERROR) << "Set " << i
+                                                << " has more elements than allocated (" << setSize
+                                                << ")!\n";
+                            EXIT(EXIT_FAILURE);
+                        }
+                        for (size_t j = 0; j < count; j++) {
+                            const Matcher::result_bin_t record = Matcher::binaryResultAt(data, j);
+                            const size_t currElement = seqDbr->getId(record.dbKey);
+                            if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
+                                Debug(Debug::ERROR) << "Element " << record.dbKey
+                                                    << " contained in some alignment list, but not contained in the sequence database!\n";
+                                EXIT(EXIT_FAILURE);
+                            }
+                            if (elementScoreTable != NULL) {
+                                // same scores as parsed from the text columns
+                                if (Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_CLUSTER_RES)) {
+                                    elementScoreTable[i][writePos] = (unsigned short) (USHRT_MAX);
+                                } else if (scoretype == Parameters::APC_ALIGNMENTSCORE) {
+                                    elementScoreTable[i][writePos] = (unsigned short) (static_cast<double>(record.score));
+                                } else {
+                                    // seqId is stored with 3 digits
+                                    const double seqId = static_cast<int>(record.seqId * 1000.0f + 0.5f) / 1000.0;
+                                    elementScoreTable[i][writePos] = (unsigned short) (seqId * 1000.0f);
+                                }
+                            }
+                            elementLookupTable[i][writePos] = currElement;
+                            writePos++;
+                        }
+                        data = const_cast<char *>(Matcher::skipBinaryResultBlock(data));
+                        continue;
+                    }
                     if (writePos >= setSize) {
                         Debug(Debug::ERROR) << "Set " << i
                                             << " has more elements than allocated (" << setSize
                                             << ")!\n";
                         continue;
                     }
-                    char similarity[255 + 1];
-                    char dbKey[255 + 1];
-                    Util::parseKey(data, dbKey);
-                    const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+                    const unsigned int key = (unsigned int) strtoul(data, NULL, 10);
                     const size_t currElement = seqDbr->getId(key);
                     if (elementScoreTable != NULL) {
                         if (Parameters::isEqualDbtype(alnType,Parameters::DBTYPE_ALIGNMENT_RES)) {
                             if (scoretype == Parameters::APC_ALIGNMENTSCORE) {
                                 //column 1 = alignment score
-                                Util::parseByColumnNumber(data, similarity, 1);
-                                elementScoreTable[i][writePos] = (unsigned short) (atof(similarity));
+                                elementScoreTable[i][writePos] = (unsigned short) (atof(columnStart(data, 1)));
                             } else {
                                 //column 2 = sequence identity [0-1]
-                                Util::parseByColumnNumber(data, similarity, 2);
-                                elementScoreTable[i][writePos] = (unsigned short) (atof(similarity) * 1000.0f);
+                                elementScoreTable[i][writePos] = (unsigned short) (atof(columnStart(data, 2)) * 1000.0f);
                             }
                         }
                         else if (Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_PREFILTER_RES) ||
                                  Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_PREFILTER_REV_RES)) {
                             //column 1 = alignment score or sequence identity [0-100]
-                            Util::parseByColumnNumber(data, similarity, 1);
-                            short sim = atoi(similarity);
+                            short sim = atoi(columnStart(data, 1));
                             elementScoreTable[i][writePos] = (unsigned short) (sim >0 ? sim : -sim);
                         }
                         else if (Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_CLUSTER_RES)) {
@@ -106,7 +150,7 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
 
                     }
                     if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                        Debug(Debug::ERROR) << "Element " << dbKey
+                        Debug(Debug::ERROR) << "Element " << key
                                             << " contained in some alignment list, but not contained in the sequence database!\n";
                         EXIT(EXIT_FAILURE);
                     }
@@ -164,15 +208,12 @@ size_t AlignmentSymmetry::findMissingLinks(unsigned int ** elementLookupTable, s
     return symmetricElementCount;
 }
 
-void AlignmentSymmetry::addMissingLinks(unsigned int **elementLookupTable,
+void AlignmentSymmetry::addMissingLinks(unsigned int **elementLookupTable, unsigned int **sortedLookupTable,
                                         size_t * offsetTableWithOutNewLinks, size_t * offsetTableWithNewLinks, size_t dbSize, unsigned short **elementScoreTable) {
-
-    // iterate over all connections and check if it exists in the corresponding set
-    // if not add it
-    Debug::Progress progress(dbSize);
-
-    for(size_t setId = 0; setId < dbSize; setId++) {
-        progress.updateProgress();
+    // next free position in the new links part of every set
+    size_t *writePos = new(std::nothrow) size_t[dbSize];
+    Util::checkAllocation(writePos, "Can not allocate memory in addMissingLinks");
+    for (size_t setId = 0; setId < dbSize; setId++) {
         const size_t oldElementSize = LEN(offsetTableWithOutNewLinks, setId);
         const size_t newElementSize = LEN(offsetTableWithNewLinks, setId);
         if(oldElementSize > newElementSize){
@@ -181,34 +222,62 @@ void AlignmentSymmetry::addMissingLinks(unsigned int **elementLookupTable,
                                    " OldElementSize(" << oldElementSize <<") in addMissingLinks";
             EXIT(EXIT_FAILURE);
         }
+        writePos[setId] = oldElementSize;
+    }
+
+    // iterate over all connections and check if it exists in the corresponding set
+    // if not add it
+    Debug::Progress progress(dbSize);
+#pragma omp parallel for schedule(dynamic, 1000)
+    for(size_t setId = 0; setId < dbSize; setId++) {
+        progress.updateProgress();
+        const size_t oldElementSize = LEN(offsetTableWithOutNewLinks, setId);
         for(size_t elementId = 0; elementId < oldElementSize; elementId++) {
             const unsigned int currElm = elementLookupTable[setId][elementId];
             if(currElm == UINT_MAX || currElm > dbSize){
                 Debug(Debug::ERROR) << "currElm > dbSize in element list (addMissingLinks). This should not happen.\n";
                 EXIT(EXIT_FAILURE);
             }
-            const unsigned int oldCurrElementSize = LEN(offsetTableWithOutNewLinks, currElm);
-            const unsigned int newCurrElementSize = LEN(offsetTableWithNewLinks, currElm);
-
-            bool found = false;
+            const size_t oldCurrElementSize = LEN(offsetTableWithOutNewLinks, currElm);
+            const size_t newCurrElementSize = LEN(offsetTableWithNewLinks, currElm);
             // check if setId is already in set of currElm
-            for(size_t pos = 0; pos < oldCurrElementSize && found == false; pos++){
-                found = (elementLookupTable[currElm][pos] == setId);
-            }
+            const bool found = std::binary_search(sortedLookupTable[currElm],
+                                                  sortedLookupTable[currElm] + oldCurrElementSize, setId);
             // this is a new connection
-            if(found == false){ // add connection if it could not be found
-                // find pos to write
-                size_t pos = oldCurrElementSize;
-                while( pos < newCurrElementSize && elementLookupTable[currElm][pos] != UINT_MAX ){
-                    pos++;
-                }
-
+            if(found == false){
+                const size_t pos = __sync_fetch_and_add(&writePos[currElm], 1);
                 if(pos >= newCurrElementSize){
                     Debug(Debug::ERROR) << "pos(" << pos << ") > newCurrElementSize(" << newCurrElementSize << "). This should not happen.\n";
                     EXIT(EXIT_FAILURE);
                 }
                 elementLookupTable[currElm][pos] = setId;
-                elementScoreTable[currElm][pos]=elementScoreTable[setId][elementId];
+                elementScoreTable[currElm][pos] = elementScoreTable[setId][elementId];
+            }
+        }
+    }
+    delete[] writePos;
+
+    // threads append the new links in any order, restore the order of a sequential pass (ascending setId)
+#pragma omp parallel
+    {
+        std::vector<std::pair<unsigned int, unsigned short>> links;
+#pragma omp for schedule(dynamic, 1000)
+        for (size_t setId = 0; setId < dbSize; setId++) {
+            const size_t oldElementSize = LEN(offsetTableWithOutNewLinks, setId);
+            const size_t newElementSize = LEN(offsetTableWithNewLinks, setId);
+            if (newElementSize - oldElementSize < 2
+                || std::is_sorted(elementLookupTable[setId] + oldElementSize, elementLookupTable[setId] + newElementSize)) {
+                continue;
+            }
+            links.clear();
+            for (size_t pos = oldElementSize; pos < newElementSize; pos++) {
+                links.emplace_back(elementLookupTable[setId][pos], elementScoreTable[setId][pos]);
+            }
+            // stable: repeated links of one set keep their order
+            std::stable_sort(links.begin(), links.end(), compareLinkId);
+            for (size_t i = 0; i < links.size(); i++) {
+                elementLookupTable[setId][oldElementSize + i] = links[i].first;
+                elementScoreTable[setId][oldElementSize + i] = links[i].second;
             }
         }
     }
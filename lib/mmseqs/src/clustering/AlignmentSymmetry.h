@@ -25,7 +25,8 @@ public:
         }
     }
     static size_t findMissingLinks(unsigned int **elementLookupTable, size_t *offsetTable, size_t dbSize, int threads);
-    static void addMissingLinks(unsigned int **elementLookupTable, size_t *offsetTable, size_t * newOffset, size_t dbSize,unsigned short**elementScoreTable);
+    // sortedLookupTable holds the same sets as elementLookupTable (without new links) sorted by id
+    static void addMissingLinks(unsigned int **elementLookupTable, unsigned int **sortedLookupTable, size_t *offsetTable, size_t * newOffset, size_t dbSize,unsigned short**elementScoreTable);
     static void sortElements(unsigned int **elementLookupTable, size_t *offsets, size_t dbSize);
 
     template <typename T>
@@ -6,6 +6,12 @@
 #include "Timer.h"
 #include "SequenceWeights.h"
 
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
 Clustering::Clustering(const std::string &seqDB, const std::string &seqDBIndex,
                        const std::string &alnDB, const std::string &alnDBIndex,
                        const std::string &outDB, const std::string &outDBIndex,
@@ -49,7 +55,7 @@ Clustering::~Clustering() {
 
 void Clustering::run(int mode) {
     Timer timer;
-    DBWriter *dbw = new DBWriter(outDB.c_str(), outDBIndex.c_str(), 1, compressed, Parameters::DBTYPE_CLUSTER_RES);
+    DBWriter *dbw = new DBWriter(outDB.c_str(), outDBIndex.c_str(), threads, compressed, Parameters::DBTYPE_CLUSTER_RES);
     dbw->open();
 
     std::pair<unsigned int, unsigned int> * ret;
@@ -93,7 +99,8 @@ void Clustering::run(int mode) {
     delete [] ret;
     delete algorithm;
 
-    dbw->close(false, false);
+    // every thread wrote a contiguous range of clusters, merging in thread order keeps the sequential order
+    dbw->close(true, false);
     seqDbr->close();
     alnDbr->close();
     delete dbw;
@@ -101,32 +108,42 @@ void Clustering::run(int mode) {
 }
 
 void Clustering::writeData(DBWriter *dbw, const std::pair<unsigned int, unsigned int> * ret, size_t dbSize) {
-    std::string resultStr;
-    resultStr.reserve(1024*1024*1024);
-    char buffer[32];
-    unsigned int prevRepresentativeKey = UINT_MAX;
-    for(size_t i = 0; i < dbSize; i++){
-        unsigned int currRepresentativeKey = ret[i].first;
-        // write query key first
-        if(prevRepresentativeKey != currRepresentativeKey) {
-            if(prevRepresentativeKey != UINT_MAX){ // skip first
-                dbw->writeData(resultStr.c_str(), resultStr.length(), prevRepresentativeKey);
-            }
+    // ret is sorted by representative, each cluster is a run of equal representatives
+    std::vector<size_t> clusterStart;
+    for (size_t i = 0; i < dbSize; i++) {
+        if (i == 0 || ret[i].first != ret[i - 1].first) {
+            clusterStart.push_back(i);
+        }
+    }
+    clusterStart.push_back(dbSize);
+    const size_t clusterCount = clusterStart.size() - 1;
+
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+        std::string resultStr;
+        resultStr.reserve(1024 * 1024);
+        char buffer[32];
+        // static schedule: thread t writes the t-th contiguous block of clusters
+#pragma omp for schedule(static)
+        for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+            const unsigned int representativeKey = ret[clusterStart[cluster]].first;
             resultStr.clear();
-            char *outpos = Itoa::u32toa_sse2(currRepresentativeKey, buffer);
+            char *outpos = Itoa::u32toa_sse2(representativeKey, buffer);
             resultStr.append(buffer, (outpos - buffer - 1));
             resultStr.push_back('\n');
+            for (size_t i = clusterStart[cluster]; i < clusterStart[cluster + 1]; i++) {
+                unsigned int memberKey = ret[i].second;
+                if (memberKey != representativeKey) {
+                    outpos = Itoa::u32toa_sse2(memberKey, buffer);
+                    resultStr.append(buffer, (outpos - buffer - 1));
+                    resultStr.push_back('\n');
+                }
+            }
+            dbw->writeData(resultStr.c_str(), resultStr.length(), representativeKey, thread_idx);
         }
-        unsigned int memberKey = ret[i].second;
-        if(memberKey != currRepresentativeKey){
-            char * outpos = Itoa::u32toa_sse2(memberKey, buffer);
-            resultStr.append(buffer, (outpos - buffer - 1) );
-            resultStr.push_back('\n');
-        }
-
-        prevRepresentativeKey = currRepresentativeKey;
-    }
-    if(prevRepresentativeKey != UINT_MAX){
-        dbw->writeData(resultStr.c_str(), resultStr.length(), prevRepresentativeKey);
     }
 }
@@ -3,6 +3,7 @@
 #include "Debug.h"
 #include "AlignmentSymmetry.h"
 #include "Timer.h"
+#include "Matcher.h"
 
 #include <queue>
 #include <algorithm>
@@ -57,10 +58,10 @@ std::pair<unsigned int, unsigned int> * ClusteringAlgorithms::execute(int mode)
             for (size_t i = 0; i < alnDbr->getSize(); i++) {
                 const char *data = alnDbr->getData(i, thread_idx);
                 const size_t dataSize = alnDbr->getEntryLen(i);
-                elementCount += (*data == '\0') ? 1 : Util::countLines(data, dataSize);
+                elementCount += (*data == '\0') ? 1 : Matcher::countAlignmentResults(data, dataSize);
             }
         }
-        unsigned int * elements = new(std::nothrow) unsigned int[elementCount];
+        unsigned int * elements = (unsigned int *) malloc(elementCount * sizeof(unsigned int));
         Util::checkAllocation(elements, "Can not allocate elements memory in ClusteringAlgorithms::execute");
         unsigned int ** elementLookupTable = new(std::nothrow) unsigned int*[dbSize];
         Util::checkAllocation(elementLookupTable, "Can not allocate elementLookupTable memory in ClusteringAlgorithms::execute");
@@ -116,10 +117,10 @@ std::pair<unsigned int, unsigned int> * ClusteringAlgorithms::execute(int mode)
 
 
         delete [] elementLookupTable;
-        delete [] elements;
+        free(elements);
         delete [] elementOffsets;
         delete [] scoreLookupTable;
-        delete [] score;
+        free(score);
         delete [] bestscore;
     }
 
@@ -296,25 +297,35 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
             const size_t alnId = alnDbr->getId(clusterKey);
             char *data = alnDbr->getData(alnId, thread_idx);
 
+            // next record if data points to a binary result block
+            size_t binaryPos = 0;
             while (*data != '\0') {
-                char dbKey[255 + 1];
-                Util::parseKey(data, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
-
+                unsigned int key;
+                if (Matcher::isBinaryResultBlock(data)) {
+                    if (binaryPos >= Matcher::binaryResultCount(data)) {
+                        data = const_cast<char *>(Matcher::skipBinaryResultBlock(data));
+                        binaryPos = 0;
+                        continue;
+                    }
+                    key = Matcher::binaryResultAt(data, binaryPos).dbKey;
+                    binaryPos++;
+                } else {
+                    key = (unsigned int) strtoul(data, NULL, 10);
+                    data = Util::skipLine(data);
+                }
                 unsigned int currElement = seqDbr->getId(key);
+                if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
+                    Debug(Debug::ERROR) << "Element " << key
+                                        << " contained in some alignment list, but not contained in the sequence database!\n";
+                    EXIT(EXIT_FAILURE);
+                }
+
                 unsigned int targetId;
 
                 __atomic_load(&assignedcluster[currElement], &targetId ,__ATOMIC_RELAXED);
                 do {
                     if (targetId <= clusterId) break;
                 } while (!__atomic_compare_exchange(&assignedcluster[currElement],  &targetId,  &clusterId , false,  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
-
-                if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                    Debug(Debug::ERROR) << "Element " << dbKey
-                                        << " contained in some alignment list, but not contained in the sequence database!\n";
-                    EXIT(EXIT_FAILURE);
-                }
-                data = Util::skipLine(data);
             }
         }
     }
@@ -347,47 +358,57 @@ void ClusteringAlgorithms::readInClusterData(unsigned int **elementLookupTable,
             const size_t alnId = alnDbr->getId(clusterId);
             const char *data = alnDbr->getData(alnId, thread_idx);
             const size_t dataSize = alnDbr->getEntryLen(alnId);
-            elementOffsets[i] = (*data == '\0') ? 1 : Util::countLines(data, dataSize);
+            elementOffsets[i] = (*data == '\0') ? 1 : Matcher::countAlignmentResults(data, dataSize);
         }
     }
 
     // make offset table
     AlignmentSymmetry::computeOffsetFromCounts(elementOffsets, dbSize);
-    // set element edge pointers by using the offset table
-    AlignmentSymmetry::setupPointers<unsigned int>(elements, elementLookupTable, elementOffsets, dbSize,
-                                                   totalElementCount);
-    // fill elements
-    AlignmentSymmetry::readInData(alnDbr, seqDbr, elementLookupTable, NULL, 0, elementOffsets);
+    // the alignment text is parsed only once into binary edges (element id and score) in the original order
+    scores = (unsigned short *) malloc(totalElementCount * sizeof(unsigned short));
+    Util::checkAllocation(scores, "Can not allocate scores memory in readInClusterData");
+    AlignmentSymmetry::setupPointers<unsigned int>  (elements, elementLookupTable, elementOffsets, dbSize, totalElementCount);
+    AlignmentSymmetry::setupPointers<unsigned short>(scores, scoreLookupTable, elementOffsets, dbSize, totalElementCount);
+    AlignmentSymmetry::readInData(alnDbr, seqDbr, elementLookupTable, scoreLookupTable, scoretype, elementOffsets);
+    alnDbr->remapData(); // need to free memory
+
     Debug(Debug::INFO) << "Sort entries\n";
-    AlignmentSymmetry::sortElements(elementLookupTable, elementOffsets, dbSize);
+    // sorted copy of the element ids for the membership tests
+    unsigned int *sortedElements = (unsigned int *) malloc(totalElementCount * sizeof(unsigned int));
+    Util::checkAllocation(sortedElements, "Can not allocate sortedElements memory in readInClusterData");
+    memcpy(sortedElements, elements, totalElementCount * sizeof(unsigned int));
+    unsigned int **sortedLookupTable = new(std::nothrow) unsigned int*[dbSize];
+    Util::checkAllocation(sortedLookupTable, "Can not allocate sortedLookupTable memory in readInClusterData");
+    AlignmentSymmetry::setupPointers<unsigned int>(sortedElements, sortedLookupTable, elementOffsets, dbSize, totalElementCount);
+    AlignmentSymmetry::sortElements(sortedLookupTable, elementOffsets, dbSize);
     Debug(Debug::INFO) << "Find missing connections\n";
 
     size_t *newElementOffsets = new size_t[dbSize + 1];
     memcpy(newElementOffsets, elementOffsets, sizeof(size_t) * (dbSize + 1));
 
     // findMissingLinks detects new possible connections and updates the elementOffsets with new sizes
-    const size_t symmetricElementCount = AlignmentSymmetry::findMissingLinks(elementLookupTable,
+    const size_t symmetricElementCount = AlignmentSymmetry::findMissingLinks(sortedLookupTable,
                                                                              newElementOffsets, dbSize,
                                                                              threads);
-    // resize elements
-    delete[] elements;
-    elements = new(std::nothrow) unsigned int[symmetricElementCount];
+    Debug(Debug::INFO) << "Found " << symmetricElementCount - totalElementCount << " new connections.\n";
+    // grow the edge arrays and move every set to its new offset, starting with the last set
+    // (new offsets are never smaller than the old ones, so nothing is overwritten)
+    elements = (unsigned int *) realloc(elements, symmetricElementCount * sizeof(unsigned int));
     Util::checkAllocation(elements, "Can not allocate elements memory in readInClusterData");
-    std::fill_n(elements, symmetricElementCount, UINT_MAX);
-    // init score vector
-    scores = new(std::nothrow) unsigned short[symmetricElementCount];
+    scores = (unsigned short *) realloc(scores, symmetricElementCount * sizeof(unsigned short));
     Util::checkAllocation(scores, "Can not allocate scores memory in readInClusterData");
-    std::fill_n(scores, symmetricElementCount, 0);
-    Debug(Debug::INFO) << "Found " << symmetricElementCount - totalElementCount << " new connections.\n";
+    for (size_t i = dbSize; i > 0; i--) {
+        const size_t setId = i - 1;
+        const size_t setSize = elementOffsets[setId + 1] - elementOffsets[setId];
+        memmove(elements + newElementOffsets[setId], elements + elementOffsets[setId], setSize * sizeof(unsigned int));
+        memmove(scores + newElementOffsets[setId], scores + elementOffsets[setId], setSize * sizeof(unsigned short));
+    }
     AlignmentSymmetry::setupPointers<unsigned int>  (elements, elementLookupTable, newElementOffsets, dbSize, symmetricElementCount);
     AlignmentSymmetry::setupPointers<unsigned short>(scores, scoreLookupTable, newElementOffsets, dbSize, symmetricElementCount);
-    //time
-    Debug(Debug::INFO) << "Reconstruct initial order\n";
-    alnDbr->remapData(); // need to free memory
-    AlignmentSymmetry::readInData(alnDbr, seqDbr, elementLookupTable, scoreLookupTable, scoretype, elementOffsets);
-    alnDbr->remapData(); // need to free memory
     Debug(Debug::INFO) << "Add missing connections\n";
-    AlignmentSymmetry::addMissingLinks(elementLookupTable, elementOffsets, newElementOffsets, dbSize, scoreLookupTable);
+    AlignmentSymmetry::addMissingLinks(elementLookupTable, sortedLookupTable, elementOffsets, newElementOffsets, dbSize, scoreLookupTable);
+    delete[] sortedLookupTable;
+    free(sortedElements);
     maxClustersize = 0;
     for (size_t i = 0; i < dbSize; i++) {
         size_t elementCount = newElementOffsets[i + 1] - newElementOffsets[i];
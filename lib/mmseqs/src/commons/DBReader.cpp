@@ -16,6 +16,7 @@
 #include "Util.h"
 #include "FileUtil.h"
 #include "itoa.h"
+#include "PackedSequence.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -26,8 +27,9 @@ DBReader<T>::DBReader(const char* dataFileName_, const char* indexFileName_, int
 threads(threads), dataMode(dataMode), dataFileName(strdup(dataFileName_)),
         indexFileName(strdup(indexFileName_)), size(0), dataFiles(NULL), dataSizeOffset(NULL), dataFileCnt(0),
         totalDataSize(0), dataSize(0), lastKey(T()), closed(1), dbtype(Parameters::DBTYPE_GENERIC_DB),
-        compressedBuffers(NULL), compressedBufferSizes(NULL), index(NULL), id2local(NULL), local2id(NULL),
-        dataMapped(false), accessType(0), externalData(false), didMlock(false)
+        compressedBuffers(NULL), compressedBufferSizes(NULL), ddict(NULL), index(NULL), id2local(NULL), local2id(NULL),
+        dataMapped(false), accessType(0), externalData(false), didMlock(false), interleavedComponent(-1),
+        keysContiguous(false), keyOffset(0), keyLookup(NULL), packed(false), unpackedBuffers(NULL)
 {}
 
 template <typename T>
@@ -35,8 +37,9 @@ DBReader<T>::DBReader(DBReader<T>::Index *index, size_t size, size_t dataSize, T
         int dbType, unsigned int maxSeqLen, int threads) :
         threads(threads), dataMode(USE_INDEX), dataFileName(NULL), indexFileName(NULL),
         size(size), dataFiles(NULL), dataSizeOffset(NULL), dataFileCnt(0), totalDataSize(0), dataSize(dataSize), lastKey(lastKey),
-        maxSeqLen(maxSeqLen), closed(1), dbtype(dbType), compressedBuffers(NULL), compressedBufferSizes(NULL), index(index), sortedByOffset(true),
-        id2local(NULL), local2id(NULL), dataMapped(false), accessType(NOSORT), externalData(true), didMlock(false)
+        maxSeqLen(maxSeqLen), closed(1), dbtype(dbType), compressedBuffers(NULL), compressedBufferSizes(NULL), ddict(NULL), index(index), sortedByOffset(true),
+        id2local(NULL), local2id(NULL), dataMapped(false), accessType(NOSORT), externalData(true), didMlock(false), interleavedComponent(-1),
+        keysContiguous(false), keyOffset(0), keyLookup(NULL), packed(false), unpackedBuffers(NULL)
 {}
 
 template <typename T>
@@ -101,11 +104,19 @@ template <typename T> DBReader<T>::~DBReader(){
 template <typename T> bool DBReader<T>::open(int accessType){
     // count the number of entries
     this->accessType = accessType;
+    std::string dataPath = dataFileName != NULL ? dataFileName : "";
+    std::string indexPath = indexFileName != NULL ? indexFileName : "";
     if (dataFileName != NULL) {
         dbtype = FileUtil::parseDbType(dataFileName);
+        if (getExtendedDbtype(dbtype) & Parameters::DBTYPE_EXTENDED_INTERLEAVED) {
+            // read the entries of this component from the shared data and index of the interleaved database
+            interleavedComponent = findInterleavedDb(dataFileName, dataPath);
+            indexPath = dataPath + ".index";
+            dbtype &= ~(int)(Parameters::DBTYPE_EXTENDED_INTERLEAVED << 16);
+        }
     }
     if (dataMode & USE_DATA) {
-        dataFileNames = FileUtil::findDatafiles(dataFileName);
+        dataFileNames = FileUtil::findDatafiles(dataPath.c_str());
         if (dataFileNames.empty()) {
             Debug(Debug::ERROR) << "No datafile could be found for " << dataFileName << "!\n";
             EXIT(EXIT_FAILURE);
@@ -157,9 +168,9 @@ template <typename T> bool DBReader<T>::open(int accessType){
     }
     bool isSortedById = false;
     if (externalData == false) {
-        MemoryMapped indexData(indexFileName, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
+        MemoryMapped indexData(indexPath, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
         if (!indexData.isValid()){
-            Debug(Debug::ERROR) << "Cannot open index file " << indexFileName << "\n";
+            Debug(Debug::ERROR) << "Cannot open index file " << indexPath << "\n";
             EXIT(EXIT_FAILURE);
         }
         char* indexDataChar = (char *) indexData.getData();
@@ -183,6 +194,17 @@ template <typename T> bool DBReader<T>::open(int accessType){
             prevOffset = index[i].offset;
         }
     }
+    buildKeyLookup();
+
+    packed = (getExtendedDbtype(dbtype) & Parameters::DBTYPE_EXTENDED_PACKED) != 0;
+    if (packed) {
+        unpackedBuffers = new char*[threads];
+        for (int i = 0; i < threads; i++) {
+            unpackedBuffers[i] = (char*) malloc(maxSeqLen + 1);
+            Util::checkAllocation(unpackedBuffers[i], "Cannot allocate unpackedBuffers");
+            incrementMemory(maxSeqLen + 1);
+        }
+    }
 
     compression = isCompressed(dbtype);
     if(compression == COMPRESSED){
@@ -204,6 +226,18 @@ template <typename T> bool DBReader<T>::open(int accessType){
                 EXIT(EXIT_FAILURE);
             }
         }
+        if (dataFileName != NULL) {
+            std::string dictFile = std::string(dataFileName) + ".zdict";
+            if (FileUtil::fileExists(dictFile.c_str())) {
+                MemoryMapped dictData(dictFile, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
+                if (dictData.isValid() == false) {
+                    Debug(Debug::ERROR) << "Cannot open dictionary file " << dictFile << "\n";
+                    EXIT(EXIT_FAILURE);
+                }
+                setDictionary(reinterpret_cast<const char*>(dictData.getData()), dictData.size());
+                dictData.close();
+            }
+        }
     }
 
     closed = 0;
@@ -515,6 +549,21 @@ template <typename T> void DBReader<T>::close(){
         delete [] compressedBufferSizes;
         delete [] dstream;
     }
+    if (ddict != NULL) {
+        ZSTD_freeDDict(ddict);
+        ddict = NULL;
+        dictionary.clear();
+    }
+    if (unpackedBuffers != NULL) {
+        for (int i = 0; i < threads; i++) {
+            free(unpackedBuffers[i]);
+            decrementMemory(maxSeqLen + 1);
+        }
+        delete [] unpackedBuffers;
+        unpackedBuffers = NULL;
+    }
+
+    releaseKeyLookup();
 
     if(externalData == false) {
         delete[] index;
@@ -539,7 +588,15 @@ template <typename T> char* DBReader<T>::getDataCompressed(size_t id, int thrIdx
     const void *cBuff = static_cast<void *>(data + sizeof(unsigned int));
     const char *dataStart = data + sizeof(unsigned int);
     bool isCompressed = (dataStart[cSize] == 0) ? true : false;
-    if(isCompressed){
+    if (isCompressed && ddict != NULL) {
+        // the buffer holds the longest uncompressed entry of the index
+        totalSize = ZSTD_decompress_usingDDict(dstream[thrIdx], compressedBuffers[thrIdx], compressedBufferSizes[thrIdx], cBuff, cSize, ddict);
+        if (ZSTD_isError(totalSize)) {
+            Debug(Debug::ERROR) << id << " ZSTD_decompress_usingDDict " << ZSTD_getErrorName(totalSize) << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        compressedBuffers[thrIdx][totalSize] = '\0';
+    } else if (isCompressed) {
         ZSTD_inBuffer input = {cBuff, cSize, 0};
         while (input.pos < input.size) {
             ZSTD_outBuffer output = {compressedBuffers[thrIdx], compressedBufferSizes[thrIdx], 0};
@@ -573,11 +630,19 @@ template <typename T> size_t DBReader<T>::getAminoAcidDBSize() {
 template <typename T> char* DBReader<T>::getData(size_t id, int thrIdx){
     if(compression == COMPRESSED){
         return getDataCompressed(id, thrIdx);
+    }else if (packed) {
+        return getDataUnpacked(id, thrIdx);
     }else{
         return getDataUncompressed(id);
     }
 }
 
+template <typename T> char* DBReader<T>::getDataUnpacked(size_t id, int thrIdx) {
+    char *data = getDataUncompressed(id);
+    PackedSequence::unpack(data, std::max(getEntryLen(id), static_cast<size_t>(2)) - 2, unpackedBuffers[thrIdx]);
+    return unpackedBuffers[thrIdx];
+}
+
 template <typename T> char* DBReader<T>::getDataUncompressed(size_t id){
     checkClosed();
     if(!(dataMode & USE_DATA)) {
@@ -628,6 +693,12 @@ template <typename T> char* DBReader<T>::getDataByDBKey(T dbKey, int thrIdx) {
     size_t id = getId(dbKey);
     if(compression == COMPRESSED ){
         return (id != UINT_MAX) ? getDataCompressed(id, thrIdx) : NULL;
+    }else if (packed) {
+        if (id == UINT_MAX) {
+            return NULL;
+        }
+        PackedSequence::unpack(getDataByOffset(index[id].offset), std::max(index[id].length, 2u) - 2, unpackedBuffers[thrIdx]);
+        return unpackedBuffers[thrIdx];
     }else{
         return (id != UINT_MAX) ? getDataByOffset(index[id].offset) : NULL;
     }
@@ -735,6 +806,118 @@ template <typename T> size_t DBReader<T>::getId (T dbKey){
     return (id < size && index[id].id == dbKey ) ? id : UINT_MAX;
 }
 
+template<>
+size_t DBReader<unsigned int>::getId(unsigned int dbKey) {
+    size_t id;
+    if (keysContiguous) {
+        // wraps around for keys below keyOffset
+        id = static_cast<size_t>(dbKey) - keyOffset;
+        if (id >= size) {
+            return UINT_MAX;
+        }
+    } else if (keyLookup != NULL) {
+        if (dbKey >= keyLookup->tableSize) {
+            return UINT_MAX;
+        }
+        id = keyLookup->keyToId[dbKey];
+        if (id == UINT_MAX) {
+            return UINT_MAX;
+        }
+    } else {
+        id = bsearch(index, size, dbKey);
+        if (id >= size || index[id].id != dbKey) {
+            return UINT_MAX;
+        }
+    }
+    return (id2local != NULL) ? id2local[id] : id;
+}
+
+// lookups of all open readers, readers with the same keys share one lookup
+template <typename T>
+std::vector<typename DBReader<T>::KeyLookup*> DBReader<T>::keyLookups;
+
+template <typename T> void DBReader<T>::buildKeyLookup() {}
+template <typename T> void DBReader<T>::releaseKeyLookup() {}
+
+template<>
+void DBReader<unsigned int>::buildKeyLookup() {
+    keysContiguous = false;
+    keyLookup = NULL;
+    if (size == 0 || size >= UINT_MAX) {
+        return;
+    }
+    // databases from createdb have the keys 0 to size - 1
+    keyOffset = index[0].id;
+    keysContiguous = true;
+    for (size_t i = 0; i < size && keysContiguous; i++) {
+        keysContiguous = (index[i].id == keyOffset + i);
+    }
+    if (keysContiguous) {
+        return;
+    }
+
+    // direct addressing for dense keys, e.g. after createsubdb, costs at most 8 bytes per entry
+    const size_t tableSize = static_cast<size_t>(lastKey) + 1;
+    if (tableSize > 2 * size) {
+        return;
+    }
+#pragma omp critical(DBReaderKeyLookup)
+    {
+        for (size_t i = 0; i < keyLookups.size() && keyLookup == NULL; i++) {
+            KeyLookup *candidate = keyLookups[i];
+            if (candidate->tableSize != tableSize || candidate->entries != size) {
+                continue;
+            }
+            bool sameKeys = true;
+            for (size_t j = 0; j < size && sameKeys; j++) {
+                sameKeys = (candidate->keyToId[index[j].id] == j);
+            }
+            if (sameKeys) {
+                candidate->refCount++;
+                keyLookup = candidate;
+            }
+        }
+        if (keyLookup == NULL) {
+            unsigned int *keyToId = new(std::nothrow) unsigned int[tableSize];
+            Util::checkAllocation(keyToId, "Cannot allocate key lookup memory in DBReader");
+            std::fill(keyToId, keyToId + tableSize, UINT_MAX);
+            bool uniqueKeys = true;
+            for (size_t i = 0; i < size && uniqueKeys; i++) {
+                uniqueKeys = (keyToId[index[i].id] == UINT_MAX);
+                keyToId[index[i].id] = i;
+            }
+            if (uniqueKeys) {
+                keyLookup = new KeyLookup;
+                keyLookup->keyToId = keyToId;
+                keyLookup->tableSize = tableSize;
+                keyLookup->entries = size;
+                keyLookup->refCount = 1;
+                keyLookups.push_back(keyLookup);
+            } else {
+                delete[] keyToId;
+            }
+        }
+    }
+}
+
+template<>
+void DBReader<unsigned int>::releaseKeyLookup() {
+    keysContiguous = false;
+    if (keyLookup == NULL) {
+        return;
+    }
+#pragma omp critical(DBReaderKeyLookup)
+    {
+        keyLookup->refCount--;
+        if (keyLookup->refCount == 0) {
+            keyLookups.erase(std::find(keyLookups.begin(), keyLookups.end(), keyLookup));
+            delete[] keyLookup->keyToId;
+            delete keyLookup;
+        }
+    }
+    keyLookup = NULL;
+}
+
 template <typename T> size_t DBReader<T>::maxCount(char c) {
     checkClosed();
 
@@ -813,7 +996,8 @@ bool DBReader<T>::readIndex(char *data, size_t indexDataSize, Index *index, size
     {
         size_t currPos = 0;
         char* indexDataChar = (char *) data;
-        const char * cols[3];
+        const char * cols[6];
+        const size_t colCnt = interleavedComponent >= 0 ? 6 : 3;
         size_t lineStartId = __sync_fetch_and_add(&(globalIdOffset), BATCH_SIZE);
         T prevId=T(); // makes 0 or empty string
         size_t currLine = 0;
@@ -825,11 +1009,22 @@ bool DBReader<T>::readIndex(char *data, size_t indexDataSize, Index *index, size
             }
             if(currLine == lineStartId){
                 for(size_t startIndex = lineStartId; startIndex < lineStartId + BATCH_SIZE && currPos < indexDataSize; startIndex++){
-                    Util::getWordsOfLine(indexDataChar, cols, 3);
+                    const size_t foundCols = Util::getWordsOfLine(indexDataChar, cols, colCnt);
                     readIndexId(&index[startIndex].id, indexDataChar, cols);
                     isSortedById *= (index[startIndex].id >= prevId);
                     size_t offset = Util::fast_atoi<size_t>(cols[1]);
                     size_t length = Util::fast_atoi<size_t>(cols[2]);
+                    if (interleavedComponent >= 0) {
+                        if (foundCols < colCnt) {
+                            Debug(Debug::ERROR) << "Invalid interleaved database index entry in line " << (startIndex + 1) << "\n";
+                            EXIT(EXIT_FAILURE);
+                        }
+                        // key, offset, length of the whole entry, then the length of each component
+                        for (int i = 0; i < interleavedComponent; ++i) {
+                            offset += Util::fast_atoi<size_t>(cols[3 + i]);
+                        }
+                        length = Util::fast_atoi<size_t>(cols[3 + interleavedComponent]);
+                    }
                     localDataSize += length;
                     index[startIndex].offset = offset;
                     index[startIndex].length = length;
@@ -855,6 +1050,26 @@ bool DBReader<T>::readIndex(char *data, size_t indexDataSize, Index *index, size
     return isSortedById;
 }
 
+template<typename T>
+int DBReader<T>::findInterleavedDb(const std::string &dataName, std::string &interleavedDb) {
+    // components of a structure database in the order they are stored in each interleaved entry,
+    // the amino acids are read from the database itself
+    static const char *suffixes[] = { "_ss", "_ca" };
+    for (size_t i = 0; i < ARRAY_SIZE(suffixes); ++i) {
+        const size_t suffixLength = strlen(suffixes[i]);
+        if (dataName.size() <= suffixLength || dataName.compare(dataName.size() - suffixLength, suffixLength, suffixes[i]) != 0) {
+            continue;
+        }
+        std::string baseName = dataName.substr(0, dataName.size() - suffixLength);
+        if (getExtendedDbtype(FileUtil::parseDbType(baseName.c_str())) & Parameters::DBTYPE_EXTENDED_INTERLEAVED) {
+            interleavedDb = baseName;
+            return static_cast<int>(i + 1);
+        }
+    }
+    interleavedDb = dataName;
+    return 0;
+}
+
 template<typename T> T DBReader<T>::getLastKey() {
     return lastKey;
 }
@@ -961,6 +1176,19 @@ DBReader<unsigned int> *DBReader<unsigned int>::unserialize(const char* data, in
     return new DBReader<unsigned int>(idx, size, dataSize, lastKey, dbType, maxSeqLen, threads);
 }
 
+template<typename T>
+void DBReader<T>::setDictionary(const char *data, size_t size) {
+    if (ddict != NULL) {
+        ZSTD_freeDDict(ddict);
+    }
+    dictionary.assign(data, size);
+    ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (ddict == NULL) {
+        Debug(Debug::ERROR) << "Cannot load compression dictionary\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+
 template<typename T>
 void DBReader<T>::setData(char *data, size_t dataSize) {
     if(dataFiles == NULL){
@@ -1085,6 +1313,12 @@ void DBReader<T>::moveDb(const std::string &srcDbName, const std::string &dstDbN
     if (FileUtil::fileExists((srcDbName + ".lookup").c_str())) {
         FileUtil::move((srcDbName + ".lookup").c_str(), (dstDbName + ".lookup").c_str());
     }
+    // a dictionary left over from an older database would break decompressing the new one
+    if (FileUtil::fileExists((srcDbName + ".zdict").c_str())) {
+        FileUtil::move((srcDbName + ".zdict").c_str(), (dstDbName + ".zdict").c_str());
+    } else if (FileUtil::fileExists((dstDbName + ".zdict").c_str())) {
+        FileUtil::remove((dstDbName + ".zdict").c_str());
+    }
 }
 
 template<typename T>
@@ -1109,6 +1343,10 @@ void DBReader<T>::removeDb(const std::string &databaseName){
     if (FileUtil::fileExists(lookupFile.c_str())) {
         FileUtil::remove(lookupFile.c_str());
     }
+    std::string dictFile = databaseName + ".zdict";
+    if (FileUtil::fileExists(dictFile.c_str())) {
+        FileUtil::remove(dictFile.c_str());
+    }
 }
 
 typedef void (*DbAction)(const std::string &, const std::string &);
@@ -1141,9 +1379,11 @@ void copyLinkDb(const std::string &databaseName, const std::string &outDb, DBFil
     const DBSuffix suffices[] = {
         { DBFiles::DATA_INDEX,    ".index"            },
         { DBFiles::DATA_DBTYPE,   ".dbtype"           },
+        { DBFiles::DATA_DICTIONARY, ".zdict"          },
         { DBFiles::HEADER,        "_h"                },
         { DBFiles::HEADER_INDEX,  "_h.index"          },
         { DBFiles::HEADER_DBTYPE, "_h.dbtype"         },
+        { DBFiles::HEADER_DICTIONARY, "_h.zdict"      },
         { DBFiles::LOOKUP,        ".lookup"           },
         { DBFiles::SOURCE,        ".source"           },
         { DBFiles::TAX_MAPPING,   "_mapping"          },
@@ -39,10 +39,12 @@ struct DBFiles {
         CA3M_HDR          = (1ull << 16),
         CA3M_HDR_IDX      = (1ull << 17),
         TAX_BINARY        = (1ull << 18),
+        DATA_DICTIONARY   = (1ull << 19),
+        HEADER_DICTIONARY = (1ull << 20),
 
 
-        GENERIC           = DATA | DATA_INDEX | DATA_DBTYPE,
-        HEADERS           = HEADER | HEADER_INDEX | HEADER_DBTYPE,
+        GENERIC           = DATA | DATA_INDEX | DATA_DBTYPE | DATA_DICTIONARY,
+        HEADERS           = HEADER | HEADER_INDEX | HEADER_DBTYPE | HEADER_DICTIONARY,
         TAXONOMY          = TAX_MAPPING | TAX_NAMES | TAX_NODES | TAX_MERGED | TAX_BINARY,
         SEQUENCE_DB       = GENERIC | HEADERS | TAXONOMY | LOOKUP | SOURCE,
         SEQUENCE_ANCILLARY= SEQUENCE_DB & (~GENERIC),
@@ -161,6 +163,14 @@ public:
 
     void close();
 
+    bool hasDictionary() { return ddict != NULL; }
+
+    // zstd dictionary the entries were compressed with, empty if there is none
+    const std::string &getDictionary() { return dictionary; }
+
+    // decompress the entries with this dictionary, for readers whose data does not come from a file (e.g. an index)
+    void setDictionary(const char *data, size_t size);
+
     const char* getDataFileName() { return dataFileName; }
 
     const char* getIndexFileName() { return indexFileName; }
@@ -176,6 +186,9 @@ public:
 
     char* getDataUncompressed(size_t id);
 
+    // letters of a packed sequence entry, followed by '\n' and '\0' like the entries of a plain database
+    char* getDataUnpacked(size_t id, int thrIdx);
+
     void touchData(size_t id);
 
     char* getDataByDBKey(T key, int thrIdx);
@@ -234,7 +247,8 @@ public:
 
     size_t bsearch(const Index * index, size_t size, T value);
 
-    // does a binary search in the index and returns index of the entry with dbKey
+    // returns index of the entry with dbKey, by direct addressing for dense keys
+    // (see buildKeyLookup) and by a binary search in the index otherwise
     // returns UINT_MAX if the key is not contained in index
     size_t getId (T dbKey);
 
@@ -307,6 +321,10 @@ public:
 
     bool readIndex(char *data, size_t indexDataSize, Index *index, size_t & dataSize);
 
+    // Returns which component of an interleaved database dataName is (0 for the database itself)
+    // and sets interleavedDb to the name of the database storing the entries.
+    static int findInterleavedDb(const std::string &dataName, std::string &interleavedDb);
+
     void readLookup(char *data, size_t dataSize, LookupEntry *lookup);
 
     void readIndexId(T* id, char * line, const char** cols);
@@ -318,6 +336,9 @@ public:
     void mlock();
 
     void sortIndex(bool isSortedById);
+
+    void buildKeyLookup();
+    void releaseKeyLookup();
     void sortIndex(float *weights);
     bool isSortedByOffset();
 
@@ -437,6 +458,10 @@ public:
 
     size_t findNextOffsetid(size_t id);
 
+    bool isPacked() const {
+        return packed;
+    }
+
     int isCompressed(){
         return isCompressed(dbtype);
     }
@@ -482,6 +507,9 @@ private:
     char ** compressedBuffers;
     size_t * compressedBufferSizes;
     ZSTD_DStream ** dstream;
+    // trained dictionary of compressed databases (<data file>.zdict), NULL if there is none
+    ZSTD_DDict * ddict;
+    std::string dictionary;
 
     Index * index;
     size_t lookupSize;
@@ -498,6 +526,25 @@ private:
 
     bool didMlock;
 
+    // component of an interleaved database this reader provides, -1 for regular databases
+    int interleavedComponent;
+
+    // key to id lookup: keys of the index are keyOffset, keyOffset + 1, ... or are looked up in
+    // keyLookup, which is shared between readers with the same keys (e.g. db, db_ss and db_ca)
+    bool keysContiguous;
+    size_t keyOffset;
+    struct KeyLookup {
+        unsigned int *keyToId;
+        size_t tableSize;
+        size_t entries;
+        size_t refCount;
+    };
+    KeyLookup *keyLookup;
+    static std::vector<KeyLookup*> keyLookups;
+
+    bool packed;
+    char ** unpackedBuffers;
+
     // needed to prevent the compiler from optimizing away the loop
     char magicBytes;
 
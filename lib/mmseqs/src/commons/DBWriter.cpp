@@ -10,6 +10,7 @@
 
 #define SIMDE_ENABLE_NATIVE_ALIASES
 #include <simde/simde-common.h>
+#include <zdict.h>
 
 #include <cstdlib>
 #include <cstdio>
@@ -34,6 +35,7 @@ DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsign
     indexFileNames = new char *[threads];
     compressedBuffers=NULL;
     compressedBufferSizes=NULL;
+    cdict = NULL;
     if((mode & Parameters::WRITER_COMPRESSED_MODE) != 0){
         compressedBuffers = new char*[threads];
         compressedBufferSizes = new size_t[threads];
@@ -93,6 +95,9 @@ DBWriter::~DBWriter() {
         delete [] cstream;
         delete [] state;
     }
+    if (cdict != NULL) {
+        ZSTD_freeCDict(cdict);
+    }
 }
 
 void DBWriter::sortDatafileByIdOrder(DBReader<unsigned int> &dbr) {
@@ -212,6 +217,49 @@ void DBWriter::writeDbtypeFile(const char* path, int dbtype, bool isCompressed)
     }
 }
 
+void DBWriter::setDictionary(const std::string &dictionary_) {
+    if ((mode & Parameters::WRITER_COMPRESSED_MODE) == 0 || dictionary_.empty()) {
+        return;
+    }
+    dictionary = dictionary_;
+    if (cdict != NULL) {
+        ZSTD_freeCDict(cdict);
+    }
+    cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), 3);
+    if (cdict == NULL) {
+        Debug(Debug::ERROR) << "Cannot create compression dictionary for " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+
+std::string DBWriter::trainDictionary(DBReader<unsigned int> &reader, size_t dictSize, size_t sampleSize) {
+    // take entries evenly spread over the database until the sample is full
+    size_t stride = reader.getDataSize() / sampleSize + 1;
+    std::string samples;
+    std::vector<size_t> sampleSizes;
+    for (size_t id = 0; id < reader.getSize() && samples.size() < sampleSize; id += stride) {
+        size_t length = reader.getEntryLen(id);
+        if (length <= 1) {
+            continue;
+        }
+        samples.append(reader.getData(id, 0), length - 1);
+        sampleSizes.push_back(length - 1);
+    }
+
+    // zstd recommends about a hundred times as much sample data as dictionary size
+    dictSize = std::min(dictSize, samples.size() / 100);
+    if (dictSize < 1024) {
+        return "";
+    }
+    std::string dict(dictSize, '\0');
+    size_t result = ZDICT_trainFromBuffer(&dict[0], dict.size(), samples.data(), sampleSizes.data(), sampleSizes.size());
+    if (ZDICT_isError(result)) {
+        Debug(Debug::INFO) << "No dictionary for " << reader.getDataFileName() << ": " << ZDICT_getErrorName(result) << "\n";
+        return "";
+    }
+    dict.resize(result);
+    return dict;
+}
 
 void DBWriter::close(bool merge, bool needsSort) {
     // close all datafiles
@@ -240,7 +288,23 @@ void DBWriter::close(bool merge, bool needsSort) {
     mergeResults(dataFileName, indexFileName, (const char **) dataFileNames, (const char **) indexFileNames,
                  threads, merge, ((mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) != 0), needsSort);
 
-    writeDbtypeFile(dataFileName, dbtype, (mode & Parameters::WRITER_COMPRESSED_MODE) != 0);
+    // entries are written as they are given, which are never packed sequences
+    writeDbtypeFile(dataFileName, dbtype & ~(int)(Parameters::DBTYPE_EXTENDED_PACKED << 16), (mode & Parameters::WRITER_COMPRESSED_MODE) != 0);
+
+    std::string dictFile = std::string(dataFileName) + ".zdict";
+    if (cdict != NULL) {
+        FILE* file = FileUtil::openAndDelete(dictFile.c_str(), "wb");
+        if (fwrite(dictionary.data(), sizeof(char), dictionary.size(), file) != dictionary.size()) {
+            Debug(Debug::ERROR) << "Cannot write dictionary " << dictFile << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (fclose(file) != 0) {
+            Debug(Debug::ERROR) << "Cannot close file " << dictFile << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    } else if (FileUtil::fileExists(dictFile.c_str())) {
+        FileUtil::remove(dictFile.c_str());
+    }
 
     for (unsigned int i = 0; i < threads; i++) {
         delete [] dataFilesBuffer[i];
@@ -262,7 +326,8 @@ void DBWriter::writeStart(unsigned int thrIdx) {
         state[thrIdx] = INIT_STATE;
         threadBufferOffset[thrIdx]=0;
         int cLevel = 3;
-        size_t const initResult = ZSTD_initCStream(cstream[thrIdx], cLevel);
+        size_t const initResult = cdict != NULL ? ZSTD_initCStream_usingCDict(cstream[thrIdx], cdict)
+                                                : ZSTD_initCStream(cstream[thrIdx], cLevel);
         if (ZSTD_isError(initResult)) {
             Debug(Debug::ERROR) << "ZSTD_initCStream() error in thread " << thrIdx << ". Error "
                                 << ZSTD_getErrorName(initResult) << "\n";
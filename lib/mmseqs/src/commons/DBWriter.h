@@ -45,6 +45,12 @@ public:
 
     static void writeDbtypeFile(const char* path, int dbtype, bool isCompressed);
 
+    // compressed entries are written with this dictionary, it is stored as <data file>.zdict on close
+    void setDictionary(const std::string &dictionary);
+
+    // trains a zstd dictionary on a sample of the entries of reader, returns an empty string if training fails
+    static std::string trainDictionary(DBReader<unsigned int> &reader, size_t dictSize = 112640, size_t sampleSize = 16 * 1024 * 1024);
+
     size_t getStart(unsigned int threadIdx){
         return starts[threadIdx];
     }
@@ -102,6 +108,8 @@ private:
     static const int NOTCOMPRESSED=1;
     static const int COMPRESSED=2;
     ZSTD_CStream** cstream;
+    std::string dictionary;
+    ZSTD_CDict* cdict;
 
     const unsigned int threads;
     const size_t mode;
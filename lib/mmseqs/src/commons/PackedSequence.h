@@ -0,0 +1,145 @@
+#ifndef MMSEQS_PACKEDSEQUENCE_H
+#define MMSEQS_PACKEDSEQUENCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define SIMDE_ENABLE_NATIVE_ALIASES
+#include <simde/x86/ssse3.h>
+
+// Sequence entries of databases with the DBTYPE_EXTENDED_PACKED flag. An entry of L residues holds
+// L 5-bit codes, least significant bit first (8 residues in 5 bytes), followed by a bitmap of L bits
+// marking lowercase (soft masked) residues. There is no newline or null byte, the index keeps the
+// length of the plain entry (L + 2), so the size of the packed entry follows from the index.
+// Codes 0 to 25 are the letters A to Z, 26 is '*' and 27 is '-'.
+class PackedSequence {
+public:
+    static size_t codeSize(size_t len) {
+        return (len * 5 + 7) / 8;
+    }
+
+    static size_t packedSize(size_t len) {
+        return codeSize(len) + (len + 7) / 8;
+    }
+
+    // appends the packed entry of seq to out, returns false if seq contains a character without a code
+    static bool pack(const char *seq, size_t len, std::string &out) {
+        const size_t start = out.size();
+        out.append(packedSize(len), '\0');
+        unsigned char *codes = reinterpret_cast<unsigned char *>(&out[start]);
+        unsigned char *mask = codes + codeSize(len);
+        for (size_t i = 0; i < len; i++) {
+            unsigned char c = static_cast<unsigned char>(seq[i]);
+            if (c >= 'a' && c <= 'z') {
+                mask[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+                c = static_cast<unsigned char>(c - 'a' + 'A');
+            }
+            unsigned int code;
+            if (c >= 'A' && c <= 'Z') {
+                code = c - 'A';
+            } else if (c == '*') {
+                code = 26;
+            } else if (c == '-') {
+                code = 27;
+            } else {
+                out.resize(start);
+                return false;
+            }
+            const size_t bit = i * 5;
+            codes[bit / 8] |= static_cast<unsigned char>(code << (bit % 8));
+            if (bit % 8 > 3) {
+                codes[bit / 8 + 1] |= static_cast<unsigned char>(code >> (8 - bit % 8));
+            }
+        }
+        return true;
+    }
+
+    // letter of each code, unused codes decode to 'X'
+    static const unsigned char *letters() {
+        static const unsigned char table[32] = {
+            'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+            'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '*', '-', 'X', 'X', 'X', 'X'
+        };
+        return table;
+    }
+
+    // fills table with the aa2num value of the letter of each code
+    static void numTable(const unsigned char *aa2num, unsigned char *table) {
+        for (size_t i = 0; i < 32; i++) {
+            table[i] = aa2num[letters()[i]];
+        }
+    }
+
+    // writes the residues of a packed entry as letters (lowercase if masked) followed by '\n' and '\0'
+    static void unpack(const char *packed, size_t len, char *out) {
+        const unsigned char *mask = reinterpret_cast<const unsigned char *>(packed) + codeSize(len);
+        const size_t done = unpackCodes(packed, len, letters(), reinterpret_cast<unsigned char *>(out));
+        size_t i = 0;
+        const __m128i lowercase = _mm_set1_epi8(0x20);
+        const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+        const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        for (; i + 16 <= done; i += 16) {
+            const int maskBits = mask[i / 8] | (mask[i / 8 + 1] << 8);
+            if (maskBits == 0) {
+                continue;
+            }
+            __m128i m = _mm_shuffle_epi8(_mm_cvtsi32_si128(maskBits), spread);
+            m = _mm_cmpeq_epi8(_mm_and_si128(m, bits), bits);
+            __m128i letter = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_or_si128(letter, _mm_and_si128(m, lowercase)));
+        }
+        for (; i < len; i++) {
+            if (mask[i / 8] & (1 << (i % 8))) {
+                out[i] = static_cast<char>(out[i] | 0x20);
+            }
+        }
+        out[len] = '\n';
+        out[len + 1] = '\0';
+    }
+
+    // writes table[code] of each residue of a packed entry to out (exactly len values), returns the number
+    // of residues decoded with SIMD (a multiple of 16)
+    static size_t unpackCodes(const char *packed, size_t len, const unsigned char *table, unsigned char *out) {
+        const unsigned char *codes = reinterpret_cast<const unsigned char *>(packed);
+        // 16 residues are 10 bytes, each 16 bit lane gets the two bytes holding one code,
+        // the multiplication moves the code to bits 7 to 11 of the lane
+        const __m128i shuffleLo = _mm_setr_epi8(0, 1, 0, 1, 1, 2, 1, 2, 2, 3, 3, 4, 3, 4, 4, 5);
+        const __m128i shuffleHi = _mm_setr_epi8(5, 6, 5, 6, 6, 7, 6, 7, 7, 8, 8, 9, 8, 9, 9, 10);
+        const __m128i shift = _mm_setr_epi16(128, 4, 32, 1, 8, 64, 2, 16);
+        const __m128i codeMask = _mm_set1_epi16(31);
+        const __m128i fifteen = _mm_set1_epi8(15);
+        const __m128i sixteen = _mm_set1_epi8(16);
+        const __m128i tableLo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(table));
+        const __m128i tableHi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(table + 16));
+        const size_t size = packedSize(len);
+        size_t i = 0;
+        // the 16 byte load must stay within the entry
+        for (; i + 16 <= len && i / 16 * 10 + 16 <= size; i += 16) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codes + i / 16 * 10));
+            __m128i lo = _mm_mullo_epi16(_mm_shuffle_epi8(in, shuffleLo), shift);
+            __m128i hi = _mm_mullo_epi16(_mm_shuffle_epi8(in, shuffleHi), shift);
+            lo = _mm_and_si128(_mm_srli_epi16(lo, 7), codeMask);
+            hi = _mm_and_si128(_mm_srli_epi16(hi, 7), codeMask);
+            const __m128i code = _mm_packus_epi16(lo, hi);
+            // codes above 15 select zero from the first table (high bit set), codes below 16 from the second
+            const __m128i high = _mm_cmpgt_epi8(code, fifteen);
+            const __m128i value = _mm_or_si128(_mm_shuffle_epi8(tableLo, _mm_or_si128(code, high)),
+                                               _mm_shuffle_epi8(tableHi, _mm_sub_epi8(code, sixteen)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), value);
+        }
+        const size_t done = i;
+        for (; i < len; i++) {
+            const size_t bit = i * 5;
+            unsigned int code = codes[bit / 8] >> (bit % 8);
+            if (bit % 8 > 3) {
+                code |= codes[bit / 8 + 1] << (8 - bit % 8);
+            }
+            out[i] = table[code & 31];
+        }
+        return done;
+    }
+};
+
+#endif
@@ -39,6 +39,7 @@ Parameters::Parameters():
         PARAM_K(PARAM_K_ID, "-k", "k-mer length", "k-mer length (0: automatically set to optimum)", typeid(int), (void *) &kmerSize, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_CLUSTLINEAR | MMseqsParameter::COMMAND_EXPERT),
         PARAM_THREADS(PARAM_THREADS_ID, "--threads", "Threads", "Number of CPU-cores used (all by default)", typeid(int), (void *) &threads, "^[1-9]{1}[0-9]*$", MMseqsParameter::COMMAND_COMMON),
         PARAM_COMPRESSED(PARAM_COMPRESSED_ID, "--compressed", "Compressed", "Write compressed output", typeid(int), (void *) &compressed, "^[0-1]{1}$", MMseqsParameter::COMMAND_COMMON),
+        PARAM_COMPRESS_DICTIONARY(PARAM_COMPRESS_DICTIONARY_ID, "--compress-dictionary", "Compression dictionary", "Compress with a zstd dictionary trained on the entries. Better ratio for short entries, older versions cannot read the output", typeid(int), (void *) &compressDictionary, "^[0-1]{1}$", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
         PARAM_ALPH_SIZE(PARAM_ALPH_SIZE_ID, "--alph-size", "Alphabet size", "Alphabet size (range 2-21)", typeid(MultiParam<NuclAA<int>>), (void *) &alphabetSize, "", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_CLUSTLINEAR | MMseqsParameter::COMMAND_EXPERT),
         PARAM_MAX_SEQ_LEN(PARAM_MAX_SEQ_LEN_ID, "--max-seq-len", "Max sequence length", "Maximum sequence length", typeid(size_t), (void *) &maxSeqLen, "^[0-9]{1}[0-9]*", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_EXPERT),
         PARAM_DIAGONAL_SCORING(PARAM_DIAGONAL_SCORING_ID, "--diag-score", "Diagonal scoring", "Use ungapped diagonal scoring during prefilter", typeid(bool), (void *) &diagonalScoring, "", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
@@ -316,6 +317,11 @@ Parameters::Parameters():
     threadsandcompression.push_back(&PARAM_COMPRESSED);
     threadsandcompression.push_back(&PARAM_V);
 
+    // compress
+    compressdb.push_back(&PARAM_COMPRESS_DICTIONARY);
+    compressdb.push_back(&PARAM_THREADS);
+    compressdb.push_back(&PARAM_V);
+
     // alignall
     alignall.push_back(&PARAM_SUB_MAT);
     alignall.push_back(&PARAM_ADD_BACKTRACE);
@@ -2213,6 +2219,7 @@ void Parameters::setDefaults() {
 
     threads = 1;
     compressed = WRITER_ASCII_MODE;
+    compressDictionary = 0;
 #ifdef OPENMP
     char * threadEnv = getenv("MMSEQS_NUM_THREADS");
     if (threadEnv != NULL) {
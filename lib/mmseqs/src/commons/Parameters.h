@@ -87,6 +87,12 @@ public:
     static const unsigned int DBTYPE_EXTENDED_COMPRESSED = 1;
     static const unsigned int DBTYPE_EXTENDED_INDEX_NEED_SRC = 2;
     static const unsigned int DBTYPE_EXTENDED_CONTEXT_PSEUDO_COUNTS = 4;
+    // entries are stored interleaved with the other components of the database (see DBReader::findInterleavedDb)
+    static const unsigned int DBTYPE_EXTENDED_INTERLEAVED = 8;
+    // sequences are stored with 5 bits per residue and a soft mask bitmap (see PackedSequence.h)
+    static const unsigned int DBTYPE_EXTENDED_PACKED = 16;
+    // alignment results are stored as binary blocks (see Matcher::resultsToBinaryBuffer)
+    static const unsigned int DBTYPE_EXTENDED_BINARY_ALIGNMENT = 32;
 
     // don't forget to add new database types to DBReader::getDbTypeName and Parameters::PARAM_OUTPUT_DBTYPE
 
@@ -369,6 +375,7 @@ public:
     int    verbosity;                    // log level
     int    threads;                      // Amounts of threads
     int    compressed;                   // compressed writer
+    int    compressDictionary;           // train a zstd dictionary for compressed writers
     bool   removeTmpFiles;               // Do not delete temp files
     bool   includeIdentity;              // include identical ids as hit
 
@@ -704,6 +711,7 @@ public:
     PARAMETER(PARAM_K)
     PARAMETER(PARAM_THREADS)
     PARAMETER(PARAM_COMPRESSED)
+    PARAMETER(PARAM_COMPRESS_DICTIONARY)
     PARAMETER(PARAM_ALPH_SIZE)
     PARAMETER(PARAM_MAX_SEQ_LEN)
     PARAMETER(PARAM_DIAGONAL_SCORING)
@@ -1028,6 +1036,7 @@ public:
     std::vector<MMseqsParameter*> verbandcompression;
     std::vector<MMseqsParameter*> onlythreads;
     std::vector<MMseqsParameter*> threadsandcompression;
+    std::vector<MMseqsParameter*> compressdb;
 
     std::vector<MMseqsParameter*> alignall;
     std::vector<MMseqsParameter*> align;
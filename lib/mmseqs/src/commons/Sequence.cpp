@@ -7,6 +7,8 @@
 #include "MathUtil.h"
 #include "SubstitutionMatrixProfileStates.h"
 #include "PSSMCalculator.h"
+#include "DBReader.h"
+#include "PackedSequence.h"
 
 #include <climits> // short_max
 #include <cstddef>
@@ -215,6 +217,31 @@ void Sequence::mapSequence(size_t id, unsigned int dbKey, const char *sequence,
 
 }
 
+void Sequence::mapSequence(size_t id, unsigned int dbKey, DBReader<unsigned int> &reader, size_t readerId, int thrIdx) {
+    const unsigned int seqLen = reader.getSeqLen(readerId);
+    if (reader.isPacked() == false) {
+        mapSequence(id, dbKey, reader.getData(readerId, thrIdx), seqLen);
+        return;
+    }
+    if (Parameters::isEqualDbtype(this->seqType, Parameters::DBTYPE_AMINO_ACIDS) == false
+        && Parameters::isEqualDbtype(this->seqType, Parameters::DBTYPE_NUCLEOTIDES) == false) {
+        Debug(Debug::ERROR) << "Invalid sequence type!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    this->id = id;
+    this->dbKey = dbKey;
+    this->seqData = NULL;
+    if (seqLen >= maxLen) {
+        numSequence = static_cast<unsigned char*>(realloc(numSequence, seqLen + 1));
+        maxLen = seqLen;
+    }
+    unsigned char table[32];
+    PackedSequence::numTable(subMat->aa2num, table);
+    PackedSequence::unpackCodes(reader.getDataUncompressed(readerId), seqLen, table, numSequence);
+    this->L = seqLen;
+    currItPos = -1;
+}
+
 void Sequence::mapSequence(size_t id, unsigned int dbKey, std::pair<const unsigned char *,const unsigned int> data){
     this->id = id;
     this->dbKey = dbKey;
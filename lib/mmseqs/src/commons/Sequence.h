@@ -73,6 +73,8 @@ const int8_t spaced_seed_30[] = {1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 0, 1, 0, 1, 1,
 
 
 
+template <typename T> class DBReader;
+
 class Sequence {
 public:
     Sequence(size_t maxLen, int seqType, const BaseMatrix *subMat,  const unsigned int kmerSize, const bool spaced, const bool aaBiasCorrection,
@@ -82,6 +84,9 @@ public:
     // Map char -> int
     void mapSequence(size_t id, unsigned int dbKey, const char *seq, unsigned int seqLen);
 
+    // Map entry readerId of a sequence database, entries of packed databases are decoded straight to numbers
+    void mapSequence(size_t id, unsigned int dbKey, DBReader<unsigned int> &reader, size_t readerId, int thrIdx);
+
     // map sequence from SequenceLookup
     void mapSequence(size_t id, unsigned int dbKey, std::pair<const unsigned char *, const unsigned int> data);
 
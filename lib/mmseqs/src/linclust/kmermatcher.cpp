@@ -38,6 +38,11 @@ uint64_t hashUInt64(uint64_t in, uint64_t seed) {
     return XXH64(&in, sizeof(uint64_t), seed);
 }
 
+bool pairedKmerNeedsHash(int kmerSize, size_t alphabetSize, size_t pairedAlphabetSize) {
+    const double keyBits = kmerSize * (log2(static_cast<double>(alphabetSize)) + log2(static_cast<double>(pairedAlphabetSize)));
+    return keyBits > 63.0;
+}
+
 template <typename T>
 KmerPosition<T> *initKmerPositionMemory(size_t size) {
     KmerPosition<T> * hashSeqPair = new(std::nothrow) KmerPosition<T>[size + 1];
@@ -78,10 +83,28 @@ void maskSequence(int maskMode, int maskLowerCase, float maskProb, Sequence &seq
 template <int TYPE, typename T>
 std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
                                                 Parameters & par, BaseMatrix * subMat, bool hashWholeSequence,
-                                                size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution){
+                                                size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution,
+                                                KmerPairedDb * pairedDb){
     size_t offset = 0;
     int querySeqType  =  seqDbr.getDbtype();
     size_t longestKmer = par.kmerSize;
+
+    // paired letters are appended to the k-mer index: kmerIdx * pairedKmerRange + pairedIdx
+    // if that does not fit into 63 bits, the key is a 63 bit hash of the k-mer index and the paired letters
+    size_t pairedAlphabetSize = 0;
+    size_t pairedKmerRange = 1;
+    bool hashPairedKmer = false;
+    if (pairedDb != NULL) {
+        if (TYPE != Parameters::DBTYPE_AMINO_ACIDS) {
+            Debug(Debug::ERROR) << "Paired k-mers are only supported for amino acid databases\n";
+            EXIT(EXIT_FAILURE);
+        }
+        pairedAlphabetSize = pairedDb->subMat->alphabetSize - 1;
+        hashPairedKmer = pairedKmerNeedsHash(par.kmerSize, subMat->alphabetSize - 1, pairedAlphabetSize);
+        for (int i = 0; i < par.kmerSize && hashPairedKmer == false; i++) {
+            pairedKmerRange *= pairedAlphabetSize;
+        }
+    }
     ProbabilityMatrix *probMatrix = NULL;
     if (par.maskMode == 1) {
         probMatrix = new ProbabilityMatrix(*subMat);
@@ -106,6 +129,12 @@ std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, siz
 
         const int adjustedKmerSize = (par.adjustKmerLength) ? std::min( par.kmerSize+5, 23) :   par.kmerSize;
         Sequence seq(par.maxSeqLen, querySeqType, subMat, adjustedKmerSize, par.spacedKmer, false, true, par.spacedKmerPattern);
+        Sequence *pairedSeq = NULL;
+        unsigned char *pairedKmer = NULL;
+        if (pairedDb != NULL) {
+            pairedKmer = new unsigned char[par.kmerSize];
+            pairedSeq = new Sequence(par.maxSeqLen, pairedDb->dbr->getDbtype(), pairedDb->subMat, adjustedKmerSize, par.spacedKmer, false, true, par.spacedKmerPattern);
+        }
         KmerGenerator* generator;
         if (TYPE == Parameters::DBTYPE_HMM_PROFILE) {
             generator = new KmerGenerator( par.kmerSize, subMat->alphabetSize, 150);
@@ -130,11 +159,22 @@ std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, siz
                 memset(hierarchicalScoreDist, 0, sizeof(unsigned int) * 128);
 
                 seq.mapSequence(id, seqDbr.getDbKey(id), seqDbr.getData(id, thread_idx), seqDbr.getSeqLen(id));
+                if (pairedSeq != NULL) {
+                    unsigned int pairedId = pairedDb->dbr->getId(seq.getDbKey());
+                    if (pairedId == UINT_MAX || pairedDb->dbr->getSeqLen(pairedId) != static_cast<size_t>(seq.L)) {
+                        Debug(Debug::ERROR) << "Entry " << seq.getDbKey() << " is missing or has a different length in the paired database\n";
+                        EXIT(EXIT_FAILURE);
+                    }
+                    pairedSeq->mapSequence(pairedId, seq.getDbKey(), pairedDb->dbr->getData(pairedId, thread_idx), seq.L);
+                }
 
                 size_t seqHash =  SIZE_T_MAX;
                 //TODO, how to handle this in reverse?
                 if(hashWholeSequence){
                     seqHash = Util::hash(seq.numSequence, seq.L);
+                    if (pairedSeq != NULL) {
+                        seqHash ^= hashUInt64(Util::hash(pairedSeq->numSequence, pairedSeq->L), par.hashShift + 1);
+                    }
                     seqHash = hashUInt64(seqHash, par.hashShift);
                 }
 
@@ -201,6 +241,29 @@ std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, siz
                         }
                     } else {
                         size_t kmerIdx = idxer.int2index(kmer, 0, par.kmerSize);
+                        if (pairedSeq != NULL) {
+                            const unsigned char *pairedOffset = seq.getAAPosInSpacedPattern();
+                            const unsigned char *pairedLetters = pairedSeq->numSequence + seq.getCurrentPosition();
+                            size_t pairedIdx = 0;
+                            int kmerPos = 0;
+                            for (; kmerPos < par.kmerSize; kmerPos++) {
+                                const unsigned char letter = pairedLetters[pairedOffset[kmerPos]];
+                                if (letter >= pairedAlphabetSize) {
+                                    break;
+                                }
+                                pairedKmer[kmerPos] = letter;
+                                pairedIdx = pairedIdx * pairedAlphabetSize + letter;
+                            }
+                            // paired k-mer contains X
+                            if (kmerPos < par.kmerSize) {
+                                continue;
+                            }
+                            if (hashPairedKmer) {
+                                kmerIdx = BIT_CLEAR(XXH64(pairedKmer, par.kmerSize, kmerIdx), 63);
+                            } else {
+                                kmerIdx = kmerIdx * pairedKmerRange + pairedIdx;
+                            }
+                        }
                         (kmers + seqKmerCount)->kmer = kmerIdx;
                         (kmers + seqKmerCount)->pos = seq.getCurrentPosition();
                         const unsigned short hash = hashUInt64(kmerIdx, par.hashShift);
@@ -354,6 +417,9 @@ std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, siz
 #endif
             if (thread_idx == 0) {
                 seqDbr.remapData();
+                if (pairedDb != NULL) {
+                    pairedDb->dbr->remapData();
+                }
             }
 #pragma omp barrier
         }
@@ -372,6 +438,10 @@ std::pair<size_t, size_t> fillKmerPositionArray(KmerPosition<T> * kmerArray, siz
         if (TYPE == Parameters::DBTYPE_HMM_PROFILE) {
             delete generator;
         }
+        if (pairedSeq != NULL) {
+            delete pairedSeq;
+            delete[] pairedKmer;
+        }
     }
 
     if (TYPE == Parameters::DBTYPE_HMM_PROFILE) {
@@ -440,7 +510,8 @@ template void swapCenterSequence<1, int>(KmerPosition<int> *kmers, size_t splitK
 
 template <typename T>
 KmerPosition<T> * doComputation(size_t totalKmers, size_t hashStartRange, size_t hashEndRange, std::string splitFile,
-                                DBReader<unsigned int> & seqDbr, Parameters & par, BaseMatrix  * subMat) {
+                                DBReader<unsigned int> & seqDbr, Parameters & par, BaseMatrix  * subMat,
+                                KmerPairedDb * pairedDb) {
 
     KmerPosition<T> * hashSeqPair = initKmerPositionMemory<T>(totalKmers);
     size_t elementsToSort;
@@ -450,11 +521,14 @@ KmerPosition<T> * doComputation(size_t totalKmers, size_t hashStartRange, size_t
         par.kmerSize = ret.second;
         Debug(Debug::INFO) << "\nAdjusted k-mer length " << par.kmerSize << "\n";
     }else{
-        std::pair<size_t, size_t > ret = fillKmerPositionArray<Parameters::DBTYPE_AMINO_ACIDS, T>(hashSeqPair, totalKmers, seqDbr, par, subMat, true, hashStartRange, hashEndRange, NULL);
+        std::pair<size_t, size_t > ret = fillKmerPositionArray<Parameters::DBTYPE_AMINO_ACIDS, T>(hashSeqPair, totalKmers, seqDbr, par, subMat, true, hashStartRange, hashEndRange, NULL, pairedDb);
         elementsToSort = ret.first;
     }
     if(hashEndRange == SIZE_T_MAX){
         seqDbr.unmapData();
+        if (pairedDb != NULL) {
+            pairedDb->dbr->unmapData();
+        }
     }
 
     Debug(Debug::INFO) << "Sort kmer ";
@@ -673,7 +747,7 @@ size_t computeMemoryNeededLinearfilter(size_t totalKmer) {
 
 
 template <typename T>
-int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
+int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr, KmerPairedDb * pairedDb) {
 
     int querySeqType = seqDbr.getDbtype();
     BaseMatrix *subMat;
@@ -703,7 +777,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
     size_t totalKmersPerSplit = std::max(static_cast<size_t>(1024+1),
                                          static_cast<size_t>(std::min(totalSizeNeeded, memoryLimit)/sizeof(KmerPosition<T>))+1);
 
-    std::vector<std::pair<size_t, size_t>> hashRanges = setupKmerSplits<T>(par, subMat, seqDbr, totalKmersPerSplit, splits);
+    std::vector<std::pair<size_t, size_t>> hashRanges = setupKmerSplits<T>(par, subMat, seqDbr, totalKmersPerSplit, splits, pairedDb);
     if(splits > 1){
         Debug(Debug::INFO) << "Process file into " << hashRanges.size() << " parts\n";
     }
@@ -731,7 +805,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
 
     for(size_t split = fromSplit; split < fromSplit+splitCount; split++) {
         std::string splitFileName = par.db2 + "_split_" +SSTR(split);
-        hashSeqPair = doComputation<T>(totalKmers, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat);
+        hashSeqPair = doComputation<T>(totalKmers, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat, pairedDb);
     }
     MPI_Barrier(MPI_COMM_WORLD);
     if(mpiRank == 0){
@@ -747,7 +821,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
 
         std::string splitFileNameDone = splitFileName + ".done";
         if(FileUtil::fileExists(splitFileNameDone.c_str()) == false){
-            hashSeqPair = doComputation<T>(totalKmersPerSplit, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat);
+            hashSeqPair = doComputation<T>(totalKmersPerSplit, hashRanges[split].first, hashRanges[split].second, splitFileName, seqDbr, par, subMat, pairedDb);
         }
 
         splitFiles.push_back(splitFileName);
@@ -816,7 +890,8 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
 }
 
 template <typename T>
-std::vector<std::pair<size_t, size_t>> setupKmerSplits(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits){
+std::vector<std::pair<size_t, size_t>> setupKmerSplits(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits,
+                                                       KmerPairedDb * pairedDb){
     std::vector<std::pair<size_t, size_t>> hashRanges;
     if (splits > 1) {
         Debug(Debug::INFO) << "Not enough memory to process at once need to split\n";
@@ -826,9 +901,12 @@ std::vector<std::pair<size_t, size_t>> setupKmerSplits(Parameters &par, BaseMatr
         if(Parameters::isEqualDbtype(seqDbr.getDbtype(), Parameters::DBTYPE_NUCLEOTIDES)){
             fillKmerPositionArray<Parameters::DBTYPE_NUCLEOTIDES, T>(NULL, SIZE_T_MAX, seqDbr, par, subMat, true, 0, SIZE_T_MAX, hashDist);
         }else{
-            fillKmerPositionArray<Parameters::DBTYPE_AMINO_ACIDS, T>(NULL, SIZE_T_MAX, seqDbr, par, subMat, true, 0, SIZE_T_MAX, hashDist);
+            fillKmerPositionArray<Parameters::DBTYPE_AMINO_ACIDS, T>(NULL, SIZE_T_MAX, seqDbr, par, subMat, true, 0, SIZE_T_MAX, hashDist, pairedDb);
         }
         seqDbr.remapData();
+        if (pairedDb != NULL) {
+            pairedDb->dbr->remapData();
+        }
         // figure out if machine has enough memory to run this job
         size_t maxBucketSize = 0;
         for(size_t i = 0; i < (USHRT_MAX+1); i++) {
@@ -1310,17 +1388,17 @@ void setKmerLengthAndAlphabet(Parameters &parameters, size_t aaDbSize, int seqTy
 }
 
 template std::pair<size_t, size_t>  fillKmerPositionArray<0, short>(KmerPosition<short> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
-                                                                    Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                                    Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution, KmerPairedDb * pairedDb);
 template std::pair<size_t, size_t>  fillKmerPositionArray<1, short>(KmerPosition<short> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
-                                                                    Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                                    Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution, KmerPairedDb * pairedDb);
 template std::pair<size_t, size_t>  fillKmerPositionArray<2, short>(KmerPosition<short> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
-                                                                    Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                                    Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution, KmerPairedDb * pairedDb);
 template std::pair<size_t, size_t>  fillKmerPositionArray<0, int>(KmerPosition<int> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
-                                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution, KmerPairedDb * pairedDb);
 template std::pair<size_t, size_t>  fillKmerPositionArray<1, int>(KmerPosition <int>* kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
-                                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution, KmerPairedDb * pairedDb);
 template std::pair<size_t, size_t>  fillKmerPositionArray<2, int>(KmerPosition< int> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
-                                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence, size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution, KmerPairedDb * pairedDb);
 
 template KmerPosition<short> *initKmerPositionMemory(size_t size);
 template KmerPosition<int> *initKmerPositionMemory(size_t size);
@@ -1328,7 +1406,10 @@ template KmerPosition<int> *initKmerPositionMemory(size_t size);
 template size_t computeMemoryNeededLinearfilter<short>(size_t totalKmer);
 template size_t computeMemoryNeededLinearfilter<int>(size_t totalKmer);
 
-template std::vector<std::pair<size_t, size_t>>  setupKmerSplits<short>(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits);
-template std::vector<std::pair<size_t, size_t>>  setupKmerSplits<int>(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits);
+template std::vector<std::pair<size_t, size_t>>  setupKmerSplits<short>(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits, KmerPairedDb * pairedDb);
+template std::vector<std::pair<size_t, size_t>>  setupKmerSplits<int>(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits, KmerPairedDb * pairedDb);
+
+template int kmermatcherInner<short>(Parameters& par, DBReader<unsigned int>& seqDbr, KmerPairedDb * pairedDb);
+template int kmermatcherInner<int>(Parameters& par, DBReader<unsigned int>& seqDbr, KmerPairedDb * pairedDb);
 
 #undef SIZE_T_MAX
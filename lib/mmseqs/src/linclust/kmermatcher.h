@@ -213,17 +213,32 @@ void writeKmerMatcherResult(DBWriter & dbw, KmerPosition<T> *hashSeqPair, size_t
                             std::vector<char> &repSequence, size_t threads);
 
 
+// second database with the same keys and lengths as the k-mer database (e.g. amino acids next to 3Di)
+// its letters at the k-mer positions are appended to the k-mer key
+struct KmerPairedDb {
+    KmerPairedDb(DBReader<unsigned int> * dbr, BaseMatrix * subMat) : dbr(dbr), subMat(subMat) {}
+    DBReader<unsigned int> * dbr;
+    BaseMatrix * subMat;
+};
+
+// true if the k-mer index with the paired letters appended does not fit into 63 bits, such keys are hashed
+bool pairedKmerNeedsHash(int kmerSize, size_t alphabetSize, size_t pairedAlphabetSize);
+
 template <typename T>
-KmerPosition<T> * doComputation(size_t totalKmers, size_t split, size_t splits, std::string splitFile,
+KmerPosition<T> * doComputation(size_t totalKmers, size_t hashStartRange, size_t hashEndRange, std::string splitFile,
                                 DBReader<unsigned int> & seqDbr, Parameters & par, BaseMatrix  * subMat,
-                                size_t KMER_SIZE, size_t chooseTopKmer, float chooseTopKmerScale = 0.0);
+                                KmerPairedDb * pairedDb = NULL);
 template <typename T>
 KmerPosition<T> *initKmerPositionMemory(size_t size);
 
 template <int TYPE, typename T>
 std::pair<size_t, size_t>  fillKmerPositionArray(KmerPosition<T> * kmerArray, size_t kmerArraySize, DBReader<unsigned int> &seqDbr,
                                                  Parameters & par, BaseMatrix * subMat, bool hashWholeSequence,
-                                                 size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution);
+                                                 size_t hashStartRange, size_t hashEndRange, size_t * hashDistribution,
+                                                 KmerPairedDb * pairedDb = NULL);
+
+template <typename T>
+int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr, KmerPairedDb * pairedDb = NULL);
 
 
 void maskSequence(int maskMode, int maskLowerCase,
@@ -233,7 +248,8 @@ template <typename T>
 size_t computeMemoryNeededLinearfilter(size_t totalKmer);
 
 template <typename T>
-std::vector<std::pair<size_t, size_t>> setupKmerSplits(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits);
+std::vector<std::pair<size_t, size_t>> setupKmerSplits(Parameters &par, BaseMatrix * subMat, DBReader<unsigned int> &seqDbr, size_t totalKmers, size_t splits,
+                                                       KmerPairedDb * pairedDb = NULL);
 
 size_t computeKmerCount(DBReader<unsigned int> &reader, size_t KMER_SIZE, size_t chooseTopKmer,
                         float chooseTopKmerScale = 0.0);
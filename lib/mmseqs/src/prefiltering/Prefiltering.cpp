@@ -25,7 +25,8 @@ Prefiltering::Prefiltering(const std::string &queryDB,
                            const std::string &targetDB,
                            const std::string &targetDBIndex,
                            int querySeqType, int targetSeqType,
-                           const Parameters &par) :
+                           const Parameters &par,
+                           PrefilterPairedDb *pairedDb) :
         queryDB(queryDB),
         queryDBIndex(queryDBIndex),
         targetDB(targetDB),
@@ -52,7 +53,8 @@ Prefiltering::Prefiltering(const std::string &queryDB,
         aaBiasCorrectionScale(par.compBiasCorrectionScale),
         covThr(par.covThr), covMode(par.covMode), includeIdentical(par.includeIdentity),
         preloadMode(par.preloadMode),
-        threads(static_cast<unsigned int>(par.threads)), compressed(par.compressed) {
+        threads(static_cast<unsigned int>(par.threads)), compressed(par.compressed),
+        pairedDb(pairedDb), pairedQdbr(NULL), pairedTdbr(NULL) {
     sameQTDB = isSameQTDB();
 
     // init the substitution matrices
@@ -186,6 +188,14 @@ Prefiltering::Prefiltering(const std::string &queryDB,
     }
     Debug(Debug::INFO) << "Query database size: " << qdbr->getSize() << " type: " << Parameters::getDbTypeName(querySeqType) << "\n";
 
+    if (pairedDb != NULL && diagonalScoring) {
+        pairedQdbr = new DBReader<unsigned int>(pairedDb->queryDB.c_str(), pairedDb->queryDBIndex.c_str(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+        pairedQdbr->open(DBReader<unsigned int>::NOSORT);
+        pairedTdbr = new DBReader<unsigned int>(pairedDb->targetDB.c_str(), pairedDb->targetDBIndex.c_str(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+        pairedTdbr->open(DBReader<unsigned int>::NOSORT);
+        Debug(Debug::INFO) << "Paired database type: " << pairedTdbr->getDbTypeName() << "\n";
+    }
+
     setupSplit(*tdbr, alphabetSize - 1, querySeqType,
                threads, templateDBIsIndex, memoryLimit, qdbr->getSize(),
                maxResListLen, kmerSize, splits, splitMode);
@@ -233,6 +243,15 @@ Prefiltering::~Prefiltering() {
         delete taxonomyHook;
     }
 
+    if (pairedQdbr != NULL) {
+        pairedQdbr->close();
+        delete pairedQdbr;
+    }
+    if (pairedTdbr != NULL) {
+        pairedTdbr->close();
+        delete pairedTdbr;
+    }
+
     if (sameQTDB == false) {
         qdbr->close();
         delete qdbr;
@@ -512,6 +531,7 @@ void Prefiltering::getIndexTable(int split, size_t dbFrom, size_t dbSize) {
         // only the ungapped alignment needs the sequence lookup, we can save quite some memory here
         if (diagonalScoring) {
             sequenceLookup = PrefilteringIndexReader::getSequenceLookup(split, tidxdbr, preloadMode);
+            fillPairedSequenceLookup(dbFrom, dbSize);
         }
     } else {
         Timer timer;
@@ -537,6 +557,8 @@ void Prefiltering::getIndexTable(int split, size_t dbFrom, size_t dbSize) {
         if (diagonalScoring == false) {
             delete sequenceLookup;
             sequenceLookup = NULL;
+        } else {
+            fillPairedSequenceLookup(dbFrom, dbSize);
         }
 
         indexTable->printStatistics(kmerSubMat->num2aa);
@@ -545,6 +567,38 @@ void Prefiltering::getIndexTable(int split, size_t dbFrom, size_t dbSize) {
     }
 }
 
+void Prefiltering::fillPairedSequenceLookup(size_t dbFrom, size_t dbSize) {
+    if (pairedTdbr == NULL || sequenceLookup == NULL) {
+        return;
+    }
+    Timer timer;
+    sequenceLookup->initPairedData();
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+        Sequence pairedSeq(pairedTdbr->getMaxSeqLen(), pairedTdbr->getDbtype(), pairedDb->subMat, 0, false, false);
+#pragma omp for schedule(dynamic, 100)
+        for (size_t id = dbFrom; id < dbFrom + dbSize; id++) {
+            unsigned int key = tdbr->getDbKey(id);
+            size_t pairedId = pairedTdbr->getId(key);
+            if (pairedId == UINT_MAX) {
+                Debug(Debug::ERROR) << "Entry " << key << " is missing in the paired target database\n";
+                EXIT(EXIT_FAILURE);
+            }
+            pairedSeq.mapSequence(pairedId, key, pairedTdbr->getData(pairedId, thread_idx), pairedTdbr->getSeqLen(pairedId));
+            if (static_cast<unsigned int>(pairedSeq.L) != sequenceLookup->getSequence(id - dbFrom).second) {
+                Debug(Debug::ERROR) << "Entry " << key << " has a different length in the paired target database\n";
+                EXIT(EXIT_FAILURE);
+            }
+            sequenceLookup->addPairedSequence(pairedSeq.numSequence, pairedSeq.L, id - dbFrom);
+        }
+    }
+    Debug(Debug::INFO) << "Time for paired sequence lookup init: " << timer.lap() << "\n";
+}
+
 bool Prefiltering::isSameQTDB() {
     //  check if when qdb and tdb have the same name an index extension exists
     std::string check(targetDB);
@@ -804,6 +858,12 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
             matcher.setQueryMatcherHook(taxonomyHook);
         }
 
+        Sequence *pairedSeq = NULL;
+        if (pairedQdbr != NULL) {
+            pairedSeq = new Sequence(pairedQdbr->getMaxSeqLen(), pairedQdbr->getDbtype(), pairedDb->subMat, 0, false, false);
+            matcher.setPairedSubstitutionMatrix(pairedDb->subMat);
+        }
+
         char buffer[128];
         std::string result;
         result.reserve(1000000);
@@ -829,11 +889,19 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
                     targetSeqId = UINT_MAX;
                 }
             }
+            if (pairedSeq != NULL) {
+                size_t pairedId = pairedQdbr->getId(qKey);
+                if (pairedId == UINT_MAX) {
+                    Debug(Debug::ERROR) << "Entry " << qKey << " is missing in the paired query database\n";
+                    EXIT(EXIT_FAILURE);
+                }
+                pairedSeq->mapSequence(pairedId, qKey, pairedQdbr->getData(pairedId, thread_idx), pairedQdbr->getSeqLen(pairedId));
+            }
             // calculate prefiltering results
             if (taxonomyHook != NULL) {
                 taxonomyHook->setDbFrom(dbFrom);
             }
-            std::pair<hit_t *, size_t> prefResults = matcher.matchQuery(&seq, targetSeqId, targetSeqType==Parameters::DBTYPE_NUCLEOTIDES);
+            std::pair<hit_t *, size_t> prefResults = matcher.matchQuery(&seq, targetSeqId, targetSeqType==Parameters::DBTYPE_NUCLEOTIDES, pairedSeq);
             size_t resultSize = prefResults.second;
             const float queryLength = static_cast<float>(qdbr->getSeqLen(id));
             for (size_t i = 0; i < resultSize; i++) {
@@ -879,6 +947,9 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
                 reslens[thread_idx]->emplace_back(resultSize);
             }
         } // step end
+        if (pairedSeq != NULL) {
+            delete pairedSeq;
+        }
     }
 
     if (Debug::debugLevel >= Debug::INFO) {
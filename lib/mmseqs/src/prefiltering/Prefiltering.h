@@ -24,6 +24,20 @@ struct KmerThreshold{
 
 extern std::vector<KmerThreshold> externalThreshold;
 
+// Second alphabet of the query and target databases (e.g. the amino acids of 3Di databases).
+// Its substitution scores are added to the ungapped diagonal scores. Entries are matched by key
+// and need the same length as in the prefilter databases.
+struct PrefilterPairedDb {
+    PrefilterPairedDb(const std::string &queryDB, const std::string &queryDBIndex,
+                      const std::string &targetDB, const std::string &targetDBIndex, BaseMatrix *subMat)
+            : queryDB(queryDB), queryDBIndex(queryDBIndex), targetDB(targetDB), targetDBIndex(targetDBIndex), subMat(subMat) {}
+    std::string queryDB;
+    std::string queryDBIndex;
+    std::string targetDB;
+    std::string targetDBIndex;
+    BaseMatrix *subMat;
+};
+
 
 class Prefiltering {
 public:
@@ -33,7 +47,8 @@ public:
             const std::string &targetDB,
             const std::string &targetDBIndex,
             int querySeqType, int targetSeqType,
-            const Parameters &par);
+            const Parameters &par,
+            PrefilterPairedDb *pairedDb = NULL);
 
     ~Prefiltering();
 
@@ -113,6 +128,12 @@ private:
     int compressed;
     QueryMatcherTaxonomyHook* taxonomyHook;
 
+    PrefilterPairedDb *pairedDb;
+    DBReader<unsigned int> *pairedQdbr;
+    DBReader<unsigned int> *pairedTdbr;
+
+    void fillPairedSequenceLookup(size_t dbFrom, size_t dbSize);
+
     bool runSplit(const std::string &resultDB, const std::string &resultDBIndex, size_t split, bool merge);
 
     // compute kmer size and split size for index table
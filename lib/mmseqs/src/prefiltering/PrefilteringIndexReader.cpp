@@ -43,6 +43,20 @@ bool PrefilteringIndexReader::checkIfIndexFile(DBReader<unsigned int>* reader) {
     return (strncmp(version, index_version_compatible, strlen(index_version_compatible)) == 0 ) ? true : false;
 }
 
+unsigned int PrefilteringIndexReader::dictionaryKey(unsigned int dataKey) {
+    return dataKey | (1u << 30);
+}
+
+// entries are copied into the index as they are stored, so compressed entries need their dictionary
+void PrefilteringIndexReader::writeDictionary(DBWriter &writer, DBReader<unsigned int> *reader, unsigned int dataKey, unsigned int thrIdx) {
+    if (reader->hasDictionary() == false) {
+        return;
+    }
+    const std::string &dictionary = reader->getDictionary();
+    writer.writeData(dictionary.c_str(), dictionary.size(), dictionaryKey(dataKey), thrIdx);
+    writer.alignToPageSize(thrIdx);
+}
+
 std::string PrefilteringIndexReader::indexName(const std::string &outDB) {
     std::string result(outDB);
     result.append(".idx");
@@ -134,11 +148,13 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
     }
     writer.writeEnd(DBR1DATA, SPLIT_SEQS);
     writer.alignToPageSize(SPLIT_SEQS);
+    writeDictionary(writer, dbr1, DBR1DATA, SPLIT_SEQS);
     free(data);
 
     if (dbr2 == NULL) {
         writer.writeIndexEntry(DBR2INDEX, offsetIndex, DBReader<unsigned int>::indexMemorySize(*dbr1)+1, SPLIT_SEQS);
         writer.writeIndexEntry(DBR2DATA,  offsetData,  dbr1->getTotalDataSize()+1, SPLIT_SEQS);
+        writeDictionary(writer, dbr1, DBR2DATA, SPLIT_SEQS);
     } else {
         Debug(Debug::INFO) << "Write DBR2INDEX (" << DBR2INDEX << ")\n";
         data = DBReader<unsigned int>::serialize(*dbr2);
@@ -151,6 +167,7 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         }
         writer.writeEnd(DBR2DATA, SPLIT_SEQS);
         writer.alignToPageSize(SPLIT_SEQS);
+        writeDictionary(writer, dbr2, DBR2DATA, SPLIT_SEQS);
         free(data);
     }
 
@@ -169,10 +186,12 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         }
         writer.writeEnd(HDR1DATA, SPLIT_SEQS);
         writer.alignToPageSize(SPLIT_SEQS);
+        writeDictionary(writer, hdbr1, HDR1DATA, SPLIT_SEQS);
         free(data);
         if (hdbr2 == NULL) {
             writer.writeIndexEntry(HDR2INDEX, offsetIndex, DBReader<unsigned int>::indexMemorySize(*hdbr1)+1, SPLIT_SEQS);
             writer.writeIndexEntry(HDR2DATA,  offsetData, hdbr1->getTotalDataSize()+1, SPLIT_SEQS);
+            writeDictionary(writer, hdbr1, HDR2DATA, SPLIT_SEQS);
         }
     }
     if (hdbr2 != NULL) {
@@ -187,6 +206,7 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         }
         writer.writeEnd(HDR2DATA, SPLIT_SEQS);
         writer.alignToPageSize(SPLIT_SEQS);
+        writeDictionary(writer, hdbr2, HDR2DATA, SPLIT_SEQS);
         free(data);
     }
     if (alndbr != NULL) {
@@ -201,6 +221,7 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         }
         writer.writeEnd(ALNDATA, SPLIT_SEQS);
         writer.alignToPageSize(SPLIT_SEQS);
+        writeDictionary(writer, alndbr, ALNDATA, SPLIT_SEQS);
         free(data);
     }
 
@@ -285,6 +306,13 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
     writer.close(false);
 }
 
+static void setDictionary(DBReader<unsigned int> *dbr, DBReader<unsigned int> *reader, unsigned int dataIdx) {
+    size_t id = dbr->getId(PrefilteringIndexReader::dictionaryKey(dataIdx));
+    if (id != UINT_MAX) {
+        reader->setDictionary(dbr->getDataUncompressed(id), dbr->getEntryLen(id) - 1);
+    }
+}
+
 DBReader<unsigned int> *PrefilteringIndexReader::openNewHeaderReader(DBReader<unsigned int>*dbr, unsigned int dataIdx, unsigned int indexIdx, int threads,  bool touchIndex, bool touchData) {
     size_t indexId = dbr->getId(indexIdx);
     char *indexData = dbr->getData(indexId, 0);
@@ -307,6 +335,7 @@ DBReader<unsigned int> *PrefilteringIndexReader::openNewHeaderReader(DBReader<un
     reader->open(DBReader<unsigned int>::NOSORT);
     reader->setData(data, dataSize);
     reader->setMode(DBReader<unsigned int>::USE_DATA);
+    setDictionary(dbr, reader, dataIdx);
     return reader;
 }
 
@@ -333,6 +362,7 @@ DBReader<unsigned int> *PrefilteringIndexReader::openNewReader(DBReader<unsigned
         size_t dataSize = nextDataOffset-currDataOffset;
         reader->setData(dbr->getDataUncompressed(id), dataSize);
         reader->setMode(DBReader<unsigned int>::USE_DATA);
+        setDictionary(dbr, reader, dataIdx);
         return reader;
     }
 
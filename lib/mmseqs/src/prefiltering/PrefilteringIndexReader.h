@@ -4,6 +4,7 @@
 #include "BaseMatrix.h"
 #include "IndexTable.h"
 #include "DBReader.h"
+#include "DBWriter.h"
 #include <string>
 
 struct PrefilteringIndexData {
@@ -51,6 +52,11 @@ public:
     static unsigned int ALNINDEX;
     static unsigned int ALNDATA;
 
+    // key of the zstd dictionary of a data entry, for databases compressed with a dictionary
+    static unsigned int dictionaryKey(unsigned int dataKey);
+
+    static void writeDictionary(DBWriter &writer, DBReader<unsigned int> *reader, unsigned int dataKey, unsigned int thrIdx);
+
     static bool checkIfIndexFile(DBReader<unsigned int> *reader);
     static std::string indexName(const std::string &outDB);
 
@@ -82,7 +82,8 @@ QueryMatcher::~QueryMatcher(){
     delete kmerGenerator;
 }
 
-std::pair<hit_t*, size_t> QueryMatcher::matchQuery(Sequence *querySeq, unsigned int identityId, bool isNucleotide) {
+std::pair<hit_t*, size_t> QueryMatcher::matchQuery(Sequence *querySeq, unsigned int identityId, bool isNucleotide,
+                                                   Sequence *pairedQuerySeq) {
     querySeq->resetCurrPos();
 //    std::cout << "Id: " << querySeq->getId() << std::endl;
     memset(scoreSizes, 0, SCORE_RANGE * sizeof(unsigned int));
@@ -105,7 +106,7 @@ std::pair<hit_t*, size_t> QueryMatcher::matchQuery(Sequence *querySeq, unsigned
     std::pair<hit_t *, size_t> queryResult;
     if (diagonalScoring) {
         // write diagonal scores in count value
-        ungappedAlignment->processQuery(querySeq, compositionBias, foundDiagonals, resultSize);
+        ungappedAlignment->processQuery(querySeq, compositionBias, foundDiagonals, resultSize, pairedQuerySeq);
         memset(scoreSizes, 0, SCORE_RANGE * sizeof(unsigned int));
         CounterResult * resultReadPos  = foundDiagonals;
         CounterResult * resultWritePos = foundDiagonals + resultSize;
@@ -160,7 +161,7 @@ std::pair<hit_t*, size_t> QueryMatcher::matchQuery(Sequence *querySeq, unsigned
             std::swap(resultReadPos, resultWritePos);
             if (scoreIsTruncated == true) {
                 memset(scoreSizes, 0, SCORE_RANGE * sizeof(unsigned int));
-                std::pair<size_t, unsigned int> rescoreResult = rescoreHits(querySeq, scoreSizes, resultReadPos, elementsCntAboveDiagonalThr, ungappedAlignment, maxDiagonalScoreThr);
+                std::pair<size_t, unsigned int> rescoreResult = rescoreHits(querySeq, pairedQuerySeq, scoreSizes, resultReadPos, elementsCntAboveDiagonalThr, ungappedAlignment, maxDiagonalScoreThr);
                 size_t newResultSize = rescoreResult.first;
                 unsigned int maxSelfScoreMinusDiag = rescoreResult.second;
                 elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, resultWritePos, 0, resultReadPos, newResultSize);
@@ -515,11 +516,12 @@ size_t QueryMatcher::radixSortByScoreSize(const unsigned int * scoreSizes,
     return aboveThresholdCnt;
 }
 
-std::pair<size_t, unsigned int> QueryMatcher::rescoreHits(Sequence * querySeq, unsigned int * scoreSizes, CounterResult *results,
+std::pair<size_t, unsigned int> QueryMatcher::rescoreHits(Sequence * querySeq, Sequence * pairedQuerySeq, unsigned int * scoreSizes, CounterResult *results,
                                                           size_t resultSize, UngappedAlignment *align, int lowerBoundScore) {
     size_t elements = 0;
     const unsigned char * query = querySeq->numSequence;
-    int maxSelfScore = align->scoreSingleSequence(std::make_pair(query, querySeq->L), 0,0);
+    const unsigned char * pairedQuery = (pairedQuerySeq != NULL) ? pairedQuerySeq->numSequence : NULL;
+    int maxSelfScore = align->scoreSingleSequence(std::make_pair(query, querySeq->L), 0, 0, pairedQuery);
 
     maxSelfScore = (maxSelfScore-lowerBoundScore);
     maxSelfScore = std::max(1, maxSelfScore);
@@ -61,7 +61,17 @@ public:
 
     // returns result for the sequence
     // identityId is the id of the identitical sequence in the target database if there is any, UINT_MAX otherwise
-    std::pair<hit_t*, size_t> matchQuery(Sequence *querySeq, unsigned int identityId,  bool isNucleotide);
+    // pairedQuerySeq is the query in the paired alphabet (see setPairedSubstitutionMatrix)
+    std::pair<hit_t*, size_t> matchQuery(Sequence *querySeq, unsigned int identityId,  bool isNucleotide,
+                                         Sequence *pairedQuerySeq = NULL);
+
+    // the ungapped diagonal scoring adds the scores of a second alphabet, whose target sequences
+    // are stored as paired data in the SequenceLookup
+    void setPairedSubstitutionMatrix(BaseMatrix *pairedSubMat) {
+        if (ungappedAlignment != NULL) {
+            ungappedAlignment->setPairedSubstitutionMatrix(pairedSubMat);
+        }
+    }
 
     void setQueryMatcherHook(QueryMatcherHook* hook) {
         this->hook = hook;
@@ -233,7 +243,7 @@ protected:
                                 CounterResult *writePos, const unsigned int scoreThreshold,
                                 const CounterResult *results, const size_t resultSize);
 
-    std::pair<size_t, unsigned int> rescoreHits(Sequence * querySeq, unsigned int *scoreSizes, CounterResult *results,
+    std::pair<size_t, unsigned int> rescoreHits(Sequence * querySeq, Sequence * pairedQuerySeq, unsigned int *scoreSizes, CounterResult *results,
                                                 size_t resultSize, UngappedAlignment *align, int lowerBoundScore);
 
 #define CacheFriendlyOperations(x)  CacheFriendlyOperations<x> * cachedOperation##x
@@ -9,7 +9,7 @@
 #include "SequenceLookup.h"
 
 SequenceLookup::SequenceLookup(size_t sequenceCount, size_t dataSize)
-        : sequenceCount(sequenceCount), dataSize(dataSize), currentIndex(0), currentOffset(0), externalData(false) {
+        : sequenceCount(sequenceCount), dataSize(dataSize), pairedData(NULL), currentIndex(0), currentOffset(0), externalData(false) {
     data = new(std::nothrow) char[dataSize + 1];
     Util::checkAllocation(data, "Can not allocate data memory in SequenceLookup");
 
@@ -19,7 +19,7 @@ SequenceLookup::SequenceLookup(size_t sequenceCount, size_t dataSize)
 }
 
 SequenceLookup::SequenceLookup(size_t sequenceCount)
-        : sequenceCount(sequenceCount), data(NULL), dataSize(0), offsets(NULL), currentIndex(0), currentOffset(0), externalData(true) {
+        : sequenceCount(sequenceCount), data(NULL), dataSize(0), offsets(NULL), pairedData(NULL), currentIndex(0), currentOffset(0), externalData(true) {
 }
 
 SequenceLookup::~SequenceLookup() {
@@ -27,6 +27,18 @@ SequenceLookup::~SequenceLookup() {
         delete[] data;
         delete[] offsets;
     }
+    delete[] pairedData;
+}
+
+void SequenceLookup::initPairedData() {
+    delete[] pairedData;
+    pairedData = new(std::nothrow) char[dataSize + 1];
+    Util::checkAllocation(pairedData, "Can not allocate paired data memory in SequenceLookup");
+    memset(pairedData, 0, dataSize + 1);
+}
+
+void SequenceLookup::addPairedSequence(const unsigned char *seq, int L, size_t index) {
+    memcpy(&pairedData[offsets[index]], seq, L);
 }
 
 void SequenceLookup::addSequence(unsigned char *seq, int L, size_t index, size_t offset){
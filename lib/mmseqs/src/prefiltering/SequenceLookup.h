@@ -35,6 +35,17 @@ public:
     void initLookupByExternalData(char *seqData, size_t dataSize, size_t *seqOffsets);
     void initLookupByExternalDataCopy(char *seqData, size_t *seqOffsets);
 
+    // optional second sequence per entry (e.g. amino acids of a 3Di database), it has to have
+    // the same length and is stored at the same offsets as the primary sequence
+    void initPairedData();
+    void addPairedSequence(const unsigned char *seq, int L, size_t index);
+    const unsigned char *getPairedSequence(size_t id) {
+        return reinterpret_cast<const unsigned char*>(pairedData + offsets[id]);
+    }
+    bool hasPairedData() {
+        return pairedData != NULL;
+    }
+
 private:
     size_t sequenceCount;
 
@@ -44,6 +55,9 @@ private:
 
     size_t *offsets;
 
+    // owned by the lookup, also if data is external
+    char *pairedData;
+
     // write position
     size_t currentIndex;
     size_t currentOffset;
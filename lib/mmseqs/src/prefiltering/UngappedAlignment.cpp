@@ -5,7 +5,8 @@
 
 UngappedAlignment::UngappedAlignment(const unsigned int maxSeqLen,
                                      BaseMatrix *substitutionMatrix, SequenceLookup *sequenceLookup)
-        : subMatrix(substitutionMatrix), sequenceLookup(sequenceLookup) {
+        : maxSeqLen(maxSeqLen), subMatrix(substitutionMatrix), sequenceLookup(sequenceLookup),
+          pairedSubMatrix(NULL), profileStride(Sequence::PROFILE_AA_SIZE + 1), pairedScoring(false) {
     score_arr = new unsigned int[DIAGONALBINSIZE];
     diagonalCounter = new unsigned char[DIAGONALCOUNT];
     queryProfile   = (char *) malloc_simd_int((Sequence::PROFILE_AA_SIZE + 1) * maxSeqLen);
@@ -22,11 +23,30 @@ UngappedAlignment::~UngappedAlignment() {
     delete [] score_arr;
 }
 
+void UngappedAlignment::setPairedSubstitutionMatrix(BaseMatrix *pairedSubstitutionMatrix) {
+    pairedSubMatrix = pairedSubstitutionMatrix;
+    // every profile column holds the scores of both alphabets, so both letters of a
+    // position are looked up in the same cache line
+    free(queryProfile);
+    queryProfile = (char *) malloc_simd_int(2 * (Sequence::PROFILE_AA_SIZE + 1) * maxSeqLen);
+    memset(queryProfile, 0, 2 * (Sequence::PROFILE_AA_SIZE + 1) * maxSeqLen);
+}
+
 void UngappedAlignment::processQuery(Sequence *seq,
                                      float *biasCorrection,
                                      CounterResult *results,
-                                     size_t resultSize) {
+                                     size_t resultSize,
+                                     Sequence *pairedSeq) {
+    pairedScoring = pairedSubMatrix != NULL && pairedSeq != NULL && sequenceLookup->hasPairedData();
+    profileStride = pairedScoring ? 2 * (Sequence::PROFILE_AA_SIZE + 1) : (Sequence::PROFILE_AA_SIZE + 1);
     createProfile(seq, biasCorrection, subMatrix->subMatrix);
+    if (pairedScoring) {
+        if (pairedSeq->L != seq->L) {
+            Debug(Debug::ERROR) << "Paired sequence of query " << seq->getDbKey() << " has a different length\n";
+            EXIT(EXIT_FAILURE);
+        }
+        createPairedProfile(pairedSeq);
+    }
     queryLen = seq->L;
     computeScores(queryProfile, seq->L, results, resultSize);
 }
@@ -34,11 +54,15 @@ void UngappedAlignment::processQuery(Sequence *seq,
 
 int UngappedAlignment::scalarDiagonalScoring(const char * profile,
                                              const unsigned int seqLen,
-                                             const unsigned char * dbSeq) {
+                                             const unsigned char * dbSeq,
+                                             const unsigned char * pairedDbSeq) {
     int max = 0;
     int score = 0;
     for(unsigned int pos = 0; pos < seqLen; pos++){
-        int curr = *((profile + pos * (Sequence::PROFILE_AA_SIZE + 1)) + dbSeq[pos]);
+        int curr = *((profile + pos * profileStride) + dbSeq[pos]);
+        if (pairedDbSeq != NULL) {
+            curr += *((profile + pos * profileStride) + (Sequence::PROFILE_AA_SIZE + 1) + pairedDbSeq[pos]);
+        }
         score = curr + score;
         score = (score < 0) ? 0 : score;
 //        std::cout << (int) dbSeq[pos] << "\t" << curr << "\t" << max << "\t" << score <<  "\t" << (curr - bias) << std::endl;
@@ -47,10 +71,14 @@ int UngappedAlignment::scalarDiagonalScoring(const char * profile,
     return max;
 }
 
-template <unsigned int T>
+// in paired mode every profile column holds the scores of the second alphabet after the first
+#define DIAGONAL_SUBSCORE(k) (profileColumn[dbSeq[k][pos]] + (Paired ? profileColumn[(Sequence::PROFILE_AA_SIZE + 1) + pairedDbSeq[k][pos]] : 0))
+
+template <unsigned int T, bool Paired>
 void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
                                                 const unsigned int * seqLen,
                                                 const unsigned char ** dbSeq,
+                                                const unsigned char ** pairedDbSeq,
                                                 unsigned int * max) {
     unsigned int maxScores[DIAGONALBINSIZE];
     simd_int zero = simdi32_set(0);
@@ -58,16 +86,16 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
     simd_int score = simdi32_set(0);
     for(unsigned int pos = 0; pos < seqLen[0]; pos++){
         const char * profileColumn = (profile + pos * T);
-        int subScore0 =  profileColumn[dbSeq[0][pos]];
-        int subScore1 =  profileColumn[dbSeq[1][pos]];
-        int subScore2 =  profileColumn[dbSeq[2][pos]];
-        int subScore3 =  profileColumn[dbSeq[3][pos]];
+        int subScore0 =  DIAGONAL_SUBSCORE(0);
+        int subScore1 =  DIAGONAL_SUBSCORE(1);
+        int subScore2 =  DIAGONAL_SUBSCORE(2);
+        int subScore3 =  DIAGONAL_SUBSCORE(3);
 
 #ifdef AVX2
-        int subScore4 =  profileColumn[dbSeq[4][pos]];
-        int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore4 =  DIAGONAL_SUBSCORE(4);
+        int subScore5 =  DIAGONAL_SUBSCORE(5);
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, subScore5, subScore4, subScore3, subScore2, subScore1, subScore0);
 #else
         simd_int subScores = _mm_set_epi32(subScore3, subScore2, subScore1, subScore0);
@@ -81,15 +109,15 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
     for(unsigned int pos = seqLen[0]; pos < seqLen[1]; pos++){
         const char * profileColumn = (profile + pos * T);
         //int subScore0 =  profileColumn[dbSeq[0][pos]];
-        int subScore1 =  profileColumn[dbSeq[1][pos]];
-        int subScore2 =  profileColumn[dbSeq[2][pos]];
-        int subScore3 =  profileColumn[dbSeq[3][pos]];
+        int subScore1 =  DIAGONAL_SUBSCORE(1);
+        int subScore2 =  DIAGONAL_SUBSCORE(2);
+        int subScore3 =  DIAGONAL_SUBSCORE(3);
 
 #ifdef AVX2
-        int subScore4 =  profileColumn[dbSeq[4][pos]];
-        int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore4 =  DIAGONAL_SUBSCORE(4);
+        int subScore5 =  DIAGONAL_SUBSCORE(5);
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, subScore5, subScore4, subScore3, subScore2, subScore1, 0);
 #else
         simd_int subScores = _mm_set_epi32(subScore3, subScore2, subScore1, 0);
@@ -104,14 +132,14 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         const char * profileColumn = (profile + pos * T);
         //int subScore0 =  profileColumn[dbSeq[0][pos]];
         //int subScore1 =  profileColumn[dbSeq[1][pos]];
-        int subScore2 =  profileColumn[dbSeq[2][pos]];
-        int subScore3 =  profileColumn[dbSeq[3][pos]];
+        int subScore2 =  DIAGONAL_SUBSCORE(2);
+        int subScore3 =  DIAGONAL_SUBSCORE(3);
 
 #ifdef AVX2
-        int subScore4 =  profileColumn[dbSeq[4][pos]];
-        int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore4 =  DIAGONAL_SUBSCORE(4);
+        int subScore5 =  DIAGONAL_SUBSCORE(5);
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, subScore5, subScore4, subScore3, subScore2, 0, 0);
 #else
         simd_int subScores = _mm_set_epi32(subScore3, subScore2, 0, 0);
@@ -127,13 +155,13 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         //int subScore0 =  profileColumn[dbSeq[0][pos]];
         //int subScore1 =  profileColumn[dbSeq[1][pos]];
         //int subScore2 =  profileColumn[dbSeq[2][pos]];
-        int subScore3 =  profileColumn[dbSeq[3][pos]];
+        int subScore3 =  DIAGONAL_SUBSCORE(3);
 
 #ifdef AVX2
-        int subScore4 =  profileColumn[dbSeq[4][pos]];
-        int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore4 =  DIAGONAL_SUBSCORE(4);
+        int subScore5 =  DIAGONAL_SUBSCORE(5);
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, subScore5, subScore4, subScore3, 0, 0, 0);
 #else
         simd_int subScores = _mm_set_epi32(subScore3, 0, 0, 0);
@@ -150,10 +178,10 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         //int subScore1 =  profileColumn[dbSeq[1][pos]];
         //int subScore2 =  profileColumn[dbSeq[2][pos]];
         //int subScore3 =  profileColumn[dbSeq[3][pos]];
-        int subScore4 =  profileColumn[dbSeq[4][pos]];
-        int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore4 =  DIAGONAL_SUBSCORE(4);
+        int subScore5 =  DIAGONAL_SUBSCORE(5);
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, subScore5, subScore4, 0, 0, 0, 0);
         score = simdi32_add(score, subScores);
         score = simdi32_max(score, zero);
@@ -167,9 +195,9 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         //int subScore2 =  profileColumn[dbSeq[2][pos]];
         //int subScore3 =  profileColumn[dbSeq[3][pos]];
         //int subScore4 =  profileColumn[dbSeq[4][pos]];
-        int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore5 =  DIAGONAL_SUBSCORE(5);
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, subScore5, 0, 0, 0, 0, 0);
         score = simdi32_add(score, subScores);
         score = simdi32_max(score, zero);
@@ -184,8 +212,8 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         //int subScore3 =  profileColumn[dbSeq[3][pos]];
         //int subScore4 =  profileColumn[dbSeq[4][pos]];
         //int subScore5 =  profileColumn[dbSeq[5][pos]];
-        int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore6 =  DIAGONAL_SUBSCORE(6);
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, subScore6, 0, 0, 0, 0, 0, 0);
         score = simdi32_add(score, subScores);
         score = simdi32_max(score, zero);
@@ -201,7 +229,7 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         //int subScore4 =  profileColumn[dbSeq[4][pos]];
         //int subScore5 =  profileColumn[dbSeq[5][pos]];
         //int subScore6 =  profileColumn[dbSeq[6][pos]];
-        int subScore7 =  profileColumn[dbSeq[7][pos]];
+        int subScore7 =  DIAGONAL_SUBSCORE(7);
         simd_int subScores = _mm256_set_epi32(subScore7, 0, 0, 0, 0, 0, 0, 0);
         score = simdi32_add(score, subScores);
         score = simdi32_max(score, zero);
@@ -216,6 +244,7 @@ void UngappedAlignment::unrolledDiagonalScoring(const char * profile,
         max[i] = std::max(maxScores[i], max[i]);
     }
 }
+#undef DIAGONAL_SUBSCORE
 
 void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
                                                    const unsigned int queryLen,
@@ -231,7 +260,7 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
         for (size_t hitIdx = 0; hitIdx < hitSize; hitIdx++) {
             const unsigned int seqId = hits[hitIdx]->id;
             std::pair<const unsigned char *, const unsigned int> dbSeq =  sequenceLookup->getSequence(seqId);
-            int max = computeLongScore(queryProfile, queryLen, dbSeq, diagonal);
+            int max = computeLongScore(queryProfile, queryLen, dbSeq, getPairedSequence(seqId), diagonal);
             hits[hitIdx]->count = static_cast<unsigned char>(std::min(255, max));
         }
         return;
@@ -240,6 +269,7 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
     if (hitSize == DIAGONALBINSIZE) {
         struct DiagonalSeq{
             unsigned char * seq;
+            const unsigned char * pairedSeq;
             unsigned int seqLen;
             unsigned int id;
             static bool compareDiagonalSeqByLen(const DiagonalSeq &first, const DiagonalSeq &second) {
@@ -250,6 +280,7 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
         for (unsigned int seqIdx = 0; seqIdx < hitSize; seqIdx++) {
             std::pair<const unsigned char *, const unsigned int> tmp = sequenceLookup->getSequence(
                     hits[seqIdx]->id);
+            seqs[seqIdx].pairedSeq = getPairedSequence(hits[seqIdx]->id);
             if(tmp.second >= 32768){
                 // hack to avoid too long sequences
                 // this sequences will be processed by computeLongScore later
@@ -266,25 +297,39 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
         unsigned int targetMaxLen = seqs[DIAGONALBINSIZE-1].seqLen;
         if (diagonal >= 0 && minDistToDiagonal < queryLen) {
             const unsigned char * tmpSeqs[DIAGONALBINSIZE];
+            const unsigned char * tmpPairedSeqs[DIAGONALBINSIZE];
             unsigned int seqLength[DIAGONALBINSIZE];
             unsigned int minSeqLen = std::min(targetMaxLen, queryLen - minDistToDiagonal);
             for(size_t i = 0; i < DIAGONALBINSIZE; i++) {
                 tmpSeqs[i] = seqs[i].seq;
+                tmpPairedSeqs[i] = seqs[i].pairedSeq;
                 seqLength[i] = std::min(seqs[i].seqLen, minSeqLen);
             }
-            unrolledDiagonalScoring<Sequence::PROFILE_AA_SIZE + 1>(queryProfile + (minDistToDiagonal * (Sequence::PROFILE_AA_SIZE + 1)),
-                                                                   seqLength, tmpSeqs, score_arr);
+            if (pairedScoring) {
+                unrolledDiagonalScoring<2 * (Sequence::PROFILE_AA_SIZE + 1), true>(queryProfile + (minDistToDiagonal * profileStride),
+                                                                                  seqLength, tmpSeqs, tmpPairedSeqs, score_arr);
+            } else {
+                unrolledDiagonalScoring<Sequence::PROFILE_AA_SIZE + 1, false>(queryProfile + (minDistToDiagonal * (Sequence::PROFILE_AA_SIZE + 1)),
+                                                                              seqLength, tmpSeqs, NULL, score_arr);
+            }
 
         } else if (diagonal < 0 && minDistToDiagonal < targetMaxLen) {
             const unsigned char * tmpSeqs[DIAGONALBINSIZE];
+            const unsigned char * tmpPairedSeqs[DIAGONALBINSIZE];
             unsigned int seqLength[DIAGONALBINSIZE];
             unsigned int minSeqLen = std::min(targetMaxLen - minDistToDiagonal, queryLen);
             for(size_t i = 0; i < DIAGONALBINSIZE; i++) {
                 tmpSeqs[i] = seqs[i].seq + minDistToDiagonal;
+                tmpPairedSeqs[i] = pairedScoring ? seqs[i].pairedSeq + minDistToDiagonal : NULL;
                 seqLength[i] = std::min(seqs[i].seqLen - minDistToDiagonal, minSeqLen);
             }
-            unrolledDiagonalScoring<Sequence::PROFILE_AA_SIZE + 1>(queryProfile, seqLength,
-                                                                   tmpSeqs, score_arr);
+            if (pairedScoring) {
+                unrolledDiagonalScoring<2 * (Sequence::PROFILE_AA_SIZE + 1), true>(queryProfile, seqLength,
+                                                                                  tmpSeqs, tmpPairedSeqs, score_arr);
+            } else {
+                unrolledDiagonalScoring<Sequence::PROFILE_AA_SIZE + 1, false>(queryProfile, seqLength,
+                                                                              tmpSeqs, NULL, score_arr);
+            }
         }
 
         // update score
@@ -294,7 +339,7 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
             if(seqs[hitIdx].seqLen == 1){
                 std::pair<const unsigned char *, const unsigned int> dbSeq =  sequenceLookup->getSequence(hits[hitIdx]->id);
                 if(dbSeq.second >= 32768){
-                    int max = computeLongScore(queryProfile, queryLen, dbSeq, diagonal);
+                    int max = computeLongScore(queryProfile, queryLen, dbSeq, getPairedSequence(hits[hitIdx]->id), diagonal);
                     hits[seqs[hitIdx].id]->count = static_cast<unsigned char>(std::min(255, max));
                 }
             }
@@ -303,11 +348,12 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
         for (size_t hitIdx = 0; hitIdx < hitSize; hitIdx++) {
             const unsigned int seqId = hits[hitIdx]->id;
             std::pair<const unsigned char *, const unsigned int> dbSeq =  sequenceLookup->getSequence(seqId);
+            const unsigned char * pairedDbSeq = getPairedSequence(seqId);
             int max;
             if(dbSeq.second >= 32768){
-                max = computeLongScore(queryProfile, queryLen, dbSeq, diagonal);
+                max = computeLongScore(queryProfile, queryLen, dbSeq, pairedDbSeq, diagonal);
             }else{
-                max = computeSingelSequenceScores(queryProfile, queryLen, dbSeq, diagonal, minDistToDiagonal);
+                max = computeSingelSequenceScores(queryProfile, queryLen, dbSeq, pairedDbSeq, diagonal, minDistToDiagonal);
             }
             hits[hitIdx]->count = static_cast<unsigned char>(std::min(255, max));
         }
@@ -316,18 +362,19 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
 
 int UngappedAlignment::computeLongScore(const char * queryProfile, unsigned int queryLen,
                                         std::pair<const unsigned char *, const unsigned int> &dbSeq,
+                                        const unsigned char * pairedDbSeq,
                                         unsigned short diagonal){
     int totalMax=0;
     for(unsigned int devisions = 1; devisions <= 1+ dbSeq.second /32768; devisions++ ){
         int realDiagonal = (-devisions * 65536  + diagonal);
         int minDistToDiagonal = abs(realDiagonal);
-        int max = computeSingelSequenceScores(queryProfile, queryLen, dbSeq, realDiagonal, minDistToDiagonal);
+        int max = computeSingelSequenceScores(queryProfile, queryLen, dbSeq, pairedDbSeq, realDiagonal, minDistToDiagonal);
         totalMax = std::max(totalMax, max);
     }
     for(unsigned int devisions = 0; devisions <= queryLen/65536; devisions++ ) {
         int realDiagonal = (devisions*65536+diagonal);
         int minDistToDiagonal = abs(realDiagonal);
-        int max = computeSingelSequenceScores(queryProfile, queryLen, dbSeq, realDiagonal, minDistToDiagonal);
+        int max = computeSingelSequenceScores(queryProfile, queryLen, dbSeq, pairedDbSeq, realDiagonal, minDistToDiagonal);
         totalMax = std::max(totalMax, max);
     }
     return totalMax;
@@ -388,9 +435,9 @@ void UngappedAlignment::createProfile(Sequence *seq,
                                       short **subMat) {
 
     if(Parameters::isEqualDbtype(seq->getSequenceType(), Parameters::DBTYPE_HMM_PROFILE)) {
-        memset(queryProfile, 0, (Sequence::PROFILE_AA_SIZE + 1) * seq->L);
+        memset(queryProfile, 0, profileStride * seq->L);
     }else{
-        memset(queryProfile, 0, (Sequence::PROFILE_AA_SIZE + 1) * seq->L);
+        memset(queryProfile, 0, profileStride * seq->L);
         for (int pos = 0; pos < seq->L; pos++) {
             float aaCorrBias = biasCorrection[pos];
             aaCorrBias = (aaCorrBias < 0.0) ? aaCorrBias/4 - 0.5 : aaCorrBias/4 + 0.5;
@@ -402,30 +449,43 @@ void UngappedAlignment::createProfile(Sequence *seq,
         const int8_t * profile_aln = seq->getAlignmentProfile();
         for (int pos = 0; pos < seq->L; pos++) {
             for (size_t aa_num = 0; aa_num < Sequence::PROFILE_AA_SIZE; aa_num++) {
-                queryProfile[pos * (Sequence::PROFILE_AA_SIZE + 1) + aa_num] = (profile_aln[aa_num * seq->L + pos]);
+                queryProfile[pos * profileStride + aa_num] = (profile_aln[aa_num * seq->L + pos]);
             }
         }
     }else{
         for (int pos = 0; pos < seq->L; pos++) {
             unsigned int aaIdx = seq->numSequence[pos];
             for (int i = 0; i < subMatrix->alphabetSize; i++) {
-                queryProfile[pos * (Sequence::PROFILE_AA_SIZE + 1) + i] = (subMat[aaIdx][i] + aaCorrectionScore[pos]);
+                queryProfile[pos * profileStride + i] = (subMat[aaIdx][i] + aaCorrectionScore[pos]);
             }
         }
     }
 }
 
+void UngappedAlignment::createPairedProfile(Sequence *pairedSeq) {
+    short **pairedSubMat = pairedSubMatrix->subMatrix;
+    for (int pos = 0; pos < pairedSeq->L; pos++) {
+        unsigned int aaIdx = pairedSeq->numSequence[pos];
+        char *profileColumn = queryProfile + pos * profileStride + (Sequence::PROFILE_AA_SIZE + 1);
+        for (int i = 0; i < pairedSubMatrix->alphabetSize; i++) {
+            profileColumn[i] = static_cast<char>(pairedSubMat[aaIdx][i]);
+        }
+    }
+}
+
 int UngappedAlignment::computeSingelSequenceScores(const char *queryProfile, const unsigned int queryLen,
                                                    std::pair<const unsigned char *, const unsigned int> &dbSeq,
+                                                   const unsigned char * pairedDbSeq,
                                                    int diagonal, unsigned int minDistToDiagonal) {
     int max = 0;
     if(diagonal >= 0 && minDistToDiagonal < queryLen){
         unsigned int minSeqLen = std::min(dbSeq.second, queryLen - minDistToDiagonal);
-        int scores = scalarDiagonalScoring(queryProfile + (minDistToDiagonal * (Sequence::PROFILE_AA_SIZE+1)), minSeqLen, dbSeq.first);
+        int scores = scalarDiagonalScoring(queryProfile + (minDistToDiagonal * profileStride), minSeqLen, dbSeq.first, pairedDbSeq);
         max = std::max(scores, max);
     }else if(diagonal < 0 && minDistToDiagonal < dbSeq.second){
         unsigned int minSeqLen = std::min(dbSeq.second - minDistToDiagonal, queryLen);
-        int scores = scalarDiagonalScoring(queryProfile, minSeqLen, dbSeq.first + minDistToDiagonal);
+        int scores = scalarDiagonalScoring(queryProfile, minSeqLen, dbSeq.first + minDistToDiagonal,
+                                           pairedDbSeq != NULL ? pairedDbSeq + minDistToDiagonal : NULL);
         max = std::max(scores, max);
     }
     return max;
@@ -435,16 +495,18 @@ int UngappedAlignment::computeSingelSequenceScores(const char *queryProfile, con
 int UngappedAlignment::scoreSingelSequenceByCounterResult(CounterResult &result) {
     std::pair<const unsigned char *, const unsigned int> dbSeq =  sequenceLookup->getSequence(result.id);
     unsigned short minDistToDiagonal = distanceFromDiagonal(result.diagonal);
-    return scoreSingleSequence(dbSeq, result.diagonal, minDistToDiagonal);
+    return scoreSingleSequence(dbSeq, result.diagonal, minDistToDiagonal, getPairedSequence(result.id));
 }
 
 int UngappedAlignment::scoreSingleSequence(std::pair<const unsigned char *, const unsigned int> dbSeq,
                                            unsigned short diagonal,
-                                           unsigned short minDistToDiagonal) {
+                                           unsigned short minDistToDiagonal,
+                                           const unsigned char * pairedDbSeq) {
+    pairedDbSeq = pairedScoring ? pairedDbSeq : NULL;
     if(queryLen >= 32768 || dbSeq.second >= 32768) {
-        return computeLongScore(queryProfile, queryLen, dbSeq, diagonal);
+        return computeLongScore(queryProfile, queryLen, dbSeq, pairedDbSeq, diagonal);
     } else {
-        return computeSingelSequenceScores(queryProfile,queryLen ,dbSeq, static_cast<short>(diagonal), minDistToDiagonal);
+        return computeSingelSequenceScores(queryProfile,queryLen ,dbSeq, pairedDbSeq, static_cast<short>(diagonal), minDistToDiagonal);
     }
 }
 
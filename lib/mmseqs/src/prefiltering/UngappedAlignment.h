@@ -20,14 +20,20 @@ public:
 
     // This function computes the diagonal score for each CounterResult object
     // it assigns the diagonal score to the CounterResult object
+    // if pairedSeq is given (and the SequenceLookup has paired data), the scores of the paired
+    // alphabet are added to the diagonal scores
     void processQuery(Sequence *seq, float *compositionBias, CounterResult *results,
-                      size_t resultSize);
+                      size_t resultSize, Sequence *pairedSeq = NULL);
+
+    // enables scoring of a second alphabet (e.g. amino acids next to 3Di)
+    void setPairedSubstitutionMatrix(BaseMatrix *pairedSubstitutionMatrix);
 
     int scoreSingelSequenceByCounterResult(CounterResult &result);
 
     int scoreSingleSequence(std::pair<const unsigned char *, const unsigned int> dbSeq,
                             unsigned short diagonal,
-                            unsigned short minDistToDiagonal);
+                            unsigned short minDistToDiagonal,
+                            const unsigned char * pairedDbSeq = NULL);
 
     inline short getQueryBias() {
         return 0;
@@ -54,6 +60,7 @@ private:
 #else
     const static unsigned int DIAGONALBINSIZE = 4;
 #endif
+    unsigned int maxSeqLen;
     unsigned int *score_arr;
     char *queryProfile;
     unsigned int queryLen;
@@ -62,6 +69,14 @@ private:
     char * aaCorrectionScore;
     BaseMatrix *subMatrix;
     SequenceLookup *sequenceLookup;
+    BaseMatrix *pairedSubMatrix;
+    // bytes per query position in queryProfile
+    unsigned int profileStride;
+    bool pairedScoring;
+
+    const unsigned char * getPairedSequence(size_t id) {
+        return pairedScoring ? sequenceLookup->getPairedSequence(id) : NULL;
+    }
 
     // this function bins the hit_t by diagonals by distributing each hit in an array of 256 * 16(sse)/32(avx2)
     // the function scoreDiagonalAndUpdateHits is called for each bin that reaches its maximum (16 or 32)
@@ -73,12 +88,14 @@ private:
     // scores a single diagonal
     int scalarDiagonalScoring(const char *profile,
                               const unsigned int seqLen,
-                              const unsigned char *dbSeq);
+                              const unsigned char *dbSeq,
+                              const unsigned char *pairedDbSeq);
 
-    template <unsigned int T>
+    template <unsigned int T, bool Paired>
     void unrolledDiagonalScoring(const char * profile,
                                  const unsigned int * seqLen,
                                  const unsigned char ** dbSeq,
+                                 const unsigned char ** pairedDbSeq,
                                  unsigned int * max);
 
     // calles vectorDiagonalScoring or scalarDiagonalScoring depending on the hitSize
@@ -92,12 +109,16 @@ private:
 
     void createProfile(Sequence *seq, float *biasCorrection, short **subMat);
 
+    void createPairedProfile(Sequence *pairedSeq);
+
     int computeSingelSequenceScores(const char *queryProfile, const unsigned int queryLen,
                                     std::pair<const unsigned char *, const unsigned int> &dbSeq,
+                                    const unsigned char * pairedDbSeq,
                                     int diagonal, unsigned int minDistToDiagonal);
 
     int computeLongScore(const char * queryProfile, unsigned int queryLen,
                          std::pair<const unsigned char *, const unsigned int> &dbSeq,
+                         const unsigned char * pairedDbSeq,
                          unsigned short diagonal);
 
 
@@ -1,6 +1,7 @@
 #include "NcbiTaxonomy.h"
 #include "Parameters.h"
 #include "DBWriter.h"
+#include "PackedSequence.h"
 #include "FileUtil.h"
 #include "Debug.h"
 #include "Util.h"
@@ -65,6 +66,8 @@ int filtertaxseqdb(int argc, const char **argv, const Command& command) {
                         // copy also the null byte since it contains the information if compressed or not
                         entryLength = *(reinterpret_cast<unsigned int *>(data)) + sizeof(unsigned int) + 1;
                         writer.writeData(data, entryLength, key, thread_idx, false, false);
+                    } else if (reader.isPacked()) {
+                        writer.writeData(data, PackedSequence::packedSize(reader.getSeqLen(i)), key, thread_idx, false, false);
                     } else {
                         writer.writeData(data, entryLength, key, thread_idx, true, false);
                     }
@@ -80,6 +83,9 @@ int filtertaxseqdb(int argc, const char **argv, const Command& command) {
         DBReader<unsigned int>::softlinkDb(par.db1, par.db2, DBFiles::SEQUENCE_NO_DATA_INDEX);
     } else {
         DBWriter::writeDbtypeFile(par.db2.c_str(), reader.getDbtype(), isCompressed);
+        if (isCompressed) {
+            DBReader<unsigned int>::softlinkDb(par.db1, par.db2, DBFiles::DATA_DICTIONARY);
+        }
         DBReader<unsigned int>::softlinkDb(par.db1, par.db2, DBFiles::SEQUENCE_ANCILLARY);
     }
 
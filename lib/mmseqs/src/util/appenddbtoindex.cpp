@@ -3,6 +3,7 @@
 #include "DBWriter.h"
 #include "Debug.h"
 #include "Util.h"
+#include "PrefilteringIndexReader.h"
 
 int appenddbtoindex(int argc, const char **argv, const Command &command) {
     Parameters &par = Parameters::getInstance();
@@ -43,6 +44,7 @@ int appenddbtoindex(int argc, const char **argv, const Command &command) {
 
     // if we have a split database, make one new split where we append the new files
     FILE* outDataHandle = NULL;
+    bool newSplitFile = false;
     {
         std::string checkName = outDb + ".0";
         size_t cnt = 0;
@@ -54,6 +56,7 @@ int appenddbtoindex(int argc, const char **argv, const Command &command) {
             outDataHandle = FileUtil::openFileOrDie(outDb.c_str(), "ab", true);
         } else {
             outDataHandle = FileUtil::openFileOrDie(checkName.c_str(), "wb", false);
+            newSplitFile = true;
         }
     }
 
@@ -77,6 +80,11 @@ int appenddbtoindex(int argc, const char **argv, const Command &command) {
         outReader.close();
     }
 
+    // position in the data file we are writing to, used to align the appended data
+    size_t filePos = newSplitFile ? 0 : offset;
+    const size_t dataAlign = 64;
+    const char padding[64] = {0};
+
     const char nullbyte = '\0';
     char buffer[8192];
     FILE* outIndexHandle = FileUtil::openFileOrDie(outIndexName.c_str(), "a", true);
@@ -109,6 +117,19 @@ int appenddbtoindex(int argc, const char **argv, const Command &command) {
             EXIT(EXIT_FAILURE);
         }
         offset += inSize;
+        filePos += inSize;
+
+        // start the data on a cache line so fixed size binary entries (e.g. padded coordinates) stay aligned
+        size_t padSize = (dataAlign - (filePos % dataAlign)) % dataAlign;
+        if (padSize > 0) {
+            written = fwrite(padding, sizeof(char), padSize, outDataHandle);
+            if (written != padSize) {
+                Debug(Debug::ERROR) << "Cannot write to data file " << outDb << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            offset += padSize;
+            filePos += padSize;
+        }
 
         inSize = reader.getTotalDataSize();
         for (size_t idx = 0; idx < reader.getDataFileCnt(); idx++) {
@@ -120,6 +141,7 @@ int appenddbtoindex(int argc, const char **argv, const Command &command) {
                 EXIT(EXIT_FAILURE);
             }
         }
+        const std::string dictionary = reader.getDictionary();
         reader.close();
 
         written = fwrite(&nullbyte, sizeof(char), 1, outDataHandle);
@@ -135,6 +157,25 @@ int appenddbtoindex(int argc, const char **argv, const Command &command) {
             EXIT(EXIT_FAILURE);
         }
         offset += inSize;
+        filePos += inSize;
+
+        // compressed entries can only be read with the dictionary they were compressed with
+        if (dictionary.empty() == false) {
+            written = fwrite(dictionary.c_str(), sizeof(char), dictionary.size(), outDataHandle);
+            if (written != dictionary.size() || fwrite(&nullbyte, sizeof(char), 1, outDataHandle) != 1) {
+                Debug(Debug::ERROR) << "Cannot write to data file " << outDb << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            inSize = dictionary.size() + 1;
+            len = DBWriter::indexToBuffer(buffer, PrefilteringIndexReader::dictionaryKey(key + 1), offset, inSize);
+            written = fwrite(buffer, sizeof(char), len, outIndexHandle);
+            if (written != len) {
+                Debug(Debug::ERROR) << "Cannot write to index file " << outIndexName << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            offset += inSize;
+            filePos += inSize;
+        }
     }
 
     if (fclose(outDataHandle) != 0) {
@@ -26,6 +26,9 @@ int doCompression(int argc, const char **argv, const Command& command, bool shou
     dbtype = shouldCompress ? dbtype | (1 << 31) : dbtype & ~(1 << 31);
     DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, shouldCompress, dbtype);
     writer.open();
+    if (shouldCompress && par.compressDictionary) {
+        writer.setDictionary(DBWriter::trainDictionary(reader));
+    }
     Debug::Progress progress(reader.getSize());
 
 #pragma omp parallel
@@ -254,6 +254,7 @@ int convertalignments(int argc, const char **argv, const Command &command) {
 
     DBReader<unsigned int> alnDbr(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     alnDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(alnDbr.getDbtype(), par.db3);
 
     size_t localThreads = 1;
 #ifdef OPENMP
@@ -363,7 +364,7 @@ int convertalignments(int argc, const char **argv, const Command &command) {
                 size_t qId = qDbr.sequenceReader->getId(queryKey);
                 querySeqData = qDbr.sequenceReader->getData(qId, thread_idx);
                 querySeqLen = qDbr.sequenceReader->getSeqLen(qId);
-                if(sameDB && qDbr.sequenceReader->isCompressed()){
+                if(sameDB && (qDbr.sequenceReader->isCompressed() || qDbr.sequenceReader->isPacked())){
                     queryBuffer.assign(querySeqData, querySeqLen);
                     querySeqData = (char*) queryBuffer.c_str();
                 }
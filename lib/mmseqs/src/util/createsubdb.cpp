@@ -2,6 +2,7 @@
 #include "FileUtil.h"
 #include "DBReader.h"
 #include "DBWriter.h"
+#include "PackedSequence.h"
 #include "Debug.h"
 #include "Util.h"
 
@@ -72,6 +73,8 @@ int createsubdb(int argc, const char **argv, const Command& command) {
                 // copy also the null byte since it contains the information if compressed or not
                 entryLength = *(reinterpret_cast<unsigned int *>(data)) + sizeof(unsigned int) + 1;
                 writer.writeData(data, entryLength, key, 0, false, false);
+            } else if (reader.isPacked()) {
+                writer.writeData(data, PackedSequence::packedSize(reader.getSeqLen(id)), key, 0, false, false);
             } else {
                 writer.writeData(data, entryLength, key, 0, true, false);
             }
@@ -85,9 +88,18 @@ int createsubdb(int argc, const char **argv, const Command& command) {
                              || Parameters::isEqualDbtype(reader.getDbtype(), Parameters::DBTYPE_NUCLEOTIDES);
     writer.close(shouldMerge, !isOrdered);
     if (par.subDbMode == Parameters::SUBDB_MODE_SOFT) {
-        DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::DATA);
+        // the offsets of an interleaved database point into the data of the database storing its entries
+        std::string dataDb = par.db2;
+        if (DBReader<unsigned int>::getExtendedDbtype(FileUtil::parseDbType(par.db2.c_str())) & Parameters::DBTYPE_EXTENDED_INTERLEAVED) {
+            DBReader<unsigned int>::findInterleavedDb(par.db2, dataDb);
+        }
+        DBReader<unsigned int>::softlinkDb(dataDb, par.db3, DBFiles::DATA);
     }
     DBWriter::writeDbtypeFile(par.db3.c_str(), reader.getDbtype(), isCompressed);
+    if (isCompressed) {
+        // the compressed entries are copied as they are and need the dictionary of the input
+        DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::DATA_DICTIONARY);
+    }
     DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::SEQUENCE_ANCILLARY);
 
     free(line);
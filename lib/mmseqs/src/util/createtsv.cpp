@@ -1,5 +1,6 @@
 #include "Parameters.h"
 #include "DBReader.h"
+#include "Matcher.h"
 #include "DBWriter.h"
 #include "Debug.h"
 #include "Util.h"
@@ -58,6 +59,7 @@ int createtsv(int argc, const char **argv, const Command &command) {
         reader = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     }
     reader->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(reader->getDbtype(), reader->getDataFileName());
 
     const std::string& dataFile = hasTargetDB ? par.db4 : par.db3;
     const std::string& indexFile = hasTargetDB ? par.db4Index : par.db3Index;
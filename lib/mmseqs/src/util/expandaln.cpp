@@ -1,5 +1,6 @@
 #include "Parameters.h"
 #include "DBReader.h"
+#include "Matcher.h"
 #include "DBWriter.h"
 #include "Debug.h"
 #include "FileUtil.h"
@@ -106,6 +107,7 @@ int expandaln(int argc, const char **argv, const Command& command, bool returnAl
 
     DBReader<unsigned int> *resultAbReader = new DBReader<unsigned int>(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     resultAbReader->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(resultAbReader->getDbtype(), par.db3);
 
     DBReader<unsigned int> *cReader = NULL;
     IndexReader *cReaderIdx = NULL;
@@ -1,5 +1,6 @@
 #include "Parameters.h"
 #include "DBReader.h"
+#include "Matcher.h"
 #include "DBWriter.h"
 #include "Util.h"
 #include "Debug.h"
@@ -96,6 +97,7 @@ int filterdb(int argc, const char **argv, const Command &command) {
 
     DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(reader.getDbtype(), par.db1);
 
     DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, reader.getDbtype());
     writer.open();
@@ -1,5 +1,6 @@
 #include "Debug.h"
 #include "DBReader.h"
+#include "Matcher.h"
 #include "DBWriter.h"
 #include "Util.h"
 
@@ -16,6 +17,7 @@ int mergeresultsbyset(int argc, const char **argv, const Command &command) {
 
     DBReader<unsigned int> resultReader(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     resultReader.open(DBReader<unsigned int>::NOSORT);
+    Matcher::checkTextResultDbtype(resultReader.getDbtype(), par.db2);
 
     DBWriter dbw(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, resultReader.getDbtype());
     dbw.open();
@@ -60,6 +60,7 @@ int proteinaln2nucl(int argc, const char **argv, const Command &command) {
 
     DBReader<unsigned int> alnDbr(par.db5.c_str(), par.db5Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     alnDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(alnDbr.getDbtype(), par.db5);
 
     DBWriter resultWriter(par.db6.c_str(), par.db6Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
     resultWriter.open();
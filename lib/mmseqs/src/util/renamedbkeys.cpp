@@ -2,6 +2,7 @@
 #include "FileUtil.h"
 #include "DBReader.h"
 #include "DBWriter.h"
+#include "PackedSequence.h"
 #include "Debug.h"
 #include "Util.h"
 #include "FastSort.h"
@@ -29,6 +30,8 @@ void copyEntry(unsigned int oldKey, unsigned int newKey, DBReader<unsigned int>&
             // copy also the null byte since it contains the information if compressed or not
             entryLength = *(reinterpret_cast<unsigned int *>(data)) + sizeof(unsigned int) + 1;
             writer.writeData(data, entryLength, newKey, 0, false, false);
+        } else if (reader.isPacked()) {
+            writer.writeData(data, PackedSequence::packedSize(reader.getSeqLen(id)), newKey, 0, false, false);
         } else {
             writer.writeData(data, entryLength, newKey, 0, true, false);
         }
@@ -138,6 +141,9 @@ int renamedbkeys(int argc, const char **argv, const Command &command) {
     if (par.subDbMode == Parameters::SUBDB_MODE_SOFT) {
         DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::DATA);
     }
+    if (isCompressed) {
+        DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::DATA_DICTIONARY);
+    }
     if (newMappingFile != NULL) {
         SORT_PARALLEL(newMapping.begin(), newMapping.end(), compareToFirst);
         std::string buffer;
@@ -171,6 +177,9 @@ int renamedbkeys(int argc, const char **argv, const Command &command) {
         if (par.subDbMode == Parameters::SUBDB_MODE_SOFT) {
             DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::HEADER);
         }
+        if (isHeaderCompressed) {
+            DBReader<unsigned int>::softlinkDb(par.db2, par.db3, DBFiles::HEADER_DICTIONARY);
+        }
     }
     if (par.subDbMode == Parameters::SUBDB_MODE_SOFT) {
         DBReader<unsigned int>::softlinkDb(par.db2, par.db3, (DBFiles::Files) (DBFiles::SOURCE | DBFiles::TAX_MERGED | DBFiles::TAX_NAMES | DBFiles::TAX_NODES | DBFiles::TAX_BINARY));
@@ -2,6 +2,7 @@
 #include <Parameters.h>
 
 #include "DBReader.h"
+#include "Matcher.h"
 #include "Debug.h"
 #include "Util.h"
 
@@ -20,6 +21,7 @@ int result2flat(int argc, const char **argv, const Command &command) {
 
     DBReader<unsigned int> dbr_data(par.db3.c_str(), par.db3Index.c_str(),  1, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     dbr_data.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(dbr_data.getDbtype(), par.db3);
 
     FILE *fastaFP = fopen(par.db4.c_str(), "w");
 
@@ -3,6 +3,7 @@
 #include "PSSMCalculator.h"
 #include "PSSMMasker.h"
 #include "DBReader.h"
+#include "Matcher.h"
 #include "DBWriter.h"
 #include "Debug.h"
 #include "Util.h"
@@ -43,6 +44,7 @@ int result2profile(int argc, const char **argv, const Command &command, bool ret
 
     DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(resultReader.getDbtype(), par.db3);
     size_t dbFrom = 0;
     size_t dbSize = 0;
 #ifdef HAVE_MPI
@@ -1,5 +1,6 @@
 #include "Debug.h"
 #include "DBReader.h"
+#include "Matcher.h"
 #include "DBWriter.h"
 #include "Util.h"
 
@@ -13,6 +14,7 @@ int result2rbh(int argc, const char **argv, const Command &command) {
 
     DBReader<unsigned int> resultReader(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    Matcher::checkTextResultDbtype(resultReader.getDbtype(), par.db1);
 
     DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, resultReader.getDbtype());
     dbw.open();
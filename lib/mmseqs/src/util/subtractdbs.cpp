@@ -24,6 +24,8 @@ int subtractdbs(int argc, const char **argv, const Command& command) {
 
     DBReader<unsigned int> rightDbr(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     rightDbr.open(DBReader<unsigned int>::NOSORT);
+    Matcher::checkTextResultDbtype(leftDbr.getDbtype(), par.db1);
+    Matcher::checkTextResultDbtype(rightDbr.getDbtype(), par.db2);
 
     DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, leftDbr.getDbtype());
     writer.open();
@@ -101,6 +101,7 @@ int doswap(Parameters& par, bool isGeneralMode) {
 
     DBReader<unsigned int> resultDbr(parResultDb, parResultDbIndex, par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     resultDbr.open(DBReader<unsigned int>::SORT_BY_OFFSET);
+    Matcher::checkTextResultDbtype(resultDbr.getDbtype(), parResultDb);
 
     const size_t resultSize = resultDbr.getSize();
     Debug(Debug::INFO) << "Computing offsets.\n";
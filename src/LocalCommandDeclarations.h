@@ -19,5 +19,12 @@ extern int structureeasyrbh(int argc, const char** argv, const Command &command)
 extern int structureungappedalign(int argc, const char** argv, const Command &command);
 extern int convert2pdb(int argc, const char** argv, const Command &command);
 extern int compressca(int argc, const char** argv, const Command &command);
+extern int structurekmermatcher(int argc, const char** argv, const Command &command);
+extern int structureungappedprefilter(int argc, const char** argv, const Command &command);
+extern int structureprefilter(int argc, const char** argv, const Command &command);
+extern int makepaddedcadb(int argc, const char** argv, const Command &command);
+extern int interleavedb(int argc, const char** argv, const Command &command);
+extern int packdb(int argc, const char** argv, const Command &command);
+extern int timingsummary(int argc, const char** argv, const Command &command);
 
 #endif
@@ -0,0 +1,105 @@
+#ifndef FOLDSEEK_ALIGNMENTMAP_H
+#define FOLDSEEK_ALIGNMENTMAP_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Run-length representation of a pairwise alignment (runs of M, I and D states).
+// It is built once per hit, either from the cigar of StructureSmithWaterman or from a
+// compressed/uncompressed backtrace string, and is consumed by TMaligner, LDDTCalculator
+// and the alignment output without expanding or copying the backtrace.
+class AlignmentMap {
+public:
+    struct Run {
+        Run(char op, uint32_t length) : op(op), length(length) {}
+        char op;
+        uint32_t length;
+    };
+
+    AlignmentMap() : qStartPos(0), tStartPos(0), columns(0), matches(0) {}
+
+    void clear(int qStart, int tStart) {
+        runs.clear();
+        qStartPos = qStart;
+        tStartPos = tStart;
+        columns = 0;
+        matches = 0;
+    }
+
+    void append(char op, uint32_t length) {
+        if (length == 0) {
+            return;
+        }
+        columns += length;
+        if (op == 'M') {
+            matches += length;
+        }
+        if (runs.empty() == false && runs.back().op == op) {
+            runs.back().length += length;
+        } else {
+            runs.emplace_back(op, length);
+        }
+    }
+
+    // accepts compressed (e.g. 10M2I5M) and uncompressed (MMMII) backtraces
+    void parse(const std::string &backtrace, int qStart, int tStart) {
+        clear(qStart, tStart);
+        uint32_t count = 0;
+        bool hasCount = false;
+        for (size_t i = 0; i < backtrace.size(); ++i) {
+            const char c = backtrace[i];
+            if (c >= '0' && c <= '9') {
+                count = count * 10 + (c - '0');
+                hasCount = true;
+            } else {
+                append(c, hasCount ? count : 1);
+                count = 0;
+                hasCount = false;
+            }
+        }
+    }
+
+    // invmap[queryPos] = targetPos for matched positions, -1 otherwise
+    void fillInvmap(int *invmap, unsigned int queryLen) const {
+        std::fill(invmap, invmap + queryLen, -1);
+        int qPos = qStartPos;
+        int tPos = tStartPos;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            const uint32_t length = runs[i].length;
+            switch (runs[i].op) {
+                case 'M':
+                    for (uint32_t j = 0; j < length; ++j) {
+                        invmap[qPos + j] = tPos + j;
+                    }
+                    qPos += length;
+                    tPos += length;
+                    break;
+                case 'I':
+                    qPos += length;
+                    break;
+                default:
+                    tPos += length;
+                    break;
+            }
+        }
+    }
+
+    size_t gapOpenCount() const {
+        size_t count = 0;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            count += (runs[i].op == 'I' || runs[i].op == 'D');
+        }
+        return count;
+    }
+
+    std::vector<Run> runs;
+    int qStartPos;
+    int tStartPos;
+    // alignment length including gaps
+    size_t columns;
+    size_t matches;
+};
+
+#endif
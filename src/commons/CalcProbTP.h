@@ -16,13 +16,31 @@ public:
     if (score >= 100){
       return 1.0;
     }
+    // bit scores are integers, their probabilities are computed once
+    if (score == static_cast<float>(static_cast<int>(score))){
+      static const Table table;
+      return table.prob[static_cast<int>(score)];
+    }
+    return evaluate(score);
+  }
+
+private:
+  struct Table {
+    float prob[100];
+    Table() {
+      for (int score = 0; score < 100; score++) {
+        prob[score] = evaluate(score);
+      }
+    }
+  };
+
+  static float evaluate(const float score){
     // Fitted score distributions for TPs and FPs
     float p_tp = (0.8279 * gamma_pdf(1.8123, 1/46.0042, score) + 0.1721 * gamma_pdf(1.0057, 1/563.5014, score)) * 0.1023;
     float p_fp = (0.34 * gamma_pdf(4.9259, 1/4.745, score) + 0.66 * gamma_pdf(9.4834, 1/1.3136, score)) * 0.8977;
     return 1 / (1 + (p_fp / p_tp));  // = p_tp / (p_tp + p_fp)
   }
 
-private:
   static float gamma_pdf(const float alpha, const float beta, const float x){
     // Density of Gamma distribution
     // Parameters: alpha = shape, beta = 1 / scale
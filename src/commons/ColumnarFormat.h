@@ -0,0 +1,197 @@
+#ifndef FOLDSEEK_COLUMNARFORMAT_H
+#define FOLDSEEK_COLUMNARFORMAT_H
+
+#include "LocalParameters.h"
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Columnar binary output of convertalis (--format-mode 6). All values are little-endian, every
+// section starts 8 byte aligned.
+//
+// file:      header, row group*
+// header:    "FSCOLS\0\1", uint32 column count, uint32 header length (including padding),
+//            per column: uint32 type, uint32 name length, name; zero padding to 8 bytes
+// row group: uint32 "FSRG", uint32 row count,
+//            per column: uint64 length (including padding), values; zero padding to 8 bytes
+//
+// INT32, FLOAT32 and FLOAT64 columns hold one value per row. STRING and FLOAT32_LIST columns hold
+// row count + 1 uint32 offsets (bytes for strings, elements for lists) followed by the data.
+// qca and tca lists are x, y and z per residue, u is the row-major 3x3 rotation matrix.
+class ColumnarFormat {
+public:
+    enum Type {
+        INT32 = 1,
+        FLOAT32 = 2,
+        FLOAT64 = 3,
+        STRING = 4,
+        FLOAT32_LIST = 5
+    };
+
+    static const uint32_t ROWGROUP_MAGIC = 0x47525346; // "FSRG"
+    static const size_t MAX_ROWS = 65536;
+    static const size_t MAX_BYTES = 64 * 1024 * 1024;
+
+    static Type columnType(int outcode) {
+        switch (outcode) {
+            case Parameters::OUTFMT_GAPOPEN:
+            case Parameters::OUTFMT_NIDENT:
+            case Parameters::OUTFMT_QSTART:
+            case Parameters::OUTFMT_QEND:
+            case Parameters::OUTFMT_QLEN:
+            case Parameters::OUTFMT_TSTART:
+            case Parameters::OUTFMT_TEND:
+            case Parameters::OUTFMT_TLEN:
+            case Parameters::OUTFMT_ALNLEN:
+            case Parameters::OUTFMT_RAW:
+            case Parameters::OUTFMT_BITS:
+            case Parameters::OUTFMT_MISMATCH:
+            case Parameters::OUTFMT_QSETID:
+            case Parameters::OUTFMT_TSETID:
+            case Parameters::OUTFMT_TAXID:
+            case Parameters::OUTFMT_QORFSTART:
+            case Parameters::OUTFMT_QORFEND:
+            case Parameters::OUTFMT_TORFSTART:
+            case Parameters::OUTFMT_TORFEND:
+                return INT32;
+            case Parameters::OUTFMT_FIDENT:
+            case Parameters::OUTFMT_PIDENT:
+            case Parameters::OUTFMT_QCOV:
+            case Parameters::OUTFMT_TCOV:
+            case LocalParameters::OUTFMT_PROBTP:
+                return FLOAT32;
+            case Parameters::OUTFMT_EVALUE:
+            case LocalParameters::OUTFMT_ALNTMSCORE:
+            case LocalParameters::OUTFMT_RMSD:
+            case LocalParameters::OUTFMT_LDDT:
+                return FLOAT64;
+            case LocalParameters::OUTFMT_QCA:
+            case LocalParameters::OUTFMT_TCA:
+            case LocalParameters::OUTFMT_U:
+            case LocalParameters::OUTFMT_T:
+            case LocalParameters::OUTFMT_LDDT_FULL:
+                return FLOAT32_LIST;
+            default:
+                return STRING;
+        }
+    }
+
+    static std::string header(const std::vector<int> &outcodes, const std::vector<std::string> &names) {
+        std::string out("FSCOLS\0\1", 8);
+        appendValue(out, static_cast<uint32_t>(outcodes.size()));
+        appendValue(out, static_cast<uint32_t>(0));
+        for (size_t i = 0; i < outcodes.size(); i++) {
+            appendValue(out, static_cast<uint32_t>(columnType(outcodes[i])));
+            appendValue(out, static_cast<uint32_t>(names[i].size()));
+            out.append(names[i]);
+        }
+        pad(out);
+        const uint32_t length = static_cast<uint32_t>(out.size());
+        memcpy(&out[12], &length, sizeof(uint32_t));
+        return out;
+    }
+
+    // rows of one thread until the row group is written
+    class RowGroup {
+    public:
+        RowGroup(const std::vector<int> &outcodes) : rows(0) {
+            for (size_t i = 0; i < outcodes.size(); i++) {
+                columns.push_back(Column(columnType(outcodes[i])));
+            }
+        }
+
+        void addInt(size_t col, int32_t value) {
+            appendValue(columns[col].data, value);
+        }
+
+        void addFloat(size_t col, float value) {
+            appendValue(columns[col].data, value);
+        }
+
+        void addDouble(size_t col, double value) {
+            appendValue(columns[col].data, value);
+        }
+
+        void addFloats(size_t col, const float *values, size_t count) {
+            columns[col].data.append(reinterpret_cast<const char *>(values), count * sizeof(float));
+            endValue(col);
+        }
+
+        // STRING values are appended to the returned buffer, followed by endValue
+        std::string &stringBuffer(size_t col) {
+            return columns[col].data;
+        }
+
+        void endValue(size_t col) {
+            Column &column = columns[col];
+            const size_t size = column.data.size();
+            column.offsets.push_back(static_cast<uint32_t>(column.type == FLOAT32_LIST ? size / sizeof(float) : size));
+        }
+
+        void endRow() {
+            rows++;
+        }
+
+        bool empty() const {
+            return rows == 0;
+        }
+
+        bool full() {
+            size_t size = 0;
+            for (size_t i = 0; i < columns.size(); i++) {
+                size += columns[i].data.size();
+            }
+            return rows >= MAX_ROWS || size >= MAX_BYTES;
+        }
+
+        void serialize(std::string &out) {
+            appendValue(out, ROWGROUP_MAGIC);
+            appendValue(out, static_cast<uint32_t>(rows));
+            for (size_t i = 0; i < columns.size(); i++) {
+                Column &column = columns[i];
+                const size_t lengthPos = out.size();
+                appendValue(out, static_cast<uint64_t>(0));
+                if (column.type == STRING || column.type == FLOAT32_LIST) {
+                    out.append(reinterpret_cast<const char *>(column.offsets.data()), column.offsets.size() * sizeof(uint32_t));
+                }
+                out.append(column.data);
+                pad(out);
+                const uint64_t length = out.size() - lengthPos - sizeof(uint64_t);
+                memcpy(&out[lengthPos], &length, sizeof(uint64_t));
+            }
+            clear();
+        }
+
+        void clear() {
+            rows = 0;
+            for (size_t i = 0; i < columns.size(); i++) {
+                columns[i].data.clear();
+                columns[i].offsets.resize(1);
+            }
+        }
+
+    private:
+        struct Column {
+            Column(Type type) : type(type), offsets(1, 0) {}
+            Type type;
+            std::string data;
+            std::vector<uint32_t> offsets;
+        };
+        std::vector<Column> columns;
+        size_t rows;
+    };
+
+private:
+    template<typename T>
+    static void appendValue(std::string &out, T value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static void pad(std::string &out) {
+        out.append((8 - out.size() % 8) % 8, '\0');
+    }
+};
+
+#endif
@@ -2,50 +2,86 @@
 #define COORDINATE16_H
 
 #include "LocalParameters.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 class Coordinate16 {
 public:
+    // Entries of padded C-alpha databases (makepaddedcadb) store x, y and z as floats, each padded
+    // to a multiple of PADDED_ALIGN bytes. Followed by padding and the '\0' written by DBWriter
+    // the entry length is a multiple of PADDED_ALIGN, so entries stay aligned in the data file.
+    static const size_t PADDED_ALIGN = MAX_ALIGN_FLOAT;
+
+    Coordinate16() : aligned(NULL), alignedSize(0) {}
+    ~Coordinate16() {
+        free(aligned);
+    }
+
+    static size_t paddedStride(size_t chainLength) {
+        const size_t floatsPerBlock = PADDED_ALIGN / sizeof(float);
+        return ((chainLength + floatsPerBlock - 1) / floatsPerBlock) * floatsPerBlock;
+    }
+
+    // entry length including the trailing '\0'
+    static size_t paddedEntryLength(size_t chainLength) {
+        return 3 * paddedStride(chainLength) * sizeof(float) + PADDED_ALIGN;
+    }
+
+    static bool isPadded(size_t chainLength, size_t entryLength) {
+        return entryLength == paddedEntryLength(chainLength);
+    }
+
+    // Returns x, y and z coordinates as one contiguous array of 3 * chainLength floats.
     float* read(const char* mem, size_t chainLength, size_t entryLength) {
+        if (isPadded(chainLength, entryLength)) {
+            const size_t stride = paddedStride(chainLength);
+            buffer.resize(chainLength * 3);
+            memcpy(buffer.data(), mem, chainLength * sizeof(float));
+            memcpy(buffer.data() + chainLength, mem + stride * sizeof(float), chainLength * sizeof(float));
+            memcpy(buffer.data() + 2 * chainLength, mem + 2 * stride * sizeof(float), chainLength * sizeof(float));
+            return buffer.data();
+        }
         if (entryLength >= (chainLength * 3) * sizeof(float)) {
             return (float*) mem;
         }
-        buffer.reserve(chainLength * 3);
-        const char* data = mem;
-        int32_t diffSum = 0;
-        int32_t start;
-        memcpy(&start, data, sizeof(int32_t));
-        data += sizeof(int32_t);
-        buffer[0] = start / 1000.0f;
-        int16_t intDiff = 0;
-        for (size_t i = 1; i < chainLength; ++i) {
-            memcpy(&intDiff, data, sizeof(int16_t));
-            data += sizeof(int16_t);
-            diffSum += intDiff;
-            buffer[i] = (start + diffSum) / 1000.0f;
+        buffer.resize(chainLength * 3);
+        decode(mem, chainLength, entryLength, buffer.data(), buffer.data() + chainLength, buffer.data() + 2 * chainLength);
+        return buffer.data();
+    }
+
+    // Returns x; y and z start at x + stride and x + 2 * stride. Every component is PADDED_ALIGN
+    // aligned and readable up to stride floats, as the SIMD code in TMaligner requires.
+    // Entries of padded databases are returned without any copy.
+    float* readAligned(const char* mem, size_t chainLength, size_t entryLength, size_t &stride) {
+        stride = paddedStride(chainLength);
+        if (isPadded(chainLength, entryLength)) {
+            if (reinterpret_cast<uintptr_t>(mem) % PADDED_ALIGN == 0) {
+                return (float*) mem;
+            }
+            reserveAligned(stride);
+            memcpy(aligned, mem, 3 * stride * sizeof(float));
+            return aligned;
         }
-        diffSum = 0;
-        memcpy(&start, data, sizeof(int32_t));
-        data += sizeof(int32_t);
-        buffer[chainLength] = start / 1000.0f;
-        for (size_t i = chainLength + 1; i < 2 * chainLength; ++i) {
-            memcpy(&intDiff, data, sizeof(int16_t));
-            data += sizeof(int16_t);
-            diffSum += intDiff;
-            buffer[i] = (start + diffSum) / 1000.0f;
+        reserveAligned(stride);
+        float* x = aligned;
+        float* y = aligned + stride;
+        float* z = aligned + 2 * stride;
+        if (entryLength >= (chainLength * 3) * sizeof(float)) {
+            const float* data = (const float*) mem;
+            memcpy(x, data, chainLength * sizeof(float));
+            memcpy(y, data + chainLength, chainLength * sizeof(float));
+            memcpy(z, data + 2 * chainLength, chainLength * sizeof(float));
+        } else {
+            decode(mem, chainLength, entryLength, x, y, z);
         }
-        diffSum = 0;
-        memcpy(&start, data, sizeof(int32_t));
-        data += sizeof(int32_t);
-        buffer[2 * chainLength] = start / 1000.0f;
-        for (size_t i = 2 * chainLength + 1; i < 3 * chainLength; ++i) {
-            memcpy(&intDiff, data, sizeof(int16_t));
-            data += sizeof(int16_t);
-            diffSum += intDiff;
-            buffer[i] = (start + diffSum) / 1000.0f;
+        for (size_t i = chainLength; i < stride; ++i) {
+            x[i] = 0.0f;
+            y[i] = 0.0f;
+            z[i] = 0.0f;
         }
-        return buffer.data();
-
+        return aligned;
     }
 
     template <typename T>
@@ -65,8 +101,163 @@ public:
         return false;
     }
 
+    // Entries of bit-packed C-alpha databases (--coord-store-mode 3) hold the coordinates rounded to
+    // 10^-PACKED_EXPONENT Angstrom: the exponent as one byte, the first x, y and z as int32, then blocks of
+    // up to PACKED_BLOCK residues. A block is one byte with the bit width w, followed by the zigzag encoded
+    // differences of x, y and z to the previous residue with w bits each, least significant bit first.
+    // The rounding error is at most half a quantum per axis and does not accumulate along the chain.
+    // Packed entries are only written if they are shorter than 16-bit diff entries, which tells them apart.
+    static const uint8_t PACKED_EXPONENT = 2;
+    static const size_t PACKED_BLOCK = 16;
+
+    static bool isPackedDiff(size_t chainLength, size_t entryLength) {
+        return entryLength < 6 * chainLength + 6;
+    }
+
+    // Writes the packed entry (without '\0') to out, returns false if it would not be shorter than the
+    // 16-bit diff encoding or a coordinate is out of range. NaN coordinates are stored as 0.
+    template <typename T>
+    static bool convertToPackedDiff(size_t len, const T* x, const T* y, const T* z, size_t stride, std::vector<int8_t>& out) {
+        out.clear();
+        if (len < 2) {
+            return false;
+        }
+        const T* axes[3] = { x, y, z };
+        int32_t last[3];
+        out.push_back(static_cast<int8_t>(PACKED_EXPONENT));
+        for (size_t a = 0; a < 3; ++a) {
+            if (quantize(axes[a][0], last[a]) == false) {
+                return false;
+            }
+            out.insert(out.end(), reinterpret_cast<const int8_t*>(&last[a]), reinterpret_cast<const int8_t*>(&last[a] + 1));
+        }
+        uint32_t values[3 * PACKED_BLOCK];
+        for (size_t start = 1; start < len; start += PACKED_BLOCK) {
+            const size_t count = std::min(static_cast<size_t>(PACKED_BLOCK), len - start);
+            uint32_t bits = 0;
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t a = 0; a < 3; ++a) {
+                    int32_t curr;
+                    if (quantize(axes[a][(start + i) * stride], curr) == false) {
+                        return false;
+                    }
+                    const int32_t diff = curr - last[a];
+                    last[a] = curr;
+                    values[3 * i + a] = (static_cast<uint32_t>(diff) << 1) ^ static_cast<uint32_t>(diff >> 31);
+                    bits |= values[3 * i + a];
+                }
+            }
+            uint32_t width = 0;
+            while (bits >> width) {
+                width++;
+            }
+            out.push_back(static_cast<int8_t>(width));
+            uint64_t acc = 0;
+            unsigned int accBits = 0;
+            for (size_t i = 0; i < 3 * count; ++i) {
+                acc |= static_cast<uint64_t>(values[i]) << accBits;
+                accBits += width;
+                while (accBits >= 8) {
+                    out.push_back(static_cast<int8_t>(acc & 0xFF));
+                    acc >>= 8;
+                    accBits -= 8;
+                }
+            }
+            if (accBits > 0) {
+                out.push_back(static_cast<int8_t>(acc & 0xFF));
+            }
+        }
+        // the entry has to stay shorter than a 16-bit diff entry including the '\0' added by DBWriter
+        return isPackedDiff(len, out.size() + 1);
+    }
+
 private:
     std::vector<float> buffer;
+    float* aligned;
+    size_t alignedSize;
+
+    Coordinate16(const Coordinate16&);
+    Coordinate16& operator=(const Coordinate16&);
+
+    void reserveAligned(size_t stride) {
+        if (3 * stride > alignedSize) {
+            free(aligned);
+            alignedSize = 3 * stride;
+            aligned = (float*) mem_align(PADDED_ALIGN, alignedSize * sizeof(float));
+        }
+    }
+
+    static const char* decodeComponent(const char* data, size_t chainLength, float* out) {
+        int32_t diffSum = 0;
+        int32_t start;
+        memcpy(&start, data, sizeof(int32_t));
+        data += sizeof(int32_t);
+        out[0] = start / 1000.0f;
+        int16_t intDiff = 0;
+        for (size_t i = 1; i < chainLength; ++i) {
+            memcpy(&intDiff, data, sizeof(int16_t));
+            data += sizeof(int16_t);
+            diffSum += intDiff;
+            out[i] = (start + diffSum) / 1000.0f;
+        }
+        return data;
+    }
+
+    template <typename T>
+    static bool quantize(T value, int32_t& out) {
+        static const double scale = std::pow(10.0, PACKED_EXPONENT);
+        const double scaled = std::isnan(value) ? 0.0 : std::nearbyint(value * scale);
+        // differences and their zigzag encoding have to fit into 31 bits
+        if (std::fabs(scaled) >= 536870912.0) {
+            return false;
+        }
+        out = static_cast<int32_t>(scaled);
+        return true;
+    }
+
+    static void decodePacked(const char* mem, size_t chainLength, float* x, float* y, float* z) {
+        static const float divisors[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f };
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(mem);
+        const float divisor = divisors[std::min(static_cast<size_t>(data[0]), sizeof(divisors) / sizeof(float) - 1)];
+        data += 1;
+        float* axes[3] = { x, y, z };
+        int32_t last[3];
+        for (size_t a = 0; a < 3; ++a) {
+            memcpy(&last[a], data, sizeof(int32_t));
+            data += sizeof(int32_t);
+            axes[a][0] = last[a] / divisor;
+        }
+        for (size_t start = 1; start < chainLength; start += PACKED_BLOCK) {
+            const size_t count = std::min(static_cast<size_t>(PACKED_BLOCK), chainLength - start);
+            const unsigned int width = *data++;
+            const uint64_t mask = (static_cast<uint64_t>(1) << width) - 1;
+            uint64_t acc = 0;
+            unsigned int accBits = 0;
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t a = 0; a < 3; ++a) {
+                    while (accBits < width) {
+                        acc |= static_cast<uint64_t>(*data++) << accBits;
+                        accBits += 8;
+                    }
+                    const uint32_t value = static_cast<uint32_t>(acc & mask);
+                    acc >>= width;
+                    accBits -= width;
+                    last[a] += static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+                    axes[a][start + i] = last[a] / divisor;
+                }
+            }
+        }
+    }
+
+    static void decode(const char* mem, size_t chainLength, size_t entryLength, float* x, float* y, float* z) {
+        if (isPackedDiff(chainLength, entryLength)) {
+            decodePacked(mem, chainLength, x, y, z);
+            return;
+        }
+        const char* data = decodeComponent(mem, chainLength, x);
+        data = decodeComponent(data, chainLength, y);
+        decodeComponent(data, chainLength, z);
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
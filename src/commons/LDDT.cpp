@@ -122,8 +122,12 @@ void LDDTCalculator::initQuery(unsigned int queryLen, float *qx, float *qy, floa
 }
 
 LDDTCalculator::LDDTScoreResult LDDTCalculator::computeLDDTScore(unsigned int targetLen, int qStartPos, int tStartPos, const std::string &backtrace, float *tx, float *ty, float *tz) {
+    alnMap.parse(backtrace, qStartPos, tStartPos);
+    return computeLDDTScore(targetLen, alnMap, tx, ty, tz);
+}
+
+LDDTCalculator::LDDTScoreResult LDDTCalculator::computeLDDTScore(unsigned int targetLen, const AlignmentMap &map, float *tx, float *ty, float *tz) {
     targetLength = targetLen;
-    cigar = backtrace;
 
     for(unsigned int i = 0; i < targetLength; i++) {
         target_coordinates[i][0] = tx[i];
@@ -131,28 +135,32 @@ LDDTCalculator::LDDTScoreResult LDDTCalculator::computeLDDTScore(unsigned int ta
         target_coordinates[i][2] = tz[i];
     }
 
-    constructAlignHashes(0, qStartPos, tStartPos);
+    constructAlignHashes(map);
     calculateDistance();
     computeScores();
     return LDDTScoreResult(reduce_score, alignLength);
 }
 
-void LDDTCalculator::constructAlignHashes(int align_idx, int query_idx, int target_idx) {
+void LDDTCalculator::constructAlignHashes(const AlignmentMap &map) {
     memset(query_to_align, -1, sizeof(int) * queryLength);
     memset(target_to_align, -1, sizeof(int) * targetLength);
-    for(std::size_t i = 0; i < cigar.length(); i++) {
-        if(cigar[i] == 'M') {
-            align_to_query[align_idx] = query_idx;
-            query_to_align[query_idx] = align_idx;
-            align_to_target[align_idx] = target_idx;
-            target_to_align[target_idx] = align_idx;
-            align_idx++; query_idx++; target_idx++;
-        } else if(cigar[i] == 'D') {
-            target_to_align[target_idx] = -1; // does not align
-            target_idx++;
-        } else if(cigar[i] == 'I') {
-            query_to_align[query_idx] = -1; // does not align
-            query_idx++;
+    int align_idx = 0;
+    int query_idx = map.qStartPos;
+    int target_idx = map.tStartPos;
+    for(size_t i = 0; i < map.runs.size(); i++) {
+        const uint32_t length = map.runs[i].length;
+        if(map.runs[i].op == 'M') {
+            for(uint32_t j = 0; j < length; j++) {
+                align_to_query[align_idx] = query_idx;
+                query_to_align[query_idx] = align_idx;
+                align_to_target[align_idx] = target_idx;
+                target_to_align[target_idx] = align_idx;
+                align_idx++; query_idx++; target_idx++;
+            }
+        } else if(map.runs[i].op == 'D') {
+            target_idx += length; // does not align
+        } else if(map.runs[i].op == 'I') {
+            query_idx += length; // does not align
         }
     }
     alignLength = align_idx;
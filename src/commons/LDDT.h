@@ -6,6 +6,7 @@
 #include <limits>
 #include <vector>
 #include "FastSort.h"
+#include "AlignmentMap.h"
 
 #ifndef LDDT_H
 #define LDDT_H
@@ -101,10 +102,11 @@ public:
     };
 
     void initQuery(unsigned int queryLen, float *qx, float *qy, float *qz);
-    void constructAlignHashes(int align_idx, int query_idx, int target_idx);
+    void constructAlignHashes(const AlignmentMap &map);
     void calculateDistance();
     void computeScores();
     LDDTScoreResult computeLDDTScore(unsigned int targetLen, int qStartPos, int tStartPos, const std::string &backtrace, float *tx, float *ty, float *tz);
+    LDDTScoreResult computeLDDTScore(unsigned int targetLen, const AlignmentMap &map, float *tx, float *ty, float *tz);
 
 private:
     unsigned int queryLength, targetLength, alignLength;
@@ -114,7 +116,7 @@ private:
     int * target_to_align;
     int * align_to_query;
     int * align_to_target;
-    std::string cigar; // backtrace
+    AlignmentMap alnMap;
     float **query_coordinates, **target_coordinates, **score;
     bool **dists_to_score;
     LDDTCalculator::Grid query_grid;
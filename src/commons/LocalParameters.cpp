@@ -1,6 +1,7 @@
 #include "LocalParameters.h"
 #include "Command.h"
 #include "Debug.h"
+#include "ByteParser.h"
 #include "mat3di.out.h"
 
 
@@ -18,7 +19,18 @@ LocalParameters::LocalParameters() :
         PARAM_CHAIN_NAME_MODE(PARAM_CHAIN_NAME_MODE_ID,"--chain-name-mode", "Chain name mode", "Add chain to name:\n0: auto\n1: always add\n",typeid(int), (void *) &chainNameMode, "^[0-1]{1}$", MMseqsParameter::COMMAND_EXPERT),
         PARAM_TMALIGN_FAST(PARAM_TMALIGN_FAST_ID,"--tmalign-fast", "TMalign fast","turn on fast search in TM-align" ,typeid(int), (void *) &tmAlignFast, "^[0-1]{1}$"),
         PARAM_N_SAMPLE(PARAM_N_SAMPLE_ID, "--n-sample", "Sample size","pick N random sample" ,typeid(int), (void *) &nsample, "^[0-9]{1}[0-9]*$"),
-        PARAM_COORD_STORE_MODE(PARAM_COORD_STORE_MODE_ID, "--coord-store-mode", "Coord store mode", "Coordinate storage mode: \n1: C-alpha as float\n2: C-alpha as difference (uint16_t)", typeid(int), (void *) &coordStoreMode, "^[1-2]{1}$")
+        PARAM_COORD_STORE_MODE(PARAM_COORD_STORE_MODE_ID, "--coord-store-mode", "Coord store mode", "Coordinate storage mode: \n1: C-alpha as float\n2: C-alpha as difference (uint16_t)\n3: C-alpha as bit-packed difference (0.01 A)", typeid(int), (void *) &coordStoreMode, "^[1-3]{1}$"),
+        PARAM_KMER_AA_ALPH_SIZE(PARAM_KMER_AA_ALPH_SIZE_ID, "--kmer-aa-alph-size", "Amino acid alphabet size for k-mers", "Append amino acid letters reduced to this alphabet size to each 3Di k-mer (range 3-21), 0: 3Di only", typeid(int), (void *) &kmerAAAlphabetSize, "^(0|[3-9]|1[0-9]|2[0-1])$", MMseqsParameter::COMMAND_CLUSTLINEAR | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_INDEX_PADDED_CA(PARAM_INDEX_PADDED_CA_ID, "--index-padded-ca", "Index padded C-alpha", "Store C-alpha coordinates in the index as 64 byte aligned floats, aligners use them without decoding (larger index)", typeid(int), (void *) &indexPaddedCa, "^[0-1]{1}$", MMseqsParameter::COMMAND_EXPERT),
+        PARAM_BINARY_ALIGNMENT_DB(PARAM_BINARY_ALIGNMENT_DB_ID, "--binary-alignment-db", "Binary alignment DB", "Write alignment results in the binary result format (readable by convertalis, clust, aln2tmscore and tmalign, not by text tools such as filterdb or result2profile)", typeid(int), (void *) &binaryAlignmentDb, "^[0-1]{1}$", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_TIMING_REPORT(PARAM_TIMING_REPORT_ID, "--timing-report", "Timing report", "Append per-stage timings and hit counts of the alignment and convertalis steps as JSON lines to this file (workflows start a new file and end it with a summary record per module)", typeid(std::string), (void *) &timingReport, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_PDB_OUTPUT_MODE(PARAM_PDB_OUTPUT_MODE_ID, "--pdb-output-mode", "PDB output mode", "PDB output mode:\n0: Single multi-model PDB file\n1: One PDB file per entry in the output directory\n2: One PDB file per entry in the output tar archive", typeid(int), (void *) &pdbOutputMode, "^[0-2]{1}$"),
+        PARAM_REBUILD_BACKBONE(PARAM_REBUILD_BACKBONE_ID, "--rebuild-backbone", "Rebuild backbone", "Add the N and C backbone atoms reconstructed from the C-alpha trace with PULCHRA", typeid(bool), (void *) &rebuildBackbone, ""),
+        PARAM_DESCRIPTOR_FORMAT(PARAM_DESCRIPTOR_FORMAT_ID, "--descriptor-format", "Descriptor format", "3Di descriptor output format:\n0: Text, one line per chain\n1: Binary with float32 features and embeddings", typeid(int), (void *) &descriptorFormat, "^[0-1]{1}$"),
+        PARAM_WRITE_DESCRIPTORS(PARAM_WRITE_DESCRIPTORS_ID, "--write-descriptors", "Write descriptors", "Also write the per residue 3Di descriptors to <o:sequenceDB>_3didescriptor", typeid(bool), (void *) &writeDescriptors, "", MMseqsParameter::COMMAND_EXPERT),
+        PARAM_QUERY_CACHE(PARAM_QUERY_CACHE_ID, "--query-cache", "Query cache", "Reuse the query database of earlier runs with identical query files from this directory (empty: off)", typeid(std::string), (void *) &queryCache, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_QUERY_CACHE_SIZE(PARAM_QUERY_CACHE_SIZE_ID, "--query-cache-size", "Query cache size", "Evict the least recently used query databases when the query cache grows beyond this size. E.g. 800B, 5K, 10M, 1G. 0: unbounded", typeid(ByteParser), (void *) &queryCacheSize, "^(0|[1-9]{1}[0-9]*(B|K|M|G|T)?)$", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_PREFILTER_AA(PARAM_PREFILTER_AA_ID, "--prefilter-aa", "Prefilter with amino acids", "Score the prefilter diagonals with 3Di and amino acids (structureprefilter) instead of 3Di only. Only used with --alignment-type 1 and 2", typeid(int), (void *) &prefilterAA, "^[0-1]{1}$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT)
 {
     PARAM_ALIGNMENT_MODE.description = "How to compute the alignment:\n0: automatic\n1: only score and end_pos\n2: also start_pos and cov\n3: also seq.id";
     PARAM_ALIGNMENT_MODE.regex = "^[0-3]{1}$";
@@ -28,10 +40,12 @@ LocalParameters::LocalParameters() :
                                     "1: SAM\n2: BLAST-TAB + query/db length\n"
                                     "3: Pretty HTML\n4: BLAST-TAB + column headers\n"
                                     "5: Calpha only PDB super-posed to query\n"
-                                    "BLAST-TAB (0) and BLAST-TAB + column headers (4)"
+                                    "6: Columnar binary\n"
+                                    "BLAST-TAB (0), BLAST-TAB + column headers (4) and columnar binary (6) "
                                     "support custom output formats (--format-output)\n"
-                                    "(5) Superposed PDB files (Calpha only)";
-    PARAM_FORMAT_MODE.regex = "^[0-5]{1}$";
+                                    "(5) Superposed PDB files (Calpha only)\n"
+                                    "(6) Typed columns in row groups, numbers are stored as binary values";
+    PARAM_FORMAT_MODE.regex = "^[0-6]{1}$";
     PARAM_SEARCH_TYPE.category = MMseqsParameter::COMMAND_HIDDEN;
     PARAM_TRANSLATION_TABLE.category = MMseqsParameter::COMMAND_HIDDEN;
     PARAM_TRANSLATION_TABLE.category = MMseqsParameter::COMMAND_HIDDEN;
@@ -57,6 +71,8 @@ LocalParameters::LocalParameters() :
     structurecreatedb.push_back(&PARAM_WRITE_LOOKUP);
     structurecreatedb.push_back(&PARAM_TAR_INCLUDE);
     structurecreatedb.push_back(&PARAM_TAR_EXCLUDE);
+    structurecreatedb.push_back(&PARAM_COMPRESSED);
+    structurecreatedb.push_back(&PARAM_COMPRESS_DICTIONARY);
     structurecreatedb.push_back(&PARAM_THREADS);
     structurecreatedb.push_back(&PARAM_V);
     // tmalign
@@ -71,6 +87,8 @@ LocalParameters::LocalParameters() :
     tmalign.push_back(&PARAM_TMALIGN_HIT_ORDER);
     tmalign.push_back(&PARAM_TMALIGN_FAST);
     tmalign.push_back(&PARAM_PRELOAD_MODE);
+    tmalign.push_back(&PARAM_BINARY_ALIGNMENT_DB);
+    tmalign.push_back(&PARAM_TIMING_REPORT);
     tmalign.push_back(&PARAM_THREADS);
     tmalign.push_back(&PARAM_V);
 
@@ -80,13 +98,23 @@ LocalParameters::LocalParameters() :
     structurealign.push_back(&PARAM_TMSCORE_THRESHOLD);
     structurealign.push_back(&PARAM_LDDT_THRESHOLD);
     structurealign.push_back(&PARAM_SORT_BY_STRUCTURE_BITS);
+    structurealign.push_back(&PARAM_BINARY_ALIGNMENT_DB);
+    structurealign.push_back(&PARAM_SPLIT_MEMORY_LIMIT);
+    structurealign.push_back(&PARAM_TIMING_REPORT);
     structurealign = combineList(structurealign, align);
 //    tmalign.push_back(&PARAM_GAP_OPEN);
 //    tmalign.push_back(&PARAM_GAP_EXTEND);
+    structurekmermatcher.push_back(&PARAM_KMER_AA_ALPH_SIZE);
+    structurekmermatcher = combineList(kmermatcher, structurekmermatcher);
+
+    structureungappedprefilter = combineList(ungappedprefilter, structureungappedprefilter);
+    structureungappedprefilter.push_back(&PARAM_INCLUDE_IDENTITY);
+    structureungappedprefilter.push_back(&PARAM_PRELOAD_MODE);
+
     // strucclust
     strucclust = combineList(clust, structurealign);
     strucclust = combineList(strucclust, structurerescorediagonal);
-    strucclust = combineList(strucclust, kmermatcher);
+    strucclust = combineList(strucclust, structurekmermatcher);
     strucclust.push_back(&PARAM_REMOVE_TMP_FILES);
     strucclust.push_back(&PARAM_RUNNER);
     // structuresearchworkflow
@@ -95,12 +123,17 @@ LocalParameters::LocalParameters() :
     structuresearchworkflow = combineList(tmalign, structuresearchworkflow);
     structuresearchworkflow.push_back(&PARAM_NUM_ITERATIONS);
     structuresearchworkflow.push_back(&PARAM_ALIGNMENT_TYPE);
+    structuresearchworkflow.push_back(&PARAM_PREFILTER_AA);
     structuresearchworkflow.push_back(&PARAM_REMOVE_TMP_FILES);
     structuresearchworkflow.push_back(&PARAM_RUNNER);
     structuresearchworkflow.push_back(&PARAM_REUSELATEST);
 
+    convertalignments.push_back(&PARAM_TIMING_REPORT);
+
     easystructuresearchworkflow = combineList(structuresearchworkflow, structurecreatedb);
     easystructuresearchworkflow = combineList(easystructuresearchworkflow, convertalignments);
+    easystructuresearchworkflow.push_back(&PARAM_QUERY_CACHE);
+    easystructuresearchworkflow.push_back(&PARAM_QUERY_CACHE_SIZE);
 
     structureclusterworkflow = combineList(prefilter, structurealign);
     structureclusterworkflow = combineList(structureclusterworkflow, rescorediagonal);
@@ -113,6 +146,7 @@ LocalParameters::LocalParameters() :
     structureclusterworkflow.push_back(&PARAM_REUSELATEST);
     structureclusterworkflow.push_back(&PARAM_RUNNER);
     structureclusterworkflow = combineList(structureclusterworkflow, linclustworkflow);
+    structureclusterworkflow.push_back(&PARAM_KMER_AA_ALPH_SIZE);
 
     easystructureclusterworkflow = combineList(structureclusterworkflow, structurecreatedb);
     easystructureclusterworkflow = combineList(easystructureclusterworkflow, result2repseq);
@@ -127,6 +161,25 @@ LocalParameters::LocalParameters() :
     databases.push_back(&PARAM_THREADS);
     databases.push_back(&PARAM_V);
     //easystructureclusterworkflow = combineList(structuresearchworkflow, structurecreatedb);
+    structurecreateindex = createindex;
+    structurecreateindex.push_back(&PARAM_INDEX_PADDED_CA);
+
+    compressca.push_back(&PARAM_COORD_STORE_MODE);
+    compressca.push_back(&PARAM_THREADS);
+    compressca.push_back(&PARAM_V);
+
+    convert2pdb.push_back(&PARAM_PDB_OUTPUT_MODE);
+    convert2pdb.push_back(&PARAM_REBUILD_BACKBONE);
+    convert2pdb.push_back(&PARAM_THREADS);
+    convert2pdb.push_back(&PARAM_V);
+
+    structureto3didescriptor = structurecreatedb;
+    structureto3didescriptor.push_back(&PARAM_DESCRIPTOR_FORMAT);
+
+    structurecreatedbdescriptors = structurecreatedb;
+    structurecreatedbdescriptors.push_back(&PARAM_WRITE_DESCRIPTORS);
+    structurecreatedbdescriptors.push_back(&PARAM_DESCRIPTOR_FORMAT);
+
     samplemulambda.push_back(&PARAM_N_SAMPLE);
     samplemulambda.push_back(&PARAM_THREADS);
     samplemulambda.push_back(&PARAM_V);
@@ -145,6 +198,17 @@ LocalParameters::LocalParameters() :
     nsample = 5000;
     maskLowerCaseMode = 1;
     coordStoreMode = COORD_STORE_MODE_CA_FLOAT;
+    kmerAAAlphabetSize = 0;
+    indexPaddedCa = 0;
+    binaryAlignmentDb = 0;
+    timingReport = "";
+    pdbOutputMode = PDB_OUTPUT_MODE_MULTIMODEL;
+    rebuildBackbone = false;
+    descriptorFormat = DESCRIPTOR_FORMAT_TEXT;
+    writeDescriptors = false;
+    queryCache = "";
+    queryCacheSize = 1024UL * 1024UL * 1024UL;
+    prefilterAA = 0;
 
     citations.emplace(CITATION_FOLDSEEK, "van Kempen M, Kim S, Tumescheit C, Mirdita M, Gilchrist C, Söding J, and Steinegger M. Foldseek: fast and accurate protein structure search. bioRxiv, doi:10.1101/2022.02.07.479398 (2022)");
 
@@ -54,10 +54,19 @@ public:
 
     static const int COORD_STORE_MODE_CA_FLOAT = 1;
     static const int COORD_STORE_MODE_CA_DIFF  = 2;
+    static const int COORD_STORE_MODE_CA_PACKED = 3;
 
     static const unsigned int INDEX_DB_CA_KEY = 500;
 
+    static const int PDB_OUTPUT_MODE_MULTIMODEL = 0;
+    static const int PDB_OUTPUT_MODE_FILES = 1;
+    static const int PDB_OUTPUT_MODE_TAR = 2;
+
+    static const int DESCRIPTOR_FORMAT_TEXT = 0;
+    static const int DESCRIPTOR_FORMAT_BINARY = 1;
+
     static const unsigned int FORMAT_ALIGNMENT_PDB_SUPERPOSED = 5;
+    static const unsigned int FORMAT_ALIGNMENT_COLUMNAR = 6;
 
     std::vector<MMseqsParameter *> strucclust;
     std::vector<MMseqsParameter *> tmalign;
@@ -70,6 +79,13 @@ public:
     std::vector<MMseqsParameter *> easystructuresearchworkflow;
     std::vector<MMseqsParameter *> easystructureclusterworkflow;
     std::vector<MMseqsParameter *> structurecreatedb;
+    std::vector<MMseqsParameter *> structurekmermatcher;
+    std::vector<MMseqsParameter *> structureungappedprefilter;
+    std::vector<MMseqsParameter *> structurecreateindex;
+    std::vector<MMseqsParameter *> compressca;
+    std::vector<MMseqsParameter *> convert2pdb;
+    std::vector<MMseqsParameter *> structureto3didescriptor;
+    std::vector<MMseqsParameter *> structurecreatedbdescriptors;
     PARAMETER(PARAM_TMSCORE_THRESHOLD)
     PARAMETER(PARAM_TMALIGN_HIT_ORDER)
     PARAMETER(PARAM_LDDT_THRESHOLD)
@@ -80,6 +96,17 @@ public:
     PARAMETER(PARAM_TMALIGN_FAST)
     PARAMETER(PARAM_N_SAMPLE)
     PARAMETER(PARAM_COORD_STORE_MODE)
+    PARAMETER(PARAM_KMER_AA_ALPH_SIZE)
+    PARAMETER(PARAM_INDEX_PADDED_CA)
+    PARAMETER(PARAM_BINARY_ALIGNMENT_DB)
+    PARAMETER(PARAM_TIMING_REPORT)
+    PARAMETER(PARAM_PDB_OUTPUT_MODE)
+    PARAMETER(PARAM_REBUILD_BACKBONE)
+    PARAMETER(PARAM_DESCRIPTOR_FORMAT)
+    PARAMETER(PARAM_WRITE_DESCRIPTORS)
+    PARAMETER(PARAM_QUERY_CACHE)
+    PARAMETER(PARAM_QUERY_CACHE_SIZE)
+    PARAMETER(PARAM_PREFILTER_AA)
 
     float tmScoreThr;
     int tmAlignHitOrder;
@@ -91,6 +118,17 @@ public:
     int tmAlignFast;
     int nsample;
     int coordStoreMode;
+    int kmerAAAlphabetSize;
+    int indexPaddedCa;
+    int binaryAlignmentDb;
+    std::string timingReport;
+    int pdbOutputMode;
+    bool rebuildBackbone;
+    int descriptorFormat;
+    bool writeDescriptors;
+    std::string queryCache;
+    size_t queryCacheSize;
+    int prefilterAA;
 
     static std::vector<int> getOutputFormat(int formatMode, const std::string &outformat, bool &needSequences, bool &needBacktrace, bool &needFullHeaders,
                                             bool &needLookup, bool &needSource, bool &needTaxonomyMapping, bool &needTaxonomy, bool &needCa, bool &needTMaligner, bool &needLDDT);
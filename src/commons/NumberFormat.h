@@ -0,0 +1,108 @@
+#ifndef FOLDSEEK_NUMBERFORMAT_H
+#define FOLDSEEK_NUMBERFORMAT_H
+
+#include "itoa.h"
+
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Number formatting for the output of convertalis without going through printf or ostringstream.
+// The output is identical to SSTR: "%.3f" for floats and "%.3E" for doubles.
+// The write functions need at least 64 bytes in buffer and return the end of the written string.
+class NumberFormat {
+public:
+    // a float times 1000 is exact as a double, so rounding it to the nearest integer (ties to even
+    // in the default rounding mode) gives the same digits as printf
+    static char *writeFixed3(float value, char *buffer) {
+        const double scaled = static_cast<double>(value) * 1000.0;
+        if (!(std::fabs(scaled) < 9.0e15)) {
+            return buffer + snprintf(buffer, 64, "%.3f", value);
+        }
+        if (std::signbit(value)) {
+            *buffer++ = '-';
+        }
+        const uint64_t rounded = static_cast<uint64_t>(std::nearbyint(std::fabs(scaled)));
+        buffer = Itoa::u64toa_sse2(rounded / 1000, buffer) - 1;
+        const unsigned int fraction = static_cast<unsigned int>(rounded % 1000);
+        buffer[0] = '.';
+        buffer[1] = static_cast<char>('0' + fraction / 100);
+        buffer[2] = static_cast<char>('0' + (fraction / 10) % 10);
+        buffer[3] = static_cast<char>('0' + fraction % 10);
+        return buffer + 4;
+    }
+
+    // the four significant digits are computed with an inexact power of ten, values that are
+    // close to a rounding tie are passed to printf instead
+    static char *writeScientific3(double value, char *buffer) {
+        const double absValue = std::fabs(value);
+        if (absValue == 0.0) {
+            if (std::signbit(value)) {
+                *buffer++ = '-';
+            }
+            memcpy(buffer, "0.000E+00", 9);
+            return buffer + 9;
+        }
+        if (!(absValue > 1e-290 && absValue < 1e290)) {
+            return buffer + snprintf(buffer, 64, "%.3E", value);
+        }
+        int exponent = static_cast<int>(std::floor(std::log10(absValue)));
+        double mantissa = absValue * std::pow(10.0, 3 - exponent);
+        if (mantissa < 1000.0) {
+            exponent--;
+            mantissa = absValue * std::pow(10.0, 3 - exponent);
+        } else if (mantissa >= 10000.0) {
+            exponent++;
+            mantissa = absValue * std::pow(10.0, 3 - exponent);
+        }
+        const double rounded = std::nearbyint(mantissa);
+        if (std::fabs(mantissa - rounded) > 0.5 - 1e-6) {
+            return buffer + snprintf(buffer, 64, "%.3E", value);
+        }
+        unsigned int digits = static_cast<unsigned int>(rounded);
+        if (digits == 10000) {
+            digits = 1000;
+            exponent++;
+        }
+        if (value < 0) {
+            *buffer++ = '-';
+        }
+        buffer[0] = static_cast<char>('0' + digits / 1000);
+        buffer[1] = '.';
+        buffer[2] = static_cast<char>('0' + (digits / 100) % 10);
+        buffer[3] = static_cast<char>('0' + (digits / 10) % 10);
+        buffer[4] = static_cast<char>('0' + digits % 10);
+        buffer[5] = 'E';
+        buffer[6] = exponent < 0 ? '-' : '+';
+        buffer += 7;
+        const unsigned int absExponent = static_cast<unsigned int>(exponent < 0 ? -exponent : exponent);
+        if (absExponent < 10) {
+            *buffer++ = '0';
+        }
+        return Itoa::u32toa_sse2(absExponent, buffer) - 1;
+    }
+
+    static void append(std::string &out, float value) {
+        char buffer[64];
+        out.append(buffer, writeFixed3(value, buffer) - buffer);
+    }
+
+    static void append(std::string &out, double value) {
+        char buffer[64];
+        out.append(buffer, writeScientific3(value, buffer) - buffer);
+    }
+
+    static void append(std::string &out, int value) {
+        char buffer[32];
+        out.append(buffer, Itoa::i32toa_sse2(value, buffer) - buffer - 1);
+    }
+
+    static void append(std::string &out, unsigned int value) {
+        char buffer[32];
+        out.append(buffer, Itoa::u32toa_sse2(value, buffer) - buffer - 1);
+    }
+};
+
+#endif
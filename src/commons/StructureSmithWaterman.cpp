@@ -53,6 +53,13 @@ StructureSmithWaterman::StructureSmithWaterman(size_t maxSequenceLength, int aaS
     profile->profile_3di_word = (simd_int*)mem_align(ALIGN_INT, aaSize * segSize * sizeof(simd_int));
     profile->profile_3di_rev_byte = (simd_int*)mem_align(ALIGN_INT, aaSize * segSize * sizeof(simd_int));
     profile->profile_3di_rev_word = (simd_int*)mem_align(ALIGN_INT, aaSize * segSize * sizeof(simd_int));
+    // allocated on demand by createJointProfile
+    profile->profile_joint_byte = NULL;
+    profile->profile_joint_word = NULL;
+    profile->profile_joint_byte_size = 0;
+    profile->profile_joint_word_size = 0;
+    profile->hasJointByte = false;
+    profile->hasJointWord = false;
     // gap penalties
     profile->profile_gDelOpen_byte = (simd_int*)mem_align(ALIGN_INT, segSize * sizeof(simd_int));
     profile->profile_gDelOpen_word = (simd_int*)mem_align(ALIGN_INT, segSize * sizeof(simd_int));
@@ -121,6 +128,8 @@ StructureSmithWaterman::~StructureSmithWaterman(){
     free(profile->profile_3di_word);
     free(profile->profile_3di_rev_byte);
     free(profile->profile_3di_rev_word);
+    free(profile->profile_joint_byte);
+    free(profile->profile_joint_word);
     free(profile->profile_gDelOpen_byte);
     free(profile->profile_gDelOpen_word);
     free(profile->profile_gDelClose_byte);
@@ -222,6 +231,35 @@ void StructureSmithWaterman::createGapProfile(simd_int* profile_gDelOpen, simd_i
 
 
 
+template <typename T, size_t Elements>
+bool StructureSmithWaterman::createJointProfile(simd_int *&joint, size_t &jointSize, const simd_int *profile_aa, const simd_int *profile_3di,
+                                                const int32_t query_length, const int32_t aaSize) {
+    const int32_t segLen = (query_length + Elements - 1) / Elements;
+    if (useJointProfile(segLen, aaSize) == false) {
+        return false;
+    }
+    const size_t size = static_cast<size_t>(aaSize) * aaSize * segLen;
+    if (size > jointSize) {
+        free(joint);
+        joint = (simd_int*) mem_align(ALIGN_INT, size * sizeof(simd_int));
+        jointSize = size;
+    }
+    simd_int* out = joint;
+    for (int32_t aa = 0; aa < aaSize; ++aa) {
+        const simd_int* vAA = profile_aa + aa * segLen;
+        for (int32_t ss = 0; ss < aaSize; ++ss) {
+            const simd_int* v3Di = profile_3di + ss * segLen;
+            for (int32_t j = 0; j < segLen; ++j) {
+                // same saturation as the sum computed by the kernels from the separate profiles
+                simd_int score = (sizeof(T) == 1) ? simdui8_adds(simdi_load(vAA + j), simdi_load(v3Di + j))
+                                                  : simdi16_adds(simdi_load(vAA + j), simdi_load(v3Di + j));
+                simdi_store(out++, score);
+            }
+        }
+    }
+    return true;
+}
+
 StructureSmithWaterman::s_align StructureSmithWaterman::alignScoreEndPos (
         const unsigned char *db_aa_sequence,
         const unsigned char *db_3di_sequence,
@@ -243,25 +281,55 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignScoreEndPos (
     std::pair<alignment_end, alignment_end> bests;
     // Find the alignment scores and ending positions
     if(profile->isProfile){
-        bests = sw_sse2_byte<PROFILE_HMM>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
-                                          gap_open, gap_extend, profile->profile_gDelOpen_byte, profile->profile_gDelClose_byte,
-                                          profile->profile_gIns_byte, profile->profile_aa_byte, profile->profile_3di_byte,UCHAR_MAX, profile->bias, maskLen);
-
+        if (profile->hasJointByte) {
+            bests = sw_sse2_byte<PROFILE_HMM, true>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                    gap_open, gap_extend, profile->profile_gDelOpen_byte, profile->profile_gDelClose_byte,
+                                                    profile->profile_gIns_byte, profile->profile_joint_byte, NULL, UCHAR_MAX, profile->bias, maskLen);
+        } else {
+            bests = sw_sse2_byte<PROFILE_HMM, false>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                     gap_open, gap_extend, profile->profile_gDelOpen_byte, profile->profile_gDelClose_byte,
+                                                     profile->profile_gIns_byte, profile->profile_aa_byte, profile->profile_3di_byte,UCHAR_MAX, profile->bias, maskLen);
+        }
     }else{
-        bests = sw_sse2_byte<SUBSTITUTIONMATRIX>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
-                                                 gap_open, gap_extend, NULL, NULL, NULL, profile->profile_aa_byte, profile->profile_3di_byte,UCHAR_MAX, profile->bias, maskLen);
+        if (profile->hasJointByte) {
+            bests = sw_sse2_byte<SUBSTITUTIONMATRIX, true>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                           gap_open, gap_extend, NULL, NULL, NULL, profile->profile_joint_byte, NULL, UCHAR_MAX, profile->bias, maskLen);
+        } else {
+            bests = sw_sse2_byte<SUBSTITUTIONMATRIX, false>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                            gap_open, gap_extend, NULL, NULL, NULL, profile->profile_aa_byte, profile->profile_3di_byte,UCHAR_MAX, profile->bias, maskLen);
+        }
     }
     if (bests.first.score == 255) {
+        // the joint word profile is only needed after an overflow of the byte kernel, build it on demand
+        const int32_t segLenWord = (query_length + VECSIZE_INT * 2 - 1) / (VECSIZE_INT * 2);
+        const bool useJointWord = useJointProfile(segLenWord, profile->alphabetSize);
+        if (useJointWord && profile->hasJointWord == false) {
+            profile->hasJointWord = createJointProfile<int16_t, VECSIZE_INT * 2>(profile->profile_joint_word, profile->profile_joint_word_size,
+                                                                                 profile->profile_aa_word, profile->profile_3di_word,
+                                                                                 query_length, profile->alphabetSize);
+        }
         if(profile->isProfile) {
-            bests = sw_sse2_word<PROFILE_HMM>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
-                                              gap_open, gap_extend, profile->profile_gDelOpen_word, profile->profile_gDelClose_word,
-                                              profile->profile_gIns_word, profile->profile_aa_word,
-                                              profile->profile_3di_word, USHRT_MAX, maskLen);
-
+            if (useJointWord) {
+                bests = sw_sse2_word<PROFILE_HMM, true>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                        gap_open, gap_extend, profile->profile_gDelOpen_word, profile->profile_gDelClose_word,
+                                                        profile->profile_gIns_word, profile->profile_joint_word,
+                                                        NULL, USHRT_MAX, maskLen);
+            } else {
+                bests = sw_sse2_word<PROFILE_HMM, false>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                         gap_open, gap_extend, profile->profile_gDelOpen_word, profile->profile_gDelClose_word,
+                                                         profile->profile_gIns_word, profile->profile_aa_word,
+                                                         profile->profile_3di_word, USHRT_MAX, maskLen);
+            }
         } else {
-            bests = sw_sse2_word<SUBSTITUTIONMATRIX>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
-                                                     gap_open, gap_extend, NULL, NULL, NULL, profile->profile_aa_word,
-                                                     profile->profile_3di_word, USHRT_MAX, maskLen);
+            if (useJointWord) {
+                bests = sw_sse2_word<SUBSTITUTIONMATRIX, true>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                               gap_open, gap_extend, NULL, NULL, NULL, profile->profile_joint_word,
+                                                               NULL, USHRT_MAX, maskLen);
+            } else {
+                bests = sw_sse2_word<SUBSTITUTIONMATRIX, false>(db_aa_sequence, db_3di_sequence, 0, db_length, query_length,
+                                                                gap_open, gap_extend, NULL, NULL, NULL, profile->profile_aa_word,
+                                                                profile->profile_3di_word, USHRT_MAX, maskLen);
+            }
         }
         r.word = 1;
     } else if (bests.first.score == 255) {
@@ -301,7 +369,8 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
         std::string & backtrace,
         StructureSmithWaterman::s_align r,
         const int covMode, const float covThr,
-        const int32_t maskLen) {
+        const int32_t maskLen,
+        AlignmentMap * alnMap) {
     int32_t query_length = profile->query_length;
     int32_t queryOffset = query_length - r.qEndPos1 - 1;
     std::pair<alignment_end, alignment_end> bests_reverse;
@@ -316,7 +385,7 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
             createGapProfile<int8_t, VECSIZE_INT * 4>(profile->profile_gDelOpen_rev_byte, profile->profile_gDelClose_rev_byte, profile->profile_gIns_rev_byte,
                                                       profile->gDelOpen_rev, profile->gDelClose_rev, profile->gIns_rev, profile->query_length, queryOffset);
 
-            bests_reverse = sw_sse2_byte<PROFILE_HMM>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
+            bests_reverse = sw_sse2_byte<PROFILE_HMM, false>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
                                                       gap_open, gap_extend, profile->profile_gDelOpen_rev_byte, profile->profile_gDelClose_rev_byte,
                                                       profile->profile_gIns_rev_byte,profile->profile_aa_rev_byte,profile->profile_3di_rev_byte,
                                                       r.score1, profile->bias, maskLen);
@@ -325,7 +394,7 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
                                                                             r.qEndPos1 + 1, profile->alphabetSize, profile->bias, queryOffset, 0);
             createQueryProfile<int8_t, VECSIZE_INT * 4, SUBSTITUTIONMATRIX>(profile->profile_3di_rev_byte, profile->query_3di_rev_sequence, profile->composition_bias_ss_rev, profile->mat_3di,
                                                                             r.qEndPos1 + 1, profile->alphabetSize, profile->bias, queryOffset, 0);
-            bests_reverse = sw_sse2_byte<SUBSTITUTIONMATRIX>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
+            bests_reverse = sw_sse2_byte<SUBSTITUTIONMATRIX, false>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
                                                              gap_open, gap_extend, NULL, NULL, NULL,
                                                              profile->profile_aa_rev_byte,profile->profile_3di_rev_byte,
                                                              r.score1, profile->bias, maskLen);
@@ -341,7 +410,7 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
                                                        profile->profile_gIns_rev_word, profile->gDelOpen_rev,
                                                        profile->gDelClose_rev, profile->gIns_rev,
                                                        profile->query_length, queryOffset);
-            bests_reverse = sw_sse2_word<PROFILE_HMM>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
+            bests_reverse = sw_sse2_word<PROFILE_HMM, false>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
                                                       gap_open, gap_extend, profile->profile_gDelOpen_rev_word, profile->profile_gDelClose_rev_word,
                                                       profile->profile_gIns_rev_word,profile->profile_aa_rev_word, profile->profile_3di_rev_word,
                                                       r.score1, maskLen);
@@ -350,7 +419,7 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
                                                                              r.qEndPos1 + 1, profile->alphabetSize, 0, queryOffset, 0);
             createQueryProfile<int16_t, VECSIZE_INT * 2, SUBSTITUTIONMATRIX>(profile->profile_3di_rev_word, profile->query_3di_rev_sequence, profile->composition_bias_ss_rev, profile->mat_3di,
                                                                              r.qEndPos1 + 1, profile->alphabetSize, 0, queryOffset, 0);
-            bests_reverse = sw_sse2_word<SUBSTITUTIONMATRIX>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
+            bests_reverse = sw_sse2_word<SUBSTITUTIONMATRIX, false>(db_aa_sequence, db_3di_sequence, 1, r.dbEndPos1 + 1, r.qEndPos1 + 1,
                                                              gap_open, gap_extend, NULL, NULL, NULL,
                                                              profile->profile_aa_rev_word, profile->profile_3di_rev_word,
                                                              r.score1, maskLen);
@@ -415,7 +484,7 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
 
     uint32_t aaIds = 0;
     size_t mStateCnt = 0;
-    computerBacktrace(profile, db_aa_sequence, r, backtrace, aaIds,  mStateCnt);
+    computerBacktrace(profile, db_aa_sequence, r, backtrace, aaIds,  mStateCnt, alnMap);
     r.identicalAACnt = aaIds;
     if(path != NULL) {
         delete[] path->seq;
@@ -426,29 +495,35 @@ StructureSmithWaterman::s_align StructureSmithWaterman::alignStartPosBacktrace (
 
 void StructureSmithWaterman::computerBacktrace(s_profile * query, const unsigned char * db_aa_sequence,
                                                s_align & alignment, std::string & backtrace,
-                                               uint32_t & aaIds, size_t & mStatesCnt){
+                                               uint32_t & aaIds, size_t & mStatesCnt, AlignmentMap * alnMap){
     int32_t targetPos = alignment.dbStartPos1, queryPos = alignment.qStartPos1;
+    if (alnMap != NULL) {
+        alnMap->clear(queryPos, targetPos);
+    }
+    size_t alnLength = 0;
+    for (int32_t c = 0; c < alignment.cigarLen; ++c) {
+        alnLength += StructureSmithWaterman::cigar_int_to_len(alignment.cigar[c]);
+    }
+    backtrace.reserve(alnLength);
     for (int32_t c = 0; c < alignment.cigarLen; ++c) {
         char letter = StructureSmithWaterman::cigar_int_to_op(alignment.cigar[c]);
         uint32_t length = StructureSmithWaterman::cigar_int_to_len(alignment.cigar[c]);
-        backtrace.reserve(length);
-        for (uint32_t i = 0; i < length; ++i){
-            if (letter == 'M') {
-                aaIds += (db_aa_sequence[targetPos] == query->query_aa_sequence[queryPos]);
-                ++mStatesCnt;
-                ++queryPos;
-                ++targetPos;
-                backtrace.append("M");
-            } else {
-                if (letter == 'I') {
-                    ++queryPos;
-                    backtrace.append("I");
-                }
-                else{
-                    ++targetPos;
-                    backtrace.append("D");
-                }
+        if (letter == 'M') {
+            for (uint32_t i = 0; i < length; ++i){
+                aaIds += (db_aa_sequence[targetPos + i] == query->query_aa_sequence[queryPos + i]);
             }
+            mStatesCnt += length;
+            queryPos += length;
+            targetPos += length;
+        } else if (letter == 'I') {
+            queryPos += length;
+        } else {
+            letter = 'D';
+            targetPos += length;
+        }
+        backtrace.append(length, letter);
+        if (alnMap != NULL) {
+            alnMap->append(letter, length);
         }
     }
 }
@@ -482,7 +557,7 @@ uint32_t StructureSmithWaterman::cigar_int_to_len (uint32_t cigar_int)
     return res;
 }
 
-template <const unsigned int type>
+template <const unsigned int type, const bool jointProfile>
 std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignment_end> StructureSmithWaterman::sw_sse2_byte (const unsigned char* db_aa_sequence,
                                                                                                                               const unsigned char* db_3di_sequence,
                                                                                                                               int8_t ref_dir,	// 0: forward ref; 1: reverse ref
@@ -559,8 +634,14 @@ std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignme
 
         simd_int vH = pvHStore[segLen - 1];
         vH = simdi8_shiftl (vH, 1); /* Shift the 128-bit value in vH left by 1 byte. */
-        const simd_int* vPAA = query_aa_profile_byte + db_aa_sequence[i] * segLen; /* Right part of the query_profile_byte */
-        const simd_int* vP3Di = query_3di_profile_byte + db_3di_sequence[i] * segLen; /* Right part of the query_profile_byte */
+        const simd_int* vPAA;
+        const simd_int* vP3Di = NULL;
+        if (jointProfile) {
+            vPAA = query_aa_profile_byte + (db_aa_sequence[i] * profile->alphabetSize + db_3di_sequence[i]) * segLen;
+        } else {
+            vPAA = query_aa_profile_byte + db_aa_sequence[i] * segLen; /* Right part of the query_profile_byte */
+            vP3Di = query_3di_profile_byte + db_3di_sequence[i] * segLen; /* Right part of the query_profile_byte */
+        }
         //	int8_t* t;
         //	int32_t ti;
         //        fprintf(stderr, "i: %d of %d:\t ", i,segLen);
@@ -574,7 +655,7 @@ std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignme
 
         /* inner loop to process the query sequence */
         for (j = 0; LIKELY(j < segLen); ++j) {
-            simd_int score = simdui8_adds(simdi_load(vPAA + j), simdi_load(vP3Di + j));
+            simd_int score = jointProfile ? simdi_load(vPAA + j) : simdui8_adds(simdi_load(vPAA + j), simdi_load(vP3Di + j));
 //            int8_t* t;
 //            int32_t ti;
 //            fprintf(stderr, "score: ");
@@ -741,7 +822,7 @@ std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignme
 #undef max16
 }
 
-template <const unsigned int type>
+template <const unsigned int type, const bool jointProfile>
 std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignment_end> StructureSmithWaterman::sw_sse2_word (const unsigned char* db_aa_sequence,
                                                                                                                               const unsigned char* db_3di_sequence,
                                                                                                                               int8_t ref_dir,	// 0: forward ref; 1: reverse ref
@@ -812,15 +893,21 @@ std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignme
 
         simd_int vMaxColumn = vZero; /* vMaxColumn is used to record the max values of column i. */
 
-        const simd_int* vPAA = query_aa_profile_word + db_aa_sequence[i] * segLen; /* Right part of the query_profile_byte */
-        const simd_int* vP3Di = query_3di_profile_word + db_3di_sequence[i] * segLen; /* Right part of the query_profile_byte */
+        const simd_int* vPAA;
+        const simd_int* vP3Di = NULL;
+        if (jointProfile) {
+            vPAA = query_aa_profile_word + (db_aa_sequence[i] * profile->alphabetSize + db_3di_sequence[i]) * segLen;
+        } else {
+            vPAA = query_aa_profile_word + db_aa_sequence[i] * segLen; /* Right part of the query_profile_byte */
+            vP3Di = query_3di_profile_word + db_3di_sequence[i] * segLen; /* Right part of the query_profile_byte */
+        }
 
         pvHLoad = pvHStore;
         pvHStore = pv;
 
         /* inner loop to process the query sequence */
         for (j = 0; LIKELY(j < segLen); j ++) {
-            simd_int score = simdi16_adds(simdi_load(vPAA + j), simdi_load(vP3Di + j));
+            simd_int score = jointProfile ? simdi_load(vPAA + j) : simdi16_adds(simdi_load(vPAA + j), simdi_load(vP3Di + j));
             vH = simdi16_adds(vH, score);
 
             /* Get max from vH, vE and vF. */
@@ -946,6 +1033,53 @@ std::pair<StructureSmithWaterman::alignment_end, StructureSmithWaterman::alignme
 #undef max8
 }
 
+int StructureSmithWaterman::ungapped_alignment(const unsigned char *db_aa_sequence, const unsigned char *db_3di_sequence,
+                                               int32_t db_length) {
+#define SWAP(tmp, arg1, arg2) tmp = arg1; arg1 = arg2; arg2 = tmp;
+    const int32_t element_count = (VECSIZE_INT * 2);
+    // width of the query bands in the striped word profile
+    const int32_t W = (profile->query_length + (element_count - 1)) / element_count;
+
+    simd_int *p;
+    simd_int S;
+    const simd_int vZero = simdi_setzero();
+    simd_int Smax = vZero;
+    simd_int *s_prev, *s_curr; // scores of column j-1 and column j
+    simd_int *s_prev_it, *s_curr_it;
+    const simd_int *qji_aa;
+    const simd_int *qji_3di;
+
+    s_curr = vHStore;
+    s_prev = vHLoad;
+    memset(vHStore, 0, W * sizeof(simd_int));
+    memset(vHLoad, 0, W * sizeof(simd_int));
+
+    for (int32_t j = 0; j < db_length; ++j) {
+        qji_aa = profile->profile_aa_word + db_aa_sequence[j] * W;
+        qji_3di = profile->profile_3di_word + db_3di_sequence[j] * W;
+
+        // S(i-1,j-1) of the first band comes from the last band of the previous column
+        S = simdi_load(s_curr + W - 1);
+        S = simdi8_shiftl(S, 2);
+
+        SWAP(p, s_prev, s_curr);
+        s_curr_it = s_curr;
+        s_prev_it = s_prev;
+
+        for (int32_t i = 0; i < W; ++i) {
+            // S(i,j) = max(0, S(i-1,j-1) + aa(i,x_j) + 3di(i,x_j))
+            S = simdi16_adds(S, simdi_load(qji_aa++));
+            S = simdi16_adds(S, simdi_load(qji_3di++));
+            S = simdi16_max(S, vZero);
+            simdi_store(s_curr_it++, S);
+            Smax = simdi16_max(Smax, S);
+            S = simdi_load(s_prev_it++);
+        }
+    }
+    return simdi16_hmax(Smax);
+#undef SWAP
+}
+
 void StructureSmithWaterman::ssw_init(const Sequence* q_aa,
                                       const Sequence* q_3di,
                                       const int8_t* mat_aa,
@@ -1057,6 +1191,10 @@ void StructureSmithWaterman::ssw_init(const Sequence* q_aa,
                                                                          profile->composition_bias_ss, profile->mat_3di,
                                                                          q_3di->L, alphabetSize, 0, 0, 0);
     }
+    profile->hasJointByte = createJointProfile<int8_t, VECSIZE_INT * 4>(profile->profile_joint_byte, profile->profile_joint_byte_size,
+                                                                        profile->profile_aa_byte, profile->profile_3di_byte,
+                                                                        q_aa->L, alphabetSize);
+    profile->hasJointWord = false;
     for(int32_t i = 0; i< alphabetSize; i++) {
         profile->profile_aa_word_linear[i] = &profile_aa_word_linear_data[i*q_aa->L];
         profile->profile_3di_word_linear[i] = &profile_3di_word_linear_data[i*q_3di->L];
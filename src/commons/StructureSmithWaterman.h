@@ -47,6 +47,7 @@
 #include "BaseMatrix.h"
 
 #include "Sequence.h"
+#include "AlignmentMap.h"
 #include "EvalueComputation.h"
 #include "../strucclustutils/EvalueNeuralNet.h"
 
@@ -133,8 +134,18 @@ public:
             std::string & backtrace,
             StructureSmithWaterman::s_align r,
             const int covMode, const float covThr,
-            const int32_t maskLen);
+            const int32_t maskLen,
+            AlignmentMap * alnMap = NULL);
+
 
+    /*!	@function	Best ungapped local alignment score over all diagonals.
+     @param	db_aa_sequence	amino acid sequence of the target
+     @param	db_3di_sequence	3Di sequence of the target
+     @param	db_length	length of the target
+     @return	sum of the 3Di and amino acid scores of the best diagonal segment
+     @note	requires ssw_init to be called first; uses the 16 bit query profiles, so scores are not limited to 255
+     */
+    int ungapped_alignment(const unsigned char *db_aa_sequence, const unsigned char *db_3di_sequence, int32_t db_length);
 
     /*!	@function	Create the query profile using the query sequence.
      @param	read	pointer to the query sequence; the query sequence needs to be numbers
@@ -175,6 +186,12 @@ public:
     const static unsigned int PROFILE_SEQ = 5;
     const static unsigned int PROFILE_PROFILE = 6;
 
+    // The joint (AA, 3Di) query profile saves a load and an add per segment, but every target
+    // column jumps to one of alphabetSize^2 profile rows. It only pays off with enough segments
+    // per column and as long as the profile stays in L2.
+    const static int32_t JOINT_PROFILE_MIN_SEGMENTS = 12;
+    const static size_t JOINT_PROFILE_MAX_SIZE = 768 * 1024;
+
 private:
 
     struct s_profile{
@@ -219,6 +236,14 @@ private:
         int8_t* rev_alignment_3di_profile;
         int8_t* alignment_aa_profile;
         int8_t* alignment_3di_profile;
+        // striped profiles of all (AA, 3Di) target pairs at index aa * alphabetSize + 3di:
+        // the saturated sum of the AA and 3Di profiles, so the kernels need one load per segment
+        simd_int* profile_joint_byte;
+        simd_int* profile_joint_word;
+        size_t profile_joint_byte_size;
+        size_t profile_joint_word_size;
+        bool hasJointByte;
+        bool hasJointWord;
         bool isProfile;
         // Memory layout of if mat + queryProfile is qL * AA
         //    Query length
@@ -263,8 +288,9 @@ private:
      Gap begin and gap extension are different.
      wight_match > 0, all other weights < 0.
      The returned positions are 0-based.
+     With jointProfile query_aa_profile_* is the joint (AA, 3Di) profile and query_3di_profile_* is unused.
      */
-    template <const unsigned int type>
+    template <const unsigned int type, const bool jointProfile>
     std::pair<alignment_end, alignment_end> sw_sse2_byte (const unsigned char*db_aa_sequence,
                                                           const unsigned char*db_3di_sequence,
                                                           int8_t ref_dir,	// 0: forward ref; 1: reverse ref
@@ -283,7 +309,7 @@ private:
                                                      is set to 0, it will not be used */
                                                           uint8_t bias,  /* Shift 0 point to a positive value. */
                                                           int32_t maskLen);
-    template <const unsigned int type>
+    template <const unsigned int type, const bool jointProfile>
     std::pair<alignment_end, alignment_end> sw_sse2_word (const unsigned char* db_aa_sequence,
                                                           const unsigned char* db_3di_sequence,
                                                           int8_t ref_dir,	// 0: forward ref; 1: reverse ref
@@ -308,7 +334,8 @@ private:
                                              const int8_t *mat_aa, int32_t nAA, const int8_t *mat_3di, int32_t n3Di);
 
     void computerBacktrace(s_profile * query, const unsigned char * db_sequence,
-                           s_align & alignment, std::string & backtrace, uint32_t & aaIds, size_t & mStatesCnt);
+                           s_align & alignment, std::string & backtrace, uint32_t & aaIds, size_t & mStatesCnt,
+                           AlignmentMap * alnMap);
 
 
 //    template<const int T>
@@ -330,6 +357,16 @@ private:
     template <typename T, size_t Elements, const unsigned int type>
     void createQueryProfile(simd_int *profile, const int8_t *query_sequence, const int8_t * composition_bias, const int8_t *mat, const int32_t query_length, const int32_t aaSize, uint8_t bias, const int32_t offset, const int32_t entryLength);
     
+    static bool useJointProfile(int32_t segLen, int32_t alphabetSize) {
+        return segLen >= JOINT_PROFILE_MIN_SEGMENTS
+               && static_cast<size_t>(alphabetSize) * alphabetSize * segLen * sizeof(simd_int) <= JOINT_PROFILE_MAX_SIZE;
+    }
+
+    // returns false if the joint profile should not be used for this query
+    template <typename T, size_t Elements>
+    bool createJointProfile(simd_int *&joint, size_t &jointSize, const simd_int *profile_aa, const simd_int *profile_3di,
+                            const int32_t query_length, const int32_t aaSize);
+
     template <typename T, size_t Elements>
     void createGapProfile(simd_int* profile_gDelOpen, simd_int* profile_gDelClose, simd_int* profile_gIns, const uint8_t* gDelOpen, const uint8_t* gDelClose, const uint8_t* gIns,const int32_t query_length, const int32_t offset);
 
@@ -15,9 +15,6 @@ TMaligner::TMaligner(unsigned int maxSeqLen, bool tmAlignFast)
     query_x = (float*)mem_align(ALIGN_FLOAT, maxSeqLen * sizeof(float) );
     query_y = (float*)mem_align(ALIGN_FLOAT, maxSeqLen * sizeof(float) );
     query_z = (float*)mem_align(ALIGN_FLOAT, maxSeqLen * sizeof(float) );
-    target_x = (float*)mem_align(ALIGN_FLOAT, maxSeqLen * sizeof(float) );
-    target_y = (float*)mem_align(ALIGN_FLOAT, maxSeqLen * sizeof(float) );
-    target_z = (float*)mem_align(ALIGN_FLOAT, maxSeqLen * sizeof(float) );
     mem = (float*)mem_align(ALIGN_FLOAT,6*maxSeqLen*4*sizeof(float));
     querySecStruc  = new char[maxSeqLen];
     targetSecStruc = new char[maxSeqLen];
@@ -28,9 +25,6 @@ TMaligner::~TMaligner(){
     free(query_x);
     free(query_y);
     free(query_z);
-    free(target_x);
-    free(target_y);
-    free(target_z);
     free(mem);
     delete [] querySecStruc;
     delete [] targetSecStruc;
@@ -38,31 +32,17 @@ TMaligner::~TMaligner(){
 }
 
 TMaligner::TMscoreResult TMaligner::computeTMscore(float *x, float *y, float *z, unsigned int targetLen, int qStartPos, int dbStartPos, const std::string &backtrace) {
-    int qPos = qStartPos;
-    int tPos = dbStartPos;
-    std::string cigarString = backtrace;
-    std::fill(invmap, invmap+queryLen, -1);
-    for (size_t btPos = 0; btPos < cigarString.size(); btPos++) {
-        if (cigarString[btPos] == 'M') {
-            invmap[qPos] = tPos;
-            qPos++;
-            tPos++;
-        }
-        else if (cigarString[btPos] == 'I') {
-            qPos++;
-        }
-        else {
-            tPos++;
-        }
-    }
+    alnMap.parse(backtrace, qStartPos, dbStartPos);
+    return computeTMscore(x, y, z, targetLen, alnMap);
+}
+
+TMaligner::TMscoreResult TMaligner::computeTMscore(float *x, float *y, float *z, unsigned int targetLen, const AlignmentMap &map) {
+    map.fillInvmap(invmap, queryLen);
 
-    memcpy(target_x, x, sizeof(float) * targetLen);
-    memcpy(target_y, y, sizeof(float) * targetLen);
-    memcpy(target_z, z, sizeof(float) * targetLen);
     Coordinates targetCaCords;
-    targetCaCords.x = target_x;
-    targetCaCords.y = target_y;
-    targetCaCords.z = target_z;
+    targetCaCords.x = x;
+    targetCaCords.y = y;
+    targetCaCords.z = z;
     Coordinates queryCaCords;
     queryCaCords.x = query_x;
     queryCaCords.y = query_y;
@@ -74,7 +54,7 @@ TMaligner::TMscoreResult TMaligner::computeTMscore(float *x, float *y, float *z,
     int L_ali;                // Aligned length in standard_TMscore
     float Lnorm;         //normalization length
     float score_d8,d0,d0_search,dcu0;//for TMscore search
-    parameter_set4search(std::min((unsigned int)backtrace.size(), targetLen),  queryLen, D0_MIN, Lnorm,
+    parameter_set4search(std::min((unsigned int)map.columns, targetLen),  queryLen, D0_MIN, Lnorm,
                          score_d8, d0, d0_search, dcu0);
     double prevD0_MIN = D0_MIN;// stored for later use
     int prevLnorm = Lnorm;
@@ -109,13 +89,10 @@ void TMaligner::initQuery(float *x, float *y, float *z, char * querySeq, unsigne
 Matcher::result_t TMaligner::align(unsigned int dbKey, float *x, float *y, float *z, char * targetSeq, unsigned int targetLen, float &TM1){
     backtrace.clear();
 
-    memcpy(target_x, x, sizeof(float) * targetLen);
-    memcpy(target_y, y, sizeof(float) * targetLen);
-    memcpy(target_z, z, sizeof(float) * targetLen);
     Coordinates targetCaCords;
-    targetCaCords.x = target_x;
-    targetCaCords.y = target_y;
-    targetCaCords.z = target_z;
+    targetCaCords.x = x;
+    targetCaCords.y = y;
+    targetCaCords.z = z;
     Coordinates queryCaCords;
     queryCaCords.x = query_x;
     queryCaCords.y = query_y;
@@ -7,6 +7,7 @@
 
 
 #include "Matcher.h"
+#include "AlignmentMap.h"
 #include "tmalign/affineneedlemanwunsch.h"
 #include "tmalign/Coordinates.h"
 
@@ -35,20 +36,22 @@ public:
         double rmsd;
     };
     void initQuery(float * x, float * y, float * z, char * querySeq, unsigned int queryLen);
+    // target coordinates are used in place: x, y and z have to be ALIGN_FLOAT aligned and readable
+    // up to the next multiple of VECSIZE_FLOAT (see Coordinate16::readAligned)
     TMscoreResult computeTMscore(float *x, float *y, float *z,
                                  unsigned int targetLen, int qStartPos,
                                  int targetStartPos, const std::string & backtrace);
+    TMscoreResult computeTMscore(float *x, float *y, float *z,
+                                 unsigned int targetLen, const AlignmentMap & map);
     Matcher::result_t align(unsigned int dbKey, float *target_x, float *target_y, float *target_z,
                             char * targetSeq, unsigned int targetLen, float &TM);
 private:
     AffineNeedlemanWunsch affineNW;
     std::string backtrace;
+    AlignmentMap alnMap;
     float * query_x;
     float * query_y;
     float * query_z;
-    float * target_x;
-    float * target_y;
-    float * target_z;
     char * querySecStruc;
     char * targetSecStruc;
     float *mem;
@@ -0,0 +1,262 @@
+#ifndef FOLDSEEK_TIMINGREPORT_H
+#define FOLDSEEK_TIMINGREPORT_H
+
+#include "Debug.h"
+#include "Util.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Per-thread timers of the hot paths and hit counters of the alignment modules (--timing-report).
+// Every module run appends one JSON object per line to the report file, workflows pass the same
+// file to all of their steps and finish with timingsummary, which appends the per module sums.
+// If the report is disabled thread() returns NULL and Scope does not read the clock.
+class TimingReport {
+public:
+    enum Stage {
+        SW_SCORE,
+        SW_BACKTRACE,
+        REVERSE_ALIGNMENT,
+        TMSCORE,
+        LDDT,
+        COORD_DECODE,
+        IO_WAIT,
+        OUTPUT_FORMAT,
+        STAGE_COUNT
+    };
+
+    // hit funnel: every prefilter hit ends up in exactly one of the other counters,
+    // unless it is skipped by --max-accept, --max-rejected or a target split
+    enum Counter {
+        PREFILTER_HITS,
+        COVERAGE_REJECTED,
+        EVALUE_REJECTED,
+        THRESHOLD_REJECTED,
+        ACCEPTED,
+        COUNTER_COUNT
+    };
+
+    struct Thread {
+        uint64_t nanoseconds[STAGE_COUNT];
+        uint64_t calls[STAGE_COUNT];
+        uint64_t counts[COUNTER_COUNT];
+        // keeps the counters of different threads in different cache lines
+        char padding[64];
+    };
+
+    class Scope {
+    public:
+        Scope(Thread *thread, Stage stage) : thread(thread), stage(stage), start(thread != NULL ? now() : 0) {}
+        ~Scope() {
+            if (thread != NULL) {
+                thread->nanoseconds[stage] += now() - start;
+                thread->calls[stage]++;
+            }
+        }
+    private:
+        Thread *thread;
+        Stage stage;
+        uint64_t start;
+    };
+
+    TimingReport(const std::string &file, int threadCnt) : file(file), threads(file.empty() ? 0 : threadCnt), start(now()) {
+        for (size_t i = 0; i < threads.size(); ++i) {
+            memset(&threads[i], 0, sizeof(Thread));
+        }
+    }
+
+    Thread *thread(unsigned int threadIdx) {
+        return threads.empty() ? NULL : &threads[threadIdx];
+    }
+
+    static void count(Thread *thread, Counter counter, uint64_t n = 1) {
+        if (thread != NULL) {
+            thread->counts[counter] += n;
+        }
+    }
+
+    static uint64_t now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    // appends the summed counters of all threads as one line to the report file
+    void write(const char *module) {
+        if (threads.empty()) {
+            return;
+        }
+        Thread total;
+        memset(&total, 0, sizeof(Thread));
+        for (size_t i = 0; i < threads.size(); ++i) {
+            for (size_t j = 0; j < STAGE_COUNT; ++j) {
+                total.nanoseconds[j] += threads[i].nanoseconds[j];
+                total.calls[j] += threads[i].calls[j];
+            }
+            for (size_t j = 0; j < COUNTER_COUNT; ++j) {
+                total.counts[j] += threads[i].counts[j];
+            }
+        }
+
+        std::string json;
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer), "{\"module\":\"%s\",\"threads\":%zu,\"wall_seconds\":%.6f,",
+                 module, threads.size(), (now() - start) / 1e9);
+        json.append(buffer);
+        appendTotals(json, total);
+        json.append("}\n");
+        writeFile(file, json, "a");
+    }
+
+    // Sums the records of every module in the report file and appends them as one summary record.
+    // A summary left by an earlier call (e.g. of a nested workflow) is replaced.
+    static void summarize(const std::string &file) {
+        static const char *SUMMARY_KEY = "{\"summary\":";
+        FILE *handle = fopen(file.c_str(), "r");
+        if (handle == NULL) {
+            // none of the steps wrote a record
+            return;
+        }
+        std::string records;
+        std::vector<std::string> modules;
+        std::vector<size_t> runs;
+        std::vector<double> wallSeconds;
+        std::vector<Thread> totals;
+        char *line = NULL;
+        size_t lineSize = 0;
+        while (getline(&line, &lineSize, handle) != -1) {
+            char module[256];
+            double seconds;
+            if (sscanf(line, "{\"module\":\"%255[^\"]\",\"threads\":%*u,\"wall_seconds\":%lf", module, &seconds) != 2) {
+                if (strncmp(line, SUMMARY_KEY, strlen(SUMMARY_KEY)) != 0) {
+                    Debug(Debug::ERROR) << "Invalid record in timing report " << file << ": " << line;
+                    EXIT(EXIT_FAILURE);
+                }
+                continue;
+            }
+            records.append(line);
+            size_t idx = std::find(modules.begin(), modules.end(), module) - modules.begin();
+            if (idx == modules.size()) {
+                modules.push_back(module);
+                runs.push_back(0);
+                wallSeconds.push_back(0.0);
+                totals.push_back(Thread());
+                memset(&totals.back(), 0, sizeof(Thread));
+            }
+            runs[idx]++;
+            wallSeconds[idx] += seconds;
+            if (parseTotals(line, totals[idx]) == false) {
+                Debug(Debug::ERROR) << "Invalid record in timing report " << file << ": " << line;
+                EXIT(EXIT_FAILURE);
+            }
+        }
+        free(line);
+        fclose(handle);
+
+        std::string json = SUMMARY_KEY;
+        json.append("{");
+        char buffer[256];
+        for (size_t i = 0; i < modules.size(); ++i) {
+            snprintf(buffer, sizeof(buffer), "%s\"%s\":{\"runs\":%zu,\"wall_seconds\":%.6f,",
+                     i > 0 ? "," : "", modules[i].c_str(), runs[i], wallSeconds[i]);
+            json.append(buffer);
+            appendTotals(json, totals[i]);
+            json.append("}");
+        }
+        json.append("}}\n");
+        records.append(json);
+        writeFile(file, records, "w");
+    }
+
+private:
+    static const char *stageName(size_t stage) {
+        static const char *names[STAGE_COUNT] = {
+            "sw_score", "sw_backtrace", "reverse_alignment", "tmscore", "lddt", "coord_decode", "io_wait", "output_format"
+        };
+        return names[stage];
+    }
+
+    static const char *counterName(size_t counter) {
+        static const char *names[COUNTER_COUNT] = {
+            "prefilter", "coverage_rejected", "evalue_rejected", "threshold_rejected", "accepted"
+        };
+        return names[counter];
+    }
+
+    static void appendTotals(std::string &json, const Thread &total) {
+        char buffer[256];
+        json.append("\"stages\":{");
+        for (size_t j = 0; j < STAGE_COUNT; ++j) {
+            snprintf(buffer, sizeof(buffer), "%s\"%s\":{\"seconds\":%.6f,\"calls\":%llu}", j > 0 ? "," : "",
+                     stageName(j), total.nanoseconds[j] / 1e9, static_cast<unsigned long long>(total.calls[j]));
+            json.append(buffer);
+        }
+        json.append("},\"hits\":{");
+        for (size_t j = 0; j < COUNTER_COUNT; ++j) {
+            snprintf(buffer, sizeof(buffer), "%s\"%s\":%llu", j > 0 ? "," : "",
+                     counterName(j), static_cast<unsigned long long>(total.counts[j]));
+            json.append(buffer);
+        }
+        json.append("}");
+    }
+
+    // adds the stages and hits of a record written by write() to total
+    static bool parseTotals(const char *line, Thread &total) {
+        const char *stages = strstr(line, "\"stages\":{");
+        const char *hits = strstr(line, "\"hits\":{");
+        if (stages == NULL || hits == NULL) {
+            return false;
+        }
+        char key[64];
+        for (size_t j = 0; j < STAGE_COUNT; ++j) {
+            snprintf(key, sizeof(key), "\"%s\":{", stageName(j));
+            const char *pos = strstr(stages, key);
+            double seconds;
+            unsigned long long calls;
+            if (pos == NULL || sscanf(pos + strlen(key), "\"seconds\":%lf,\"calls\":%llu", &seconds, &calls) != 2) {
+                return false;
+            }
+            total.nanoseconds[j] += static_cast<uint64_t>(seconds * 1e9 + 0.5);
+            total.calls[j] += calls;
+        }
+        for (size_t j = 0; j < COUNTER_COUNT; ++j) {
+            snprintf(key, sizeof(key), "\"%s\":", counterName(j));
+            const char *pos = strstr(hits, key);
+            unsigned long long count;
+            if (pos == NULL || sscanf(pos + strlen(key), "%llu", &count) != 1) {
+                return false;
+            }
+            total.counts[j] += count;
+        }
+        return true;
+    }
+
+    // a single write per call, so that concurrent MPI ranks do not interleave lines
+    static void writeFile(const std::string &file, const std::string &data, const char *mode) {
+        FILE *handle = fopen(file.c_str(), mode);
+        if (handle == NULL) {
+            Debug(Debug::ERROR) << "Cannot open timing report " << file << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (fwrite(data.c_str(), sizeof(char), data.size(), handle) != data.size()) {
+            Debug(Debug::ERROR) << "Cannot write timing report " << file << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (fclose(handle) != 0) {
+            Debug(Debug::ERROR) << "Cannot close timing report " << file << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+
+    std::string file;
+    std::vector<Thread> threads;
+    uint64_t start;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef FOLDSEEK_UNGAPPEDDIAGONAL_H
+#define FOLDSEEK_UNGAPPEDDIAGONAL_H
+
+#include "DistanceCalculator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// Local ungapped 3Di+AA alignment along the diagonal of a prefilter hit, as used by structurerescorediagonal.
+class UngappedDiagonal {
+public:
+    template<typename T>
+    static DistanceCalculator::LocalAlignment align(const T *seq3Di1, const T *seqAA1,
+                                                    const T *seq3Di2, const T *seqAA2,
+                                                    const unsigned int length,
+                                                    short **sub3DiMat, short **subAAMat) {
+        int maxScore = 0;
+        int maxEndPos = 0;
+        int maxStartPos = 0;
+        int minPos = -1;
+        int score = 0;
+        for(unsigned int pos = 0; pos < length; pos++){
+            int curr3Di = sub3DiMat[static_cast<int>(seq3Di1[pos])][static_cast<int>(seq3Di2[pos])];
+            int currAAi = subAAMat[static_cast<int>(seqAA1[pos])][static_cast<int>(seqAA2[pos])];
+            score = curr3Di + currAAi + score;
+            const bool isMinScore = (score <= 0);
+            score =  (isMinScore) ? 0 : score;
+            minPos = (isMinScore) ? pos : minPos;
+            const bool isNewMaxScore = (score > maxScore);
+            maxEndPos = (isNewMaxScore) ? pos : maxEndPos;
+            maxStartPos = (isNewMaxScore) ? minPos + 1 : maxStartPos;
+            maxScore = (isNewMaxScore)? score : maxScore;
+        }
+        return DistanceCalculator::LocalAlignment(maxStartPos, maxEndPos, maxScore);
+    }
+
+    // Aligns the query and the reversed query (the null model) to the target on diagonal = qPos - tPos.
+    // Positions of both results are relative to the start of the diagonal, forward.diagonalLen is its length.
+    // Returns false if the diagonal does not overlap both sequences.
+    template<typename T>
+    static bool alignDiagonal(const T *q3Di, const T *qAA, const T *qRev3Di, const T *qRevAA, unsigned int qLen,
+                              const T *t3Di, const T *tAA, unsigned int tLen, int diagonal,
+                              short **sub3DiMat, short **subAAMat,
+                              DistanceCalculator::LocalAlignment &forward, DistanceCalculator::LocalAlignment &reverse) {
+        const unsigned int minDistToDiagonal = abs(diagonal);
+        unsigned int qOffset = 0;
+        unsigned int tOffset = 0;
+        unsigned int length;
+        if (diagonal >= 0 && minDistToDiagonal < qLen) {
+            qOffset = minDistToDiagonal;
+            length = std::min(tLen, qLen - minDistToDiagonal);
+        } else if (diagonal < 0 && minDistToDiagonal < tLen) {
+            tOffset = minDistToDiagonal;
+            length = std::min(tLen - minDistToDiagonal, qLen);
+        } else {
+            return false;
+        }
+        forward = align(q3Di + qOffset, qAA + qOffset, t3Di + tOffset, tAA + tOffset, length, sub3DiMat, subAAMat);
+        forward.diagonalLen = length;
+        reverse = align(qRev3Di + qOffset, qRevAA + qOffset, t3Di + tOffset, tAA + tOffset, length, sub3DiMat, subAAMat);
+        return true;
+    }
+};
+
+#endif
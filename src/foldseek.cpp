@@ -27,7 +27,7 @@ void (*validatorUpdate)(void) = updateValdiation;
 
 
 std::vector<struct Command> commands = {
-        {"createdb",             createdb,            &localPar.structurecreatedb,    COMMAND_MAIN,
+        {"createdb",             createdb,            &localPar.structurecreatedbdescriptors,    COMMAND_MAIN,
                 "Convert PDB/mmCIF/tar[.gz]/DB files to a db.",
                 "Convert PDB/mmCIF/tar[.gz]/DB files to a db.",
                 "Martin Steinegger <martin.steinegger@snu.ac.kr>",
@@ -40,7 +40,7 @@ std::vector<struct Command> commands = {
 #endif
                                           },
                                           {"sequenceDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
-        {"structureto3didescriptor",             structureto3didescriptor,            &localPar.structurecreatedb,    COMMAND_HIDDEN,
+        {"structureto3didescriptor",             structureto3didescriptor,            &localPar.structureto3didescriptor,    COMMAND_HIDDEN,
                 "Convert PDB/mmCIF/tar[.gz] files to a db.",
                 "Convert PDB/mmCIF/tar[.gz] files to a db.",
                 "Martin Steinegger <martin.steinegger@snu.ac.kr>",
@@ -130,6 +130,22 @@ std::vector<struct Command> commands = {
                 CITATION_FOLDSEEK|CITATION_MMSEQS2, {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
                                           {"clusterDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::clusterDb },
                                           {"tmpDir", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory }}},
+        {"structureungappedprefilter", structureungappedprefilter, &localPar.structureungappedprefilter, COMMAND_PREFILTER,
+                "Exhaustive search scoring the best ungapped 3Di+AA diagonal of every target",
+                NULL,
+                "Martin Steinegger <martin.steinegger@snu.ac.kr>",
+                "<i:queryDB> <i:targetDB> <o:prefilterDB>",
+                CITATION_FOLDSEEK, {{"queryDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                          {"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                          {"prefilterDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::prefilterDb }}},
+        {"structureprefilter", structureprefilter, &localPar.prefilter, COMMAND_PREFILTER,
+                "Double consecutive diagonal k-mer search on 3Di with 3Di+AA ungapped diagonal scores",
+                NULL,
+                "Martin Steinegger <martin.steinegger@snu.ac.kr>",
+                "<i:queryDB> <i:targetDB> <o:prefilterDB>",
+                CITATION_FOLDSEEK|CITATION_MMSEQS2, {{"queryDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                          {"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                          {"prefilterDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::prefilterDb }}},
         {"tmalign",      tmalign,      &localPar.tmalign,      COMMAND_ALIGNMENT,
                 "Compute tm-score ",
                 NULL,
@@ -174,6 +190,13 @@ std::vector<struct Command> commands = {
                 CITATION_FOLDSEEK, {{"queryDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb },
                                   {"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb },
                                   {"tmDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &FoldSeekDbValidator::genericDb }}},
+        {"structurekmermatcher", structurekmermatcher, &localPar.structurekmermatcher, COMMAND_CLUSTER,
+                "Find bottom-m-hashed k-mer matches within 3Di (and amino acid) sequences",
+                NULL,
+                "Martin Steinegger <martin.steinegger@snu.ac.kr>",
+                "<i:sequenceDB> <o:prefilterDB>",
+                CITATION_LINCLUST|CITATION_FOLDSEEK, {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                                    {"prefilterDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::prefilterDb }}},
         {"clust",                clust,                &localPar.clust,                COMMAND_CLUSTER,
                 "Cluster result by Set-Cover/Connected-Component/Greedy-Incremental",
                 NULL,
@@ -190,7 +213,7 @@ std::vector<struct Command> commands = {
                 CITATION_TAXONOMY|CITATION_FOLDSEEK, {{"selection", 0, DbType::ZERO_OR_ALL, &DbValidator::empty },
                                           {"sequenceDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
                                           {"tmpDir",     DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::directory }}},
-        {"createindex",          structureindex,       &localPar.createindex,          COMMAND_DATABASE_CREATION,
+        {"createindex",          structureindex,       &localPar.structurecreateindex,          COMMAND_DATABASE_CREATION,
                 "Store precomputed index on disk to reduce search overhead",
                 "# Create protein sequence index\n"
                 "mmseqs createindex sequenceDB tmp\n",
@@ -228,18 +251,48 @@ std::vector<struct Command> commands = {
                                           {"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER, &DbValidator::sequenceDb },
                                           {"alignmentDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::alignmentDb },
                                           {"alignmentFile", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile}}},
-        {"compressca",           compressca,             &localPar.onlythreads,           COMMAND_FORMAT_CONVERSION,
-                "Create a new compressed C-alpha DB with 16-bit diff encoding where possible from a sequence DB",
+        {"compressca",           compressca,             &localPar.compressca,            COMMAND_FORMAT_CONVERSION,
+                "Create a new compressed C-alpha DB with 16-bit diff (or with --coord-store-mode 3 bit-packed diff) encoding where possible from a sequence DB",
                 NULL,
                 "Milot Mirdita <milot@mirdita.de>",
                 "<i:DB> <o:caDB>",
                 CITATION_FOLDSEEK, {{"Db", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb },
                                           {"caDb", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &FoldSeekDbValidator::cadb }}},
-        {"convert2pdb",          convert2pdb,             &localPar.onlyverbosity,        COMMAND_FORMAT_CONVERSION,
-                "Convert a foldseek structure db to a multi model PDB file",
+        {"makepaddedcadb",       makepaddedcadb,         &localPar.onlythreads,           COMMAND_HIDDEN,
+                "Create a C-alpha DB with 64 byte aligned float coordinates for decode-free access",
                 NULL,
                 "Milot Mirdita <milot@mirdita.de>",
-                "<i:Db> <o:pdbFile>",
+                "<i:DB> <o:caDB>",
+                CITATION_FOLDSEEK, {{"Db", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb },
+                                          {"caDb", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &FoldSeekDbValidator::cadb }}},
+        {"interleavedb",         interleavedb,           &localPar.onlythreads,           COMMAND_FORMAT_CONVERSION,
+                "Store the amino acid, 3Di and C-alpha entries of a structure DB interleaved in one data file",
+                "# The output DB can be used in place of the input DB, e.g. as target of search\n"
+                "foldseek interleavedb targetDB targetDBinterleaved\n",
+                "Milot Mirdita <milot@mirdita.de>",
+                "<i:DB> <o:DB>",
+                CITATION_FOLDSEEK, {{"Db", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb },
+                                          {"Db", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb }}},
+        {"packdb",               packdb,                 &localPar.onlythreads,           COMMAND_FORMAT_CONVERSION,
+                "Store the amino acid and 3Di sequences of a structure DB with 5 bits per residue",
+                "# The output DB can be used in place of the input DB, e.g. as target of search\n"
+                "foldseek packdb targetDB targetDBpacked\n",
+                "Milot Mirdita <milot@mirdita.de>",
+                "<i:DB> <o:DB>",
+                CITATION_FOLDSEEK, {{"Db", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb },
+                                          {"Db", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &FoldSeekDbValidator::sequenceDb }}},
+        {"timingsummary",        timingsummary,          &localPar.onlyverbosity,         COMMAND_HIDDEN,
+                "Append the per module sums of a --timing-report file as a summary record",
+                NULL,
+                "Milot Mirdita <milot@mirdita.de>",
+                "<i:timingReport>",
+                CITATION_FOLDSEEK, {{"timingReport", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
+        {"convert2pdb",          convert2pdb,             &localPar.convert2pdb,          COMMAND_FORMAT_CONVERSION,
+                "Convert a foldseek structure db to a multi model PDB file, PDB files or a tar archive of PDB files",
+                "# One PDB file per entry with reconstructed N and C backbone atoms\n"
+                "foldseek convert2pdb queryDB pdbDir --pdb-output-mode 1 --rebuild-backbone 1\n",
+                "Milot Mirdita <milot@mirdita.de>",
+                "<i:Db> <o:pdbFile|pdbDir|tarFile>",
                 CITATION_FOLDSEEK, {{"Db", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA|DbType::NEED_HEADER, &DbValidator::sequenceDb },
                                           {"pdbFile", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile}}},
         {"version",              versionstring,        &localPar.empty,                COMMAND_HIDDEN,
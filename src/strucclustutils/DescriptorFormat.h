@@ -0,0 +1,73 @@
+#ifndef FOLDSEEK_DESCRIPTORFORMAT_H
+#define FOLDSEEK_DESCRIPTORFORMAT_H
+
+#include "structureto3di.h"
+#include "LocalParameters.h"
+#include "Util.h"
+
+#include <stdint.h>
+#include <string>
+
+// Per residue 3Di descriptors of a chain as written by structureto3didescriptor and createdb --write-descriptors.
+// Text records are one line: header \t amino acids \t 3Di states \t comma separated features of all residues
+// Binary records are in native byte order:
+//   uint32 header length, header, uint32 residue count L, L amino acids, L 3Di states,
+//   L * FEATURE_CNT float32 features, L * EMBEDDING_DIM float32 embeddings
+// Residues without conformational descriptors have zero features and embeddings.
+class DescriptorFormat {
+public:
+    // states are indices into num2aa as returned by StructureTo3Di::structure2states
+    static void append(std::string &out, int format, const char *header, size_t headerLen, const char *aa,
+                       const char *states, const char *num2aa, const StructureTo3Di &structureTo3Di, size_t len) {
+        const std::vector<StructureTo3Di::Feature> &features = structureTo3Di.getFeatures();
+        const std::vector<StructureTo3Di::Embedding> &embeddings = structureTo3Di.getEmbeddings();
+        const std::vector<bool> &mask = structureTo3Di.getMask();
+        if (format == LocalParameters::DESCRIPTOR_FORMAT_BINARY) {
+            appendUInt32(out, headerLen);
+            out.append(header, headerLen);
+            appendUInt32(out, len);
+            out.append(aa, len);
+            for (size_t i = 0; i < len; i++) {
+                out.push_back(num2aa[static_cast<int>(states[i])]);
+            }
+            float values[Alphabet3Di::FEATURE_CNT];
+            for (size_t i = 0; i < len; i++) {
+                for (size_t f = 0; f < Alphabet3Di::FEATURE_CNT; f++) {
+                    values[f] = mask[i] ? static_cast<float>(features[i].f[f]) : 0.0f;
+                }
+                out.append(reinterpret_cast<const char *>(values), sizeof(float) * Alphabet3Di::FEATURE_CNT);
+            }
+            for (size_t i = 0; i < len; i++) {
+                for (size_t f = 0; f < Alphabet3Di::EMBEDDING_DIM; f++) {
+                    values[f] = mask[i] ? static_cast<float>(embeddings[i].f[f]) : 0.0f;
+                }
+                out.append(reinterpret_cast<const char *>(values), sizeof(float) * Alphabet3Di::EMBEDDING_DIM);
+            }
+            return;
+        }
+
+        out.append(header, headerLen);
+        out.push_back('\t');
+        out.append(aa, len);
+        out.push_back('\t');
+        for (size_t i = 0; i < len; i++) {
+            out.push_back(num2aa[static_cast<int>(states[i])]);
+        }
+        out.push_back('\t');
+        for (size_t i = 0; i < len; i++) {
+            for (size_t f = 0; f < Alphabet3Di::FEATURE_CNT; f++) {
+                out.append(SSTR(mask[i] ? features[i].f[f] : 0.0));
+                out.push_back(',');
+            }
+        }
+        out[out.size() - 1] = '\n';
+    }
+
+private:
+    static void appendUInt32(std::string &out, size_t value) {
+        const uint32_t v = static_cast<uint32_t>(value);
+        out.append(reinterpret_cast<const char *>(&v), sizeof(uint32_t));
+    }
+};
+
+#endif //FOLDSEEK_DESCRIPTORFORMAT_H
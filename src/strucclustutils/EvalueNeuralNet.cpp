@@ -6,7 +6,8 @@
 #include "evalue_nn.kerasify.h"
 
 
-EvalueNeuralNet::EvalueNeuralNet(size_t dbResCount, BaseMatrix* subMat) : subMat(subMat) {
+EvalueNeuralNet::EvalueNeuralNet(size_t dbResCount, BaseMatrix* subMat) : subMat(subMat),
+        cacheLambda(NAN), cacheMu(NAN), cacheGeneration(0), cacheStamp(EVALUE_CACHE_SIZE, 0), cacheEvalue(EVALUE_CACHE_SIZE) {
         logDbResidueCount = log(static_cast<double>(dbResCount));
         encoder.LoadModel(
         std::string((const char *)evalue_nn_kerasify,
@@ -8,6 +8,8 @@
 #include "kerasify/keras_model.h"
 #include "BaseMatrix.h"
 #include <iostream>
+#include <vector>
+#include <algorithm>
 class EvalueNeuralNet {
 private:
     BaseMatrix *subMat;
@@ -15,6 +17,15 @@ private:
     KerasModel encoder;
     Tensor in;
     Tensor out;
+
+    // computeEvalueCorr of integer scores for the last lambda and mu,
+    // entries are valid if their stamp equals cacheGeneration
+    static const int EVALUE_CACHE_SIZE = 4096;
+    double cacheLambda;
+    double cacheMu;
+    unsigned int cacheGeneration;
+    std::vector<unsigned int> cacheStamp;
+    std::vector<double> cacheEvalue;
 public:
 
     EvalueNeuralNet(size_t dbResCount, BaseMatrix* subMat);
@@ -43,6 +54,28 @@ public:
 	double corrEvalue = pow(evalue, 0.32);
         return corrEvalue;
     }
+
+    // Same as above for integer scores. Every query keeps its lambda and mu for all of its targets,
+    // so each distinct score is evaluated only once per query.
+    double computeEvalueCorr(int score, double lambda_, double mu) {
+        if (score < 0 || score >= EVALUE_CACHE_SIZE) {
+            return computeEvalueCorr(static_cast<double>(score), lambda_, mu);
+        }
+        if (lambda_ != cacheLambda || mu != cacheMu) {
+            cacheLambda = lambda_;
+            cacheMu = mu;
+            cacheGeneration++;
+            if (cacheGeneration == 0) {
+                std::fill(cacheStamp.begin(), cacheStamp.end(), 0);
+                cacheGeneration = 1;
+            }
+        }
+        if (cacheStamp[score] != cacheGeneration) {
+            cacheEvalue[score] = computeEvalueCorr(static_cast<double>(score), lambda_, mu);
+            cacheStamp[score] = cacheGeneration;
+        }
+        return cacheEvalue[score];
+    }
 };
 
 
@@ -7,6 +7,9 @@
 #include "input.hpp"
 #include "foldcomp.h"
 
+#include <algorithm>
+#include <cstring>
+
 GemmiWrapper::GemmiWrapper(){
     threeAA2oneAA = {{"ALA",'A'},  {"ARG",'R'},  {"ASN",'N'}, {"ASP",'D'},
                      {"CYS",'C'},  {"GLN",'Q'},  {"GLU",'E'}, {"GLY",'G'},
@@ -35,7 +38,7 @@ struct OneShotReadBuf : public std::streambuf
     }
 };
 
-bool GemmiWrapper::loadFromBuffer(const char * buffer, size_t bufferSize, const std::string& name) {
+bool GemmiWrapper::loadFromBuffer(const char * buffer, size_t bufferSize, const std::string& name, bool fastParsers) {
     if (bufferSize > MAGICNUMBER_LENGTH && strncmp(buffer, MAGICNUMBER, MAGICNUMBER_LENGTH) == 0) {
         OneShotReadBuf buf((char *) buffer, bufferSize);
         std::istream istr(&buf);
@@ -47,6 +50,9 @@ bool GemmiWrapper::loadFromBuffer(const char * buffer, size_t bufferSize, const
     try {
         gemmi::MaybeGzipped infile(name);
         gemmi::CoorFormat format = gemmi::coor_format_from_ext(infile.basepath());
+        if (fastParsers && loadFast(buffer, bufferSize, name, (int) format)) {
+            return true;
+        }
         gemmi::Structure st;
         switch (format) {
             case gemmi::CoorFormat::Pdb:
@@ -150,16 +156,7 @@ bool GemmiWrapper::loadFoldcompStructure(std::istream& stream, const std::string
 void GemmiWrapper::updateStructure(void * void_st, const std::string& filename) {
     gemmi::Structure * st = (gemmi::Structure *) void_st;
 
-    title.clear();
-    chain.clear();
-    names.clear();
-    chainNames.clear();
-    ca.clear();
-    ca_bfactor.clear();
-    c.clear();
-    cb.clear();
-    n.clear();
-    ami.clear();
+    clearStructure();
     title.append(  st->get_info("_struct.title"));
     size_t currPos = 0;
     for (gemmi::Model& model : st->models){
@@ -180,7 +177,7 @@ void GemmiWrapper::updateStructure(void * void_st, const std::string& filename)
                 Vec3 cb_atom = {NAN, NAN, NAN};
                 Vec3 n_atom  = {NAN, NAN, NAN};
                 Vec3 c_atom  = {NAN, NAN, NAN};
-                float ca_atom_bfactor;
+                float ca_atom_bfactor = 0.0;
                 for (gemmi::Atom &atom : res.atoms) {
                     if (atom.name == "CA") {
                         ca_atom.x = atom.pos.x;
@@ -207,11 +204,7 @@ void GemmiWrapper::updateStructure(void * void_st, const std::string& filename)
                 n.push_back(n_atom);
                 c.push_back(c_atom);
                 currPos++;
-                if (threeAA2oneAA.find(res.name) == threeAA2oneAA.end()) {
-                    ami.push_back('X');
-                } else {
-                    ami.push_back(threeAA2oneAA[res.name]);
-                }
+                ami.push_back(toOneLetter(res.name));
             }
             chain.push_back(std::make_pair(chainStartPos, currPos));
         }
@@ -227,6 +220,17 @@ bool GemmiWrapper::load(std::string & filename){
         return loadFoldcompStructure(in, filename);
     }
     try {
+        gemmi::MaybeGzipped infile(filename);
+        if (infile.is_stdin() == false) {
+            gemmi::CoorFormat format = gemmi::coor_format_from_ext(infile.basepath());
+            if (format == gemmi::CoorFormat::Unknown) {
+                format = gemmi::CoorFormat::Pdb;
+            }
+            gemmi::CharArray buffer = gemmi::read_into_buffer(infile);
+            if (loadFast(buffer.data(), buffer.size(), filename, (int) format)) {
+                return true;
+            }
+        }
         gemmi::Structure st = openStructure(filename);
         updateStructure((void*) &st, filename);
     } catch (std::runtime_error& e) {
@@ -234,3 +238,605 @@ bool GemmiWrapper::load(std::string & filename){
     }
     return true;
 }
+
+void GemmiWrapper::clearStructure() {
+    title.clear();
+    chain.clear();
+    names.clear();
+    chainNames.clear();
+    ca.clear();
+    ca_bfactor.clear();
+    c.clear();
+    cb.clear();
+    n.clear();
+    ami.clear();
+}
+
+char GemmiWrapper::toOneLetter(const std::string & residueName) {
+    std::unordered_map<std::string, char>::const_iterator it = threeAA2oneAA.find(residueName);
+    return (it == threeAA2oneAA.end()) ? 'X' : it->second;
+}
+
+static std::string baseName(const std::string & filename) {
+    size_t pos = filename.find_last_of("\\/");
+    return (std::string::npos == pos) ? filename : filename.substr(pos + 1, filename.length());
+}
+
+// appends the residues of the parsed chain, like updateStructure only the ATOM residues are used
+void GemmiWrapper::addParsedChain(const std::string & name, const std::string & chainName) {
+    size_t chainStartPos = ca.size();
+    for (size_t i = 0; i < parsedResidues.size(); i++) {
+        const ParsedResidue & res = parsedResidues[i];
+        if (res.hetFlag != 'A') {
+            continue;
+        }
+        ca_bfactor.push_back(res.caBfactor);
+        ca.push_back(res.ca);
+        cb.push_back(res.cb);
+        n.push_back(res.n);
+        c.push_back(res.c);
+        ami.push_back(res.ami);
+    }
+    chain.push_back(std::make_pair(chainStartPos, ca.size()));
+    chainNames.push_back(chainName);
+    names.push_back(name);
+    parsedResidues.clear();
+}
+
+bool GemmiWrapper::loadFast(const char * buffer, size_t bufferSize, const std::string & filename, int format) {
+    // anything the fast parsers reject is read again by gemmi, which reports the actual error
+    try {
+        if (format == (int) gemmi::CoorFormat::Pdb) {
+            return loadPdbFast(buffer, bufferSize, filename);
+        }
+        if (format == (int) gemmi::CoorFormat::Mmcif) {
+            return loadMmcifFast(buffer, bufferSize, filename);
+        }
+    } catch (std::exception& e) {
+        return false;
+    }
+    return false;
+}
+
+// Follows gemmi::pdb_impl::read_pdb_from_stream for ATOM/HETATM, TITLE, MODEL, ENDMDL and END records
+// and uses the same field readers, all other records are skipped.
+bool GemmiWrapper::loadPdbFast(const char * buffer, size_t bufferSize, const std::string & filename) {
+    using namespace gemmi::pdb_impl;
+    clearStructure();
+    parsedResidues.clear();
+    const std::string name = baseName(filename);
+    gemmi::MemoryStream stream(buffer, bufferSize);
+    char line[122] = {0};
+    const int maxLineLength = 120;
+
+    std::vector<std::string> modelNames;
+    bool inModel = false;
+    bool inChain = false;
+    std::string chainName;
+    std::unordered_map<gemmi::ResidueId, size_t> residueIndex;
+    gemmi::ResidueId residueId;
+    size_t currResidue = SIZE_MAX;
+    // residue name, chain, sequence number and segment columns of the previous atom
+    char prevResidueColumns[14];
+    bool prevHasSegment = false;
+    while (size_t len = gemmi::copy_line_from_stream(line, maxLineLength + 1, stream)) {
+        if (is_record_type(line, "ATOM") || is_record_type(line, "HETATM")) {
+            if (len < 55) {
+                return false;
+            }
+            std::string atomChainName = read_string(line + 20, 2);
+            if (!inChain || atomChainName != chainName) {
+                if (!inModel) {
+                    std::string modelName = std::to_string(modelNames.size() + 1);
+                    if (std::find(modelNames.begin(), modelNames.end(), modelName) != modelNames.end()) {
+                        return false;
+                    }
+                    modelNames.push_back(modelName);
+                    inModel = true;
+                }
+                if (inChain) {
+                    addParsedChain(name, chainName);
+                }
+                chainName = atomChainName;
+                inChain = true;
+                residueIndex.clear();
+                currResidue = SIZE_MAX;
+            }
+            const bool hasSegment = len > 72;
+            const bool sameColumns = currResidue != SIZE_MAX
+                                     && memcmp(prevResidueColumns, line + 17, 10) == 0
+                                     && prevHasSegment == hasSegment
+                                     && (hasSegment == false || memcmp(prevResidueColumns + 10, line + 72, 4) == 0);
+            if (sameColumns == false) {
+                gemmi::ResidueId rid = read_res_id(line + 22, line + 17);
+                if (hasSegment) {
+                    rid.segment = read_string(line + 72, 4);
+                }
+                if (currResidue == SIZE_MAX || !residueId.matches(rid)) {
+                    std::unordered_map<gemmi::ResidueId, size_t>::const_iterator it = residueIndex.find(rid);
+                    if (it == residueIndex.end()) {
+                        currResidue = parsedResidues.size();
+                        residueIndex.emplace(rid, currResidue);
+                        parsedResidues.emplace_back(toOneLetter(rid.name), line[0] & ~0x20);
+                    } else {
+                        currResidue = it->second;
+                    }
+                    residueId = rid;
+                }
+                memcpy(prevResidueColumns, line + 17, 10);
+                if (hasSegment) {
+                    memcpy(prevResidueColumns + 10, line + 72, 4);
+                }
+                prevHasSegment = hasSegment;
+            }
+            // gemmi rejects malformed charges
+            if (len > 78) {
+                read_charge(line[78], line[79]);
+            }
+            std::string atomName = read_string(line + 12, 4);
+            Vec3 * pos;
+            ParsedResidue & res = parsedResidues[currResidue];
+            if (atomName == "CA") {
+                pos = &res.ca;
+                res.caBfactor = (len > 64) ? (float) read_double(line + 60, 6) : 20.0f;
+            } else if (atomName == "CB") {
+                pos = &res.cb;
+            } else if (atomName == "N") {
+                pos = &res.n;
+            } else if (atomName == "C") {
+                pos = &res.c;
+            } else {
+                continue;
+            }
+            pos->x = read_double(line + 30, 8);
+            pos->y = read_double(line + 38, 8);
+            pos->z = read_double(line + 46, 8);
+        } else if (is_record_type(line, "TITLE")) {
+            if (len > 10) {
+                title += gemmi::rtrim_str(std::string(line + 10, len - 10 - 1));
+            }
+        } else if (is_record_type(line, "MODEL")) {
+            if (inModel && inChain) {
+                return false;
+            }
+            // repeated model numbers are either rejected or merged by gemmi
+            std::string modelName = std::to_string(read_int(line + 10, 4));
+            if (std::find(modelNames.begin(), modelNames.end(), modelName) != modelNames.end()) {
+                return false;
+            }
+            modelNames.push_back(modelName);
+            inModel = true;
+            if (inChain) {
+                addParsedChain(name, chainName);
+            }
+            inChain = false;
+        } else if (is_record_type(line, "ENDMDL")) {
+            if (inChain) {
+                addParsedChain(name, chainName);
+            }
+            inModel = false;
+            inChain = false;
+        } else if (is_record_type3(line, "TER")) {
+            continue;
+        } else if (is_record_type3(line, "END")) {
+            break;
+        } else if (is_record_type(line, "data")) {
+            if (line[4] == '_' && !inModel) {
+                return false;
+            }
+        } else if (is_record_type(line, "{\"da")) {
+            if (gemmi::ialpha3_id(line + 4) == gemmi::ialpha3_id("ta_") && !inModel) {
+                return false;
+            }
+        }
+    }
+    if (inChain) {
+        addParsedChain(name, chainName);
+    }
+    return true;
+}
+
+// Splits CIF text into the tokens of the gemmi::cif grammar. Values keep their quotes and text field
+// markers like the values stored in a gemmi::cif::Document, so the gemmi::cif value functions apply.
+class CifTokenizer {
+public:
+    enum TokenType { END, TAG, VALUE, LOOP, DATA, UNSUPPORTED };
+
+    CifTokenizer(const char * buffer, size_t bufferSize) : begin(buffer), end(buffer + bufferSize), cur(buffer) {}
+
+    TokenType next(const char *& token, size_t & tokenLen) {
+        while (cur < end) {
+            if (isWhitespace(*cur)) {
+                cur++;
+            } else if (*cur == '#') {
+                while (cur < end && *cur != '\n') {
+                    cur++;
+                }
+            } else {
+                break;
+            }
+        }
+        if (cur == end) {
+            return END;
+        }
+        const char * start = cur;
+        const char first = *cur;
+        if (first == ';' && (cur == begin || cur[-1] == '\n')) {
+            // text field up to the next line starting with ';'
+            const char * p = cur + 1;
+            while (true) {
+                p = (const char *) memchr(p, '\n', end - p);
+                if (p == NULL || p + 1 == end) {
+                    return UNSUPPORTED;
+                }
+                p++;
+                if (*p == ';') {
+                    break;
+                }
+            }
+            cur = p + 1;
+            token = start;
+            tokenLen = cur - start;
+            return VALUE;
+        }
+        if (first == '\'' || first == '"') {
+            // quoted value ends at a matching quote followed by whitespace
+            const char * p = cur + 1;
+            while (true) {
+                if (p == end || *p == '\n') {
+                    return UNSUPPORTED;
+                }
+                if (*p == first && (p + 1 == end || isWhitespace(p[1]) || p[1] == '#')) {
+                    break;
+                }
+                p++;
+            }
+            cur = p + 1;
+            token = start;
+            tokenLen = cur - start;
+            return VALUE;
+        }
+        while (cur < end && *cur >= '!' && *cur <= '~') {
+            cur++;
+        }
+        if (cur < end && isWhitespace(*cur) == false) {
+            return UNSUPPORTED;
+        }
+        token = start;
+        tokenLen = cur - start;
+        if (first == '_') {
+            return TAG;
+        }
+        if (first == '$') {
+            return UNSUPPORTED;
+        }
+        if (startsWith(token, tokenLen, "data_")) {
+            return DATA;
+        }
+        if (tokenLen == 5 && startsWith(token, tokenLen, "loop_")) {
+            return LOOP;
+        }
+        if (startsWith(token, tokenLen, "loop_") || startsWith(token, tokenLen, "save_")
+            || startsWith(token, tokenLen, "global_") || startsWith(token, tokenLen, "stop_")) {
+            return UNSUPPORTED;
+        }
+        return VALUE;
+    }
+
+    // case insensitive like CIF tags and reserved words, prefix must be lower case
+    static bool startsWith(const char * token, size_t tokenLen, const char * prefix) {
+        size_t i = 0;
+        for (; prefix[i] != '\0'; i++) {
+            if (i == tokenLen) {
+                return false;
+            }
+            const char c = (token[i] >= 'A' && token[i] <= 'Z') ? (token[i] | 0x20) : token[i];
+            if (c != prefix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool equals(const char * token, size_t tokenLen, const char * str) {
+        return strlen(str) == tokenLen && startsWith(token, tokenLen, str);
+    }
+
+private:
+    const char * begin;
+    const char * end;
+    const char * cur;
+
+    static bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+};
+
+struct CifValue {
+    const char * data;
+    size_t len;
+
+    CifValue() : data(NULL), len(0) {}
+
+    bool operator==(const CifValue & other) const {
+        return len == other.len && (len == 0 || memcmp(data, other.data, len) == 0);
+    }
+    bool operator!=(const CifValue & other) const {
+        return !(*this == other);
+    }
+    bool isNull() const {
+        return len == 1 && (data[0] == '?' || data[0] == '.');
+    }
+    // quoted and text field values need gemmi::cif::as_string
+    bool isPlain() const {
+        return data[0] != '\'' && data[0] != '"' && data[0] != ';';
+    }
+    std::string raw() const {
+        return std::string(data, len);
+    }
+    std::string str() const {
+        return gemmi::cif::as_string(raw());
+    }
+    bool equals(const char * other, size_t otherLen) const {
+        return len == otherLen && memcmp(data, other, len) == 0;
+    }
+    bool equals(const char * other) const {
+        return equals(other, strlen(other));
+    }
+};
+
+// same as gemmi::cif::as_number without copying the value into a std::string
+static double cifNumber(const CifValue & value, double nan = NAN) {
+    const char * start = value.data;
+    const char * end = value.data + value.len;
+    if (*start == '+') {
+        ++start;
+    }
+    // NaN, Inf and -Inf are not allowed in CIF
+    const char * f = start + (start < end && *start == '-');
+    if (f < end && ((*f | 0x20) == 'i' || (*f | 0x20) == 'n')) {
+        return nan;
+    }
+    double d;
+    fast_float::from_chars_result result = fast_float::from_chars(start, end, d);
+    if (result.ec != std::errc()) {
+        return nan;
+    }
+    if (result.ptr < end && *result.ptr == '(') {
+        const char * p = result.ptr + 1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+        if (p < end && *p == ')') {
+            result.ptr = p + 1;
+        }
+    }
+    return result.ptr == end ? d : nan;
+}
+
+// Follows gemmi::make_structure for the _atom_site loop and _struct.title of single block mmCIF files.
+bool GemmiWrapper::loadMmcifFast(const char * buffer, size_t bufferSize, const std::string & filename) {
+    enum { kId = 0, kGroupPdb, kSymbol, kLabelAtomId, kAltId, kLabelCompId, kLabelAsymId, kLabelSeqId, kInsCode,
+           kX, kY, kZ, kOcc, kBiso, kCharge, kAuthSeqId, kAuthCompId, kAuthAsymId, kAuthAtomId, kModelNum, kColumnCount };
+    const char * columnNames[kColumnCount] = {
+        "id", "group_pdb", "type_symbol", "label_atom_id", "label_alt_id", "label_comp_id", "label_asym_id",
+        "label_seq_id", "pdbx_pdb_ins_code", "cartn_x", "cartn_y", "cartn_z", "occupancy", "b_iso_or_equiv",
+        "pdbx_formal_charge", "auth_seq_id", "auth_comp_id", "auth_asym_id", "auth_atom_id", "pdbx_pdb_model_num"
+    };
+    const char * atomSitePrefix = "_atom_site.";
+    const size_t atomSitePrefixLen = strlen(atomSitePrefix);
+
+    clearStructure();
+    parsedResidues.clear();
+    const std::string name = baseName(filename);
+    CifTokenizer tokenizer(buffer, bufferSize);
+    const char * token;
+    size_t tokenLen;
+    bool hasBlock = false;
+    bool hasAtoms = false;
+    CifTokenizer::TokenType type = tokenizer.next(token, tokenLen);
+    while (type != CifTokenizer::END) {
+        if (type == CifTokenizer::DATA) {
+            // gemmi reads only the first block, but checks the others for coordinates
+            if (hasBlock) {
+                return false;
+            }
+            hasBlock = true;
+            type = tokenizer.next(token, tokenLen);
+        } else if (type == CifTokenizer::TAG && hasBlock) {
+            const char * tag = token;
+            const size_t tagLen = tokenLen;
+            if (tokenizer.next(token, tokenLen) != CifTokenizer::VALUE
+                || CifTokenizer::startsWith(tag, tagLen, atomSitePrefix)) {
+                return false;
+            }
+            // gemmi compares the tags of pairs case sensitively
+            if (tagLen == 13 && memcmp(tag, "_struct.title", 13) == 0) {
+                CifValue value;
+                value.data = token;
+                value.len = tokenLen;
+                title = value.isNull() ? "" : value.str();
+            }
+            type = tokenizer.next(token, tokenLen);
+        } else if (type == CifTokenizer::LOOP && hasBlock) {
+            std::vector<std::pair<const char *, size_t>> tags;
+            while ((type = tokenizer.next(token, tokenLen)) == CifTokenizer::TAG) {
+                tags.emplace_back(token, tokenLen);
+            }
+            if (tags.empty()) {
+                return false;
+            }
+            if (CifTokenizer::startsWith(tags[0].first, tags[0].second, atomSitePrefix) == false) {
+                for (size_t i = 0; i < tags.size(); i++) {
+                    if (CifTokenizer::startsWith(tags[i].first, tags[i].second, atomSitePrefix)
+                        || CifTokenizer::equals(tags[i].first, tags[i].second, "_struct.title")) {
+                        return false;
+                    }
+                }
+                while (type == CifTokenizer::VALUE) {
+                    type = tokenizer.next(token, tokenLen);
+                }
+                continue;
+            }
+            if (hasAtoms) {
+                return false;
+            }
+            hasAtoms = true;
+
+            int columns[kColumnCount];
+            for (size_t i = 0; i < kColumnCount; i++) {
+                columns[i] = -1;
+                for (size_t j = 0; j < tags.size(); j++) {
+                    if (CifTokenizer::startsWith(tags[j].first, tags[j].second, atomSitePrefix)
+                        && CifTokenizer::equals(tags[j].first + atomSitePrefixLen, tags[j].second - atomSitePrefixLen, columnNames[i])) {
+                        columns[i] = j;
+                        break;
+                    }
+                }
+            }
+            const int required[] = { kId, kSymbol, kAltId, kLabelAsymId, kX, kY, kZ, kOcc, kBiso, kAuthSeqId };
+            for (size_t i = 0; i < sizeof(required) / sizeof(required[0]); i++) {
+                if (columns[required[i]] == -1) {
+                    return false;
+                }
+            }
+            const int asymColumn = columns[kAuthAsymId] != -1 ? columns[kAuthAsymId] : columns[kLabelAsymId];
+            const int compColumn = columns[kAuthCompId] != -1 ? columns[kAuthCompId] : columns[kLabelCompId];
+            const int atomColumn = columns[kAuthAtomId] != -1 ? columns[kAuthAtomId] : columns[kLabelAtomId];
+            if (compColumn == -1 || atomColumn == -1) {
+                return false;
+            }
+
+            std::vector<CifValue> row(tags.size());
+            size_t rowPos = 0;
+            size_t rowCount = 0;
+            std::vector<std::string> modelNames;
+            std::string modelName;
+            bool inChain = false;
+            std::string chainName;
+            std::unordered_map<gemmi::ResidueId, size_t> residueIndex;
+            gemmi::ResidueId residueId;
+            size_t currResidue = SIZE_MAX;
+            // values of the previous row that identify its chain and residue
+            CifValue prevAsym, prevComp, prevSeq, prevInsCode;
+            while (type == CifTokenizer::VALUE) {
+                row[rowPos].data = token;
+                row[rowPos].len = tokenLen;
+                type = tokenizer.next(token, tokenLen);
+                if (++rowPos < row.size()) {
+                    continue;
+                }
+                rowPos = 0;
+                if (rowCount++ == 0) {
+                    modelName = (columns[kModelNum] != -1) ? row[columns[kModelNum]].str() : "1";
+                    modelNames.push_back(modelName);
+                }
+
+                if (columns[kModelNum] != -1 && row[columns[kModelNum]].equals(modelName.c_str(), modelName.size()) == false) {
+                    std::string rowModel = row[columns[kModelNum]].str();
+                    if (std::find(modelNames.begin(), modelNames.end(), rowModel) != modelNames.end()) {
+                        return false;
+                    }
+                    modelNames.push_back(rowModel);
+                    modelName = rowModel;
+                    if (inChain) {
+                        addParsedChain(name, chainName);
+                    }
+                    inChain = false;
+                }
+
+                const CifValue & asym = row[asymColumn];
+                if (!inChain || asym != prevAsym) {
+                    std::string asymName = asym.str();
+                    if (!inChain || asymName != chainName) {
+                        if (inChain) {
+                            addParsedChain(name, chainName);
+                        }
+                        chainName = asymName;
+                        inChain = true;
+                        residueIndex.clear();
+                        currResidue = SIZE_MAX;
+                    }
+                    prevAsym = asym;
+                }
+
+                const CifValue & comp = row[compColumn];
+                const CifValue & seq = row[columns[kAuthSeqId]];
+                const CifValue insCode = (columns[kInsCode] != -1) ? row[columns[kInsCode]] : CifValue();
+                if (currResidue == SIZE_MAX || comp != prevComp || seq != prevSeq || insCode != prevInsCode) {
+                    const std::string insCodeRaw = insCode.raw();
+                    gemmi::ResidueId rid = gemmi::impl::make_resid(comp.str(), seq.str(),
+                                                                   (columns[kInsCode] != -1) ? &insCodeRaw : NULL);
+                    if (currResidue == SIZE_MAX || !residueId.matches(rid)) {
+                        std::unordered_map<gemmi::ResidueId, size_t>::const_iterator it = residueIndex.find(rid);
+                        if (it == residueIndex.end()) {
+                            if (columns[kLabelSeqId] != -1 && !row[columns[kLabelSeqId]].isNull()) {
+                                gemmi::cif::as_int(row[columns[kLabelSeqId]].raw());
+                            }
+                            char hetFlag = '\0';
+                            if (columns[kGroupPdb] != -1 && !row[columns[kGroupPdb]].isNull()) {
+                                // first character could be " or '
+                                const CifValue & group = row[columns[kGroupPdb]];
+                                for (size_t i = 0; i < 2; ++i) {
+                                    const char c = gemmi::alpha_up(i < group.len ? group.data[i] : '\0');
+                                    if (c == 'A' || c == 'H' || c == '\0') {
+                                        hetFlag = c;
+                                    }
+                                }
+                            }
+                            currResidue = parsedResidues.size();
+                            residueIndex.emplace(rid, currResidue);
+                            parsedResidues.emplace_back(toOneLetter(rid.name), hetFlag);
+                        } else {
+                            currResidue = it->second;
+                        }
+                        residueId = rid;
+                    }
+                    prevComp = comp;
+                    prevSeq = seq;
+                    prevInsCode = insCode;
+                }
+
+                // gemmi rejects alternative locations and charges it cannot parse
+                if (row[columns[kAltId]].len > 1) {
+                    gemmi::cif::as_char(row[columns[kAltId]].raw(), '\0');
+                }
+                if (columns[kCharge] != -1 && !row[columns[kCharge]].isNull()) {
+                    const CifValue & charge = row[columns[kCharge]];
+                    if (charge.len != 1 || charge.data[0] < '0' || charge.data[0] > '9') {
+                        gemmi::cif::as_int(charge.raw());
+                    }
+                }
+
+                const CifValue & atom = row[atomColumn];
+                const std::string atomName = atom.isPlain() ? std::string() : atom.str();
+                ParsedResidue & res = parsedResidues[currResidue];
+                Vec3 * pos;
+                if (atom.isPlain() ? atom.equals("CA") : atomName == "CA") {
+                    pos = &res.ca;
+                    res.caBfactor = (float) cifNumber(row[columns[kBiso]], 50.0);
+                } else if (atom.isPlain() ? atom.equals("CB") : atomName == "CB") {
+                    pos = &res.cb;
+                } else if (atom.isPlain() ? atom.equals("N") : atomName == "N") {
+                    pos = &res.n;
+                } else if (atom.isPlain() ? atom.equals("C") : atomName == "C") {
+                    pos = &res.c;
+                } else {
+                    continue;
+                }
+                pos->x = cifNumber(row[columns[kX]]);
+                pos->y = cifNumber(row[columns[kY]]);
+                pos->z = cifNumber(row[columns[kZ]]);
+            }
+            if (rowPos != 0 || rowCount == 0) {
+                return false;
+            }
+            if (inChain) {
+                addParsedChain(name, chainName);
+            }
+        } else {
+            return false;
+        }
+    }
+    return hasAtoms;
+}
@@ -13,12 +13,17 @@ class GemmiWrapper {
 public:
     GemmiWrapper();
 
-    bool loadFromBuffer(const char * buffer, size_t bufferSize, const std::string& name);
+    // fastParsers = false always builds a gemmi::Structure, the regression test compares both paths
+    bool loadFromBuffer(const char * buffer, size_t bufferSize, const std::string& name, bool fastParsers = true);
 
     bool load(std::string & filename);
 
     std::pair<size_t, size_t> nextChain();
 
+    // loads a PDB or mmCIF buffer (format is a gemmi::CoorFormat) only with the fast parsers,
+    // returns false if they do not handle it
+    bool loadFast(const char * buffer, size_t bufferSize, const std::string & filename, int format);
+
     std::vector<Vec3> ca;
     std::vector<float> ca_bfactor;
     std::vector<Vec3> n;
@@ -30,12 +35,35 @@ public:
     std::vector<std::pair<size_t ,size_t>> chain;
     std::string title;
 private:
+    // residue of the chain currently read by the fast PDB and mmCIF parsers
+    struct ParsedResidue {
+        ParsedResidue(char ami, char hetFlag)
+            : ca(NAN, NAN, NAN), cb(NAN, NAN, NAN), n(NAN, NAN, NAN), c(NAN, NAN, NAN),
+              caBfactor(0.0), ami(ami), hetFlag(hetFlag) {}
+        Vec3 ca;
+        Vec3 cb;
+        Vec3 n;
+        Vec3 c;
+        float caBfactor;
+        char ami;
+        char hetFlag;
+    };
+
     std::unordered_map<std::string,char> threeAA2oneAA;
+    std::vector<ParsedResidue> parsedResidues;
     int modelIt;
     int chainIt;
 
     bool loadFoldcompStructure(std::istream& stream, const std::string& filename);
     void updateStructure(void * structure, const std::string & filename);
+
+    // read the coordinates of N, CA, C and CB directly from the text without building a gemmi::Structure
+    // return false if the file uses features they do not handle, the caller then falls back to gemmi
+    bool loadPdbFast(const char * buffer, size_t bufferSize, const std::string & filename);
+    bool loadMmcifFast(const char * buffer, size_t bufferSize, const std::string & filename);
+    void clearStructure();
+    char toOneLetter(const std::string & residueName);
+    void addParsedChain(const std::string & name, const std::string & chainName);
 };
 
 
@@ -12,6 +12,7 @@
 #include "tmalign/TMalign.h"
 #include "TMaligner.h"
 #include "Coordinate16.h"
+#include "MMseqsMPI.h"
 #include <iostream>
 #include <dirent.h>
 
@@ -20,6 +21,7 @@
 #endif
 
 int aln2tmscore(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
     Parameters& par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
@@ -47,9 +49,19 @@ int aln2tmscore(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> alndbr(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     alndbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter dbw(par.db4.c_str(), par.db4Index.c_str(), static_cast<unsigned int>(par.threads), par.compressed, LocalParameters::DBTYPE_TMSCORE);
+    size_t dbFrom = 0;
+    size_t dbSize = alndbr.getSize();
+    std::string outDb = par.db4;
+    std::string outDbIndex = par.db4Index;
+#ifdef HAVE_MPI
+    alndbr.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
+    std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(par.db4, par.db4Index, MMseqsMPI::rank);
+    outDb = tmpOutput.first;
+    outDbIndex = tmpOutput.second;
+#endif
+    DBWriter dbw(outDb.c_str(), outDbIndex.c_str(), static_cast<unsigned int>(par.threads), par.compressed, LocalParameters::DBTYPE_TMSCORE);
     dbw.open();
-    Debug::Progress progress(alndbr.getSize());
+    Debug::Progress progress(dbSize);
 
 
 #pragma omp parallel
@@ -66,7 +78,7 @@ int aln2tmscore(int argc, const char **argv, const Command& command) {
         Coordinate16 tcoords;
 
 #pragma omp for schedule(dynamic, 1000)
-        for (size_t i = 0; i < alndbr.getSize(); i++) {
+        for (size_t i = dbFrom; i < (dbFrom + dbSize); i++) {
             progress.updateProgress();
             unsigned int queryKey = alndbr.getDbKey(i);
             char *data = alndbr.getData(i, thread_idx);
@@ -91,10 +103,11 @@ int aln2tmscore(int argc, const char **argv, const Command& command) {
                 int targetLen = static_cast<int>((tdbr->getEntryLen(targetId)-1)/(3*sizeof(float)));
                 char *tcadata = tdbr->getData(targetId, thread_idx);
                 size_t tCaLength = tdbr->getEntryLen(targetId);
-                float* tdata = tcoords.read(tcadata, targetLen, tCaLength);
+                size_t tStride;
+                float* tdata = tcoords.readAligned(tcadata, targetLen, tCaLength, tStride);
 
                 // Matching residue index collection
-                TMaligner::TMscoreResult tmres = tmaln.computeTMscore(tdata, &tdata[targetLen], &tdata[targetLen + targetLen], targetLen, res.qStartPos,
+                TMaligner::TMscoreResult tmres = tmaln.computeTMscore(tdata, &tdata[tStride], &tdata[tStride + tStride], targetLen, res.qStartPos,
                                      res.dbStartPos, res.backtrace);
 
                 //std::cout << TMalnScore << std::endl;
@@ -133,7 +146,19 @@ int aln2tmscore(int argc, const char **argv, const Command& command) {
             resultsStr.clear();
         }
     }
+#ifdef HAVE_MPI
+    dbw.close(true);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (MMseqsMPI::isMaster()) {
+        std::vector<std::pair<std::string, std::string>> splitFiles;
+        for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
+            splitFiles.push_back(Util::createTmpFileNames(par.db4, par.db4Index, proc));
+        }
+        DBWriter::mergeResults(par.db4, par.db4Index, splitFiles);
+    }
+#else
     dbw.close();
+#endif
 
 
     alndbr.close();
@@ -11,7 +11,7 @@
 #endif
 
 int compressca(int argc, const char **argv, const Command& command) {
-    Parameters& par = Parameters::getInstance();
+    LocalParameters& par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
     std::string caDbData = par.db1 + "_ca";
@@ -25,6 +25,7 @@ int compressca(int argc, const char **argv, const Command& command) {
     DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, LocalParameters::DBTYPE_CA_ALPHA);
     writer.open();
 
+    const bool packed = par.coordStoreMode == LocalParameters::COORD_STORE_MODE_CA_PACKED;
     Debug::Progress progress(caDb.getSize());
 #pragma omp parallel
     {
@@ -44,6 +45,13 @@ int compressca(int argc, const char **argv, const Command& command) {
             unsigned int seqId = seqDb.getId(key);
             size_t chainLen = seqDb.getSeqLen(seqId);
 
+            if (packed) {
+                const float* ca = coords.read(data, chainLen, caDb.getEntryLen(i));
+                if (Coordinate16::convertToPackedDiff(chainLen, ca, ca + chainLen, ca + 2 * chainLen, 1, camol)) {
+                    writer.writeData((const char*)camol.data(), camol.size(), key, thread_idx);
+                    continue;
+                }
+            }
             if (length >= (chainLen * (3 * sizeof(float)))) {
                 camol.resize((chainLen - 1) * 3 * sizeof(int16_t) + 3 * sizeof(float));
                 int16_t* camolf16 = reinterpret_cast<int16_t*>(camol.data());
@@ -7,69 +7,249 @@
 #include "Util.h"
 #include "FileUtil.h"
 #include "Coordinate16.h"
+#include "NumberFormat.h"
+#include "PulchraWrapper.h"
+#include "microtar.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
 
 const char* threeLetterLookup[26] = { "ALA", "ASX", "CYS", "ASP", "GLU", "PHE", "GLY", "HIS", "ILE", "XLE", "LYS", "LEU", "MET", "ASN", "PYL", "PRO", "GLN", "ARG", "SER", "THR", "SEC", "VAL", "TRP", "XAA", "TYR", "GLX" };
+
+// appends the string right aligned to width
+static void appendPadded(std::string &out, const char *begin, const char *end, size_t width) {
+    const size_t length = end - begin;
+    if (length < width) {
+        out.append(width - length, ' ');
+    }
+    out.append(begin, length);
+}
+
+// non-negative numbers get a leading space like with the printf flag ' '
+static void appendInt(std::string &out, int value, size_t width) {
+    char buffer[32];
+    buffer[0] = ' ';
+    char *end = Itoa::i32toa_sse2(value, buffer + (value < 0 ? 0 : 1)) - 1;
+    appendPadded(out, buffer, end, width);
+}
+
+static void appendCoordinate(std::string &out, float value, size_t width) {
+    char buffer[72];
+    buffer[0] = ' ';
+    char *end = NumberFormat::writeFixed3(value, buffer + (std::signbit(value) ? 0 : 1));
+    appendPadded(out, buffer, end, width);
+}
+
+// same columns as "ATOM  % 5d  %s%s A% 4d% 12.3f% 8.3f% 8.3f\n" with a 4 character atom name
+static void appendAtom(std::string &out, int serial, const char *atom, const char *aa3, int residue, float x, float y, float z) {
+    out.append("ATOM  ");
+    appendInt(out, serial, 5);
+    out.append("  ");
+    out.append(atom);
+    out.append(aa3);
+    out.append(" A");
+    appendInt(out, residue, 4);
+    appendCoordinate(out, x, 12);
+    appendCoordinate(out, y, 8);
+    appendCoordinate(out, z, 8);
+    out.push_back('\n');
+}
+
+static void appendTitle(std::string &out, const char *header, size_t headerLen) {
+    char buffer[128];
+    int remainingHeader = headerLen;
+    int written = snprintf(buffer, sizeof(buffer), "TITLE     %.*s\n",  std::min(70, (int)remainingHeader), header);
+    out.append(buffer, written);
+    remainingHeader -= 70;
+    int continuation = 2;
+    while (remainingHeader > 0) {
+        written = snprintf(buffer, sizeof(buffer), "TITLE  % 3d%.*s\n", continuation, std::min(70, (int)remainingHeader), header + (headerLen - remainingHeader));
+        out.append(buffer, written);
+        remainingHeader -= 70;
+        continuation++;
+    }
+}
+
+// file name of an entry in the output directory or tar archive, taken from the header.
+// The key is always appended, since headers do not have to be unique.
+static std::string entryFileName(const char *header, unsigned int key) {
+    std::string name = Util::parseFastaHeader(header);
+    for (size_t i = 0; i < name.size(); ++i) {
+        if (name[i] == '/') {
+            name[i] = '_';
+        }
+    }
+    const std::string suffix = name.empty() ? SSTR(key) : "_" + SSTR(key);
+    // tar headers hold at most 99 characters
+    if (name.size() + suffix.size() > 95) {
+        name.resize(95 - suffix.size());
+    }
+    return name + suffix + ".pdb";
+}
+
 int convert2pdb(int argc, const char **argv, const Command& command) {
-    Parameters& par = Parameters::getInstance();
+    LocalParameters& par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
-    DBReader<unsigned int> db(par.db1.c_str(), par.db1Index.c_str(), 1, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    DBReader<unsigned int> db(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     db.open(DBReader<unsigned int>::NOSORT);
 
-    DBReader<unsigned int> db_header(par.hdr1.c_str(), par.hdr1Index.c_str(), 1, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    DBReader<unsigned int> db_header(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     db_header.open(DBReader<unsigned int>::NOSORT);
 
     std::string dbCa = par.db1 + "_ca";
     std::string dbCaIndex = par.db1 + "_ca.index";
-    DBReader<unsigned int> db_ca(dbCa.c_str(), dbCaIndex.c_str(), 1, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    DBReader<unsigned int> db_ca(dbCa.c_str(), dbCaIndex.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     db_ca.open(DBReader<unsigned int>::NOSORT);
 
-    FILE* handle = fopen(par.db2.c_str(), "w");
-    if(handle == NULL) {
-        perror(par.db2.c_str());
-        EXIT(EXIT_FAILURE);
+    const int mode = par.pdbOutputMode;
+    FILE* handle = NULL;
+    mtar_t tar;
+    if (mode == LocalParameters::PDB_OUTPUT_MODE_FILES) {
+        if (FileUtil::directoryExists(par.db2.c_str()) == false && FileUtil::makeDir(par.db2.c_str()) == false) {
+            Debug(Debug::ERROR) << "Cannot create output directory " << par.db2 << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    } else if (mode == LocalParameters::PDB_OUTPUT_MODE_TAR) {
+        if (mtar_open(&tar, par.db2.c_str(), "w") != MTAR_ESUCCESS) {
+            Debug(Debug::ERROR) << "Cannot open file " << par.db2 << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    } else {
+        handle = fopen(par.db2.c_str(), "w");
+        if (handle == NULL) {
+            perror(par.db2.c_str());
+            EXIT(EXIT_FAILURE);
+        }
     }
 
-    Coordinate16 coords;
     Debug(Debug::INFO) << "Start writing file to " << par.db2 << "\n";
-    for(size_t i = 0; i < db.getSize(); i++){
-        unsigned int key = db.getDbKey(i);
-        unsigned int headerId = db_header.getId(key);
-        const char* headerData = db_header.getData(headerId, 0);
-        const size_t headerLen = db_header.getEntryLen(headerId) - 2;
+    Debug::Progress progress(db.getSize());
+    // entries are formatted in parallel block by block, then written in the order of the input
+    const size_t blockSize = 256 * static_cast<size_t>(par.threads);
+    std::vector<std::string> entries(blockSize);
+    std::vector<std::string> names(mode == LocalParameters::PDB_OUTPUT_MODE_TAR ? blockSize : 0);
+    for (size_t blockStart = 0; blockStart < db.getSize(); blockStart += blockSize) {
+        const size_t blockEnd = std::min(blockStart + blockSize, db.getSize());
+#pragma omp parallel
+        {
+            unsigned int thread_idx = 0;
+#ifdef OPENMP
+            thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+            Coordinate16 coords;
+            PulchraWrapper pulchra;
+            std::vector<Vec3> ca, n, c;
+            std::vector<char> ami;
 
-        unsigned int seqId = db.getId(key);
-        const char* seqData = db.getData(seqId, 0);
-        const size_t seqLen = std::max(db.getEntryLen(seqId), (size_t)2) - 2;
+#pragma omp for schedule(dynamic, 16)
+            for (size_t i = blockStart; i < blockEnd; i++) {
+                progress.updateProgress();
+                std::string &out = entries[i - blockStart];
+                out.clear();
 
-        unsigned int caId = db_ca.getId(key);
-        const char* caData = db_ca.getData(caId, 0);
-        const size_t caLen = db_ca.getEntryLen(caId);
+                unsigned int key = db.getDbKey(i);
+                unsigned int headerId = db_header.getId(key);
+                const char* headerData = db_header.getData(headerId, thread_idx);
+                const size_t headerLen = db_header.getEntryLen(headerId) - 2;
 
-        float* ca = coords.read(caData, seqLen, caLen);
+                const char* seqData = db.getData(i, thread_idx);
+                const size_t seqLen = std::max(db.getEntryLen(i), (size_t)2) - 2;
 
-        fprintf(handle, "MODEL % 8d\n", key);
-        int remainingHeader = headerLen;
-        fprintf(handle, "TITLE     %.*s\n",  std::min(70, (int)remainingHeader), headerData);
-        remainingHeader -= 70;
-        int continuation = 2;
-        while (remainingHeader > 0) {
-            fprintf(handle, "TITLE  % 3d%.*s\n", continuation, std::min(70, (int)remainingHeader), headerData + (headerLen - remainingHeader));
-            remainingHeader -= 70;
-            continuation++;
+                unsigned int caId = db_ca.getId(key);
+                const char* caData = db_ca.getData(caId, thread_idx);
+                const size_t caLen = db_ca.getEntryLen(caId);
+
+                float* caCoords = coords.read(caData, seqLen, caLen);
+
+                if (mode == LocalParameters::PDB_OUTPUT_MODE_MULTIMODEL) {
+                    char buffer[32];
+                    out.append(buffer, snprintf(buffer, sizeof(buffer), "MODEL % 8d\n", key));
+                } else if (mode == LocalParameters::PDB_OUTPUT_MODE_TAR) {
+                    names[i - blockStart] = entryFileName(headerData, key);
+                }
+                appendTitle(out, headerData, headerLen);
+
+                ami.resize(seqLen);
+                for (size_t j = 0; j < seqLen; ++j) {
+                    // make AA upper case
+                    char aa = seqData[j] & ~0x20;
+                    if (aa < 'A' || aa > 'Z') {
+                        aa = 'X';
+                    }
+                    ami[j] = aa;
+                }
+                const float* x = caCoords;
+                const float* y = caCoords + seqLen;
+                const float* z = caCoords + 2 * seqLen;
+                // PULCHRA needs the two neighbours of each residue
+                const bool backbone = par.rebuildBackbone && seqLen > 3;
+                if (backbone) {
+                    ca.resize(seqLen);
+                    n.assign(seqLen, Vec3());
+                    c.assign(seqLen, Vec3());
+                    for (size_t j = 0; j < seqLen; ++j) {
+                        ca[j] = Vec3(x[j], y[j], z[j]);
+                    }
+                    pulchra.rebuildBackbone(ca.data(), n.data(), c.data(), ami.data(), seqLen);
+                }
+                int serial = 1;
+                for (size_t j = 0; j < seqLen; ++j) {
+                    const char* aa3 = threeLetterLookup[(int)(ami[j] - 'A')];
+                    const int residue = (int)(j + 1);
+                    if (backbone) {
+                        appendAtom(out, serial++, "N   ", aa3, residue, n[j].x, n[j].y, n[j].z);
+                    }
+                    appendAtom(out, serial++, "CA  ", aa3, residue, x[j], y[j], z[j]);
+                    if (backbone) {
+                        appendAtom(out, serial++, "C   ", aa3, residue, c[j].x, c[j].y, c[j].z);
+                    }
+                }
+                if (mode == LocalParameters::PDB_OUTPUT_MODE_MULTIMODEL) {
+                    out.append("ENDMDL\n");
+                } else {
+                    out.append("END\n");
+                }
+
+                if (mode == LocalParameters::PDB_OUTPUT_MODE_FILES) {
+                    std::string fileName = par.db2 + "/" + entryFileName(headerData, key);
+                    FILE* entryHandle = fopen(fileName.c_str(), "w");
+                    if (entryHandle == NULL) {
+                        perror(fileName.c_str());
+                        EXIT(EXIT_FAILURE);
+                    }
+                    if (fwrite(out.c_str(), sizeof(char), out.size(), entryHandle) != out.size() || fclose(entryHandle) != 0) {
+                        Debug(Debug::ERROR) << "Cannot write file " << fileName << "\n";
+                        EXIT(EXIT_FAILURE);
+                    }
+                }
+            }
         }
-        for (size_t j = 0; j < seqLen; ++j) {
-            // make AA upper case
-            char aa = seqData[j] & ~0x20;
-            if (aa == '\0') {
-                aa = 'X';
+
+        for (size_t i = 0; i < blockEnd - blockStart; i++) {
+            const std::string &out = entries[i];
+            if (mode == LocalParameters::PDB_OUTPUT_MODE_MULTIMODEL) {
+                if (fwrite(out.c_str(), sizeof(char), out.size(), handle) != out.size()) {
+                    Debug(Debug::ERROR) << "Cannot write file " << par.db2 << "\n";
+                    EXIT(EXIT_FAILURE);
+                }
+            } else if (mode == LocalParameters::PDB_OUTPUT_MODE_TAR) {
+                if (mtar_write_file_header(&tar, names[i].c_str(), out.size()) != MTAR_ESUCCESS
+                    || mtar_write_data(&tar, out.c_str(), out.size()) != MTAR_ESUCCESS) {
+                    Debug(Debug::ERROR) << "Cannot write file " << par.db2 << "\n";
+                    EXIT(EXIT_FAILURE);
+                }
             }
-            const char* aa3 = threeLetterLookup[(int)(aa - 'A')];
-            fprintf(handle, "ATOM  % 5d  CA  %s A% 4d% 12.3f% 8.3f% 8.3f\n", (int)(j + 1), aa3, int(j + 1), ca[j], ca[j + (1 * seqLen)], ca[j + (2 * seqLen)]);
         }
-        fprintf(handle, "ENDMDL\n");
     }
-    if (fclose(handle) != 0) {
+
+    if (mode == LocalParameters::PDB_OUTPUT_MODE_TAR) {
+        if (mtar_write_finalize(&tar) != MTAR_ESUCCESS || mtar_close(&tar) != MTAR_ESUCCESS) {
+            Debug(Debug::ERROR) << "Cannot close file " << par.db2 << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    } else if (handle != NULL && fclose(handle) != 0) {
         Debug(Debug::ERROR) << "Cannot close file " << par.db2 << "\n";
         EXIT(EXIT_FAILURE);
     }
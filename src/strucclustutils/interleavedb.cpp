@@ -0,0 +1,120 @@
+#include "LocalParameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "FileUtil.h"
+#include "Coordinate16.h"
+
+#include <cstdio>
+
+static void writeOrExit(const void *data, size_t length, FILE *file, const std::string &fileName) {
+    if (fwrite(data, sizeof(char), length, file) != length) {
+        Debug(Debug::ERROR) << "Cannot write to file " << fileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+
+// Writes the amino acid, 3Di and C-alpha entries of a structure DB into one data file, each entry
+// holding the three components back to back, with a single index sorted by key:
+// key, offset, entry length, amino acid length, 3Di length, C-alpha length
+// The components keep their DB names (db, db_ss and db_ca) and are read by DBReader from the shared
+// data file through the DBTYPE_EXTENDED_INTERLEAVED flag in their dbtype files.
+int interleavedb(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    DBReader<unsigned int> seqDb(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    seqDb.open(DBReader<unsigned int>::NOSORT);
+
+    std::string ssDbData = par.db1 + "_ss";
+    std::string ssDbIndex = par.db1 + "_ss.index";
+    DBReader<unsigned int> ssDb(ssDbData.c_str(), ssDbIndex.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    ssDb.open(DBReader<unsigned int>::NOSORT);
+
+    std::string caDbData = par.db1 + "_ca";
+    std::string caDbIndex = par.db1 + "_ca.index";
+    DBReader<unsigned int> caDb(caDbData.c_str(), caDbIndex.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    caDb.open(DBReader<unsigned int>::NOSORT);
+
+    if (seqDb.isCompressed() || ssDb.isCompressed() || caDb.isCompressed()) {
+        Debug(Debug::ERROR) << "Compressed databases cannot be interleaved\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    FILE *dataFile = FileUtil::openAndDelete(par.db2.c_str(), "wb");
+    FILE *indexFile = FileUtil::openAndDelete(par.db2Index.c_str(), "w");
+
+    Coordinate16 coords;
+    std::vector<int16_t> camol;
+    char buffer[1024];
+    size_t offset = 0;
+    Debug::Progress progress(seqDb.getSize());
+    for (size_t i = 0; i < seqDb.getSize(); i++) {
+        progress.updateProgress();
+        unsigned int key = seqDb.getDbKey(i);
+        size_t ssId = ssDb.getId(key);
+        size_t caId = caDb.getId(key);
+        if (ssId == UINT_MAX || caId == UINT_MAX) {
+            Debug(Debug::ERROR) << "Entry " << key << " is missing in the 3Di or C-alpha database\n";
+            EXIT(EXIT_FAILURE);
+        }
+
+        size_t seqLength = seqDb.getEntryLen(i);
+        size_t ssLength = ssDb.getEntryLen(ssId);
+        writeOrExit(seqDb.getData(i, 0), seqLength, dataFile, par.db2);
+        writeOrExit(ssDb.getData(ssId, 0), ssLength, dataFile, par.db2);
+
+        // store float (or padded) C-alpha entries with the 16-bit diff encoding of compressca if possible
+        const char *ca = caDb.getData(caId, 0);
+        size_t caLength = caDb.getEntryLen(caId);
+        const size_t chainLen = seqDb.getSeqLen(i);
+        if (chainLen > 1 && caLength > chainLen * 3 * sizeof(float)) {
+            const float *data = coords.read(ca, chainLen, caLength);
+            camol.resize(3 * (chainLen + 1));
+            if (!Coordinate16::convertToDiff16(chainLen, data + 0 * chainLen, camol.data(), 1)
+             && !Coordinate16::convertToDiff16(chainLen, data + 1 * chainLen, camol.data() + 1 * (chainLen + 1), 1)
+             && !Coordinate16::convertToDiff16(chainLen, data + 2 * chainLen, camol.data() + 2 * (chainLen + 1), 1)) {
+                caLength = (chainLen - 1) * 3 * sizeof(uint16_t) + 3 * sizeof(float);
+                writeOrExit(camol.data(), caLength, dataFile, par.db2);
+                // null byte ending the entry
+                writeOrExit("", 1, dataFile, par.db2);
+                caLength += 1;
+            } else {
+                writeOrExit(ca, caLength, dataFile, par.db2);
+            }
+        } else {
+            writeOrExit(ca, caLength, dataFile, par.db2);
+        }
+
+        const size_t length = seqLength + ssLength + caLength;
+        int written = snprintf(buffer, sizeof(buffer), "%u\t%zu\t%zu\t%zu\t%zu\t%zu\n", key, offset, length, seqLength, ssLength, caLength);
+        writeOrExit(buffer, written, indexFile, par.db2Index);
+        offset += length;
+    }
+
+    if (fclose(dataFile) != 0) {
+        Debug(Debug::ERROR) << "Cannot close data file " << par.db2 << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (fclose(indexFile) != 0) {
+        Debug(Debug::ERROR) << "Cannot close index file " << par.db2Index << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    const int interleaved = Parameters::DBTYPE_EXTENDED_INTERLEAVED;
+    // packed entries were written unpacked
+    const int packed = Parameters::DBTYPE_EXTENDED_PACKED << 16;
+    DBWriter::writeDbtypeFile(par.db2.c_str(), DBReader<unsigned int>::setExtendedDbtype(seqDb.getDbtype() & ~packed, interleaved), false);
+    std::string ssOut = par.db2 + "_ss";
+    DBWriter::writeDbtypeFile(ssOut.c_str(), DBReader<unsigned int>::setExtendedDbtype(ssDb.getDbtype() & ~packed, interleaved), false);
+    std::string caOut = par.db2 + "_ca";
+    DBWriter::writeDbtypeFile(caOut.c_str(), DBReader<unsigned int>::setExtendedDbtype(caDb.getDbtype(), interleaved), false);
+    DBReader<unsigned int>::copyDb(par.db1, par.db2, DBFiles::SEQUENCE_ANCILLARY);
+
+    caDb.close();
+    ssDb.close();
+    seqDb.close();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include "LocalParameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "Coordinate16.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Decodes the C-alpha DB of a sequence DB into the padded float layout of Coordinate16,
+// which aligners can use directly from the memory mapped data (e.g. inside a createindex index).
+int makepaddedcadb(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    std::string caDbData = par.db1 + "_ca";
+    std::string caDbIndex = par.db1 + "_ca.index";
+    DBReader<unsigned int> caDb(caDbData.c_str(), caDbIndex.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    caDb.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+
+    DBReader<unsigned int> seqDb(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX);
+    seqDb.open(DBReader<unsigned int>::NOSORT);
+
+    // compressed entries would lose the alignment
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, 0, LocalParameters::DBTYPE_CA_ALPHA);
+    writer.open();
+
+    Debug::Progress progress(caDb.getSize());
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+        Coordinate16 coords;
+        std::vector<char> padded;
+
+#pragma omp for schedule(dynamic, 10)
+        for (size_t i = 0; i < caDb.getSize(); i++) {
+            progress.updateProgress();
+            unsigned int key = caDb.getDbKey(i);
+            char *data = caDb.getData(i, thread_idx);
+            unsigned int seqId = seqDb.getId(key);
+            if (seqId == UINT_MAX) {
+                Debug(Debug::ERROR) << "Entry " << key << " is missing in the sequence database\n";
+                EXIT(EXIT_FAILURE);
+            }
+            size_t chainLen = seqDb.getSeqLen(seqId);
+            float *ca = coords.read(data, chainLen, caDb.getEntryLen(i));
+
+            const size_t stride = Coordinate16::paddedStride(chainLen);
+            // DBWriter adds the final '\0'
+            padded.assign(Coordinate16::paddedEntryLength(chainLen) - 1, 0);
+            for (size_t dim = 0; dim < 3; dim++) {
+                memcpy(padded.data() + dim * stride * sizeof(float), ca + dim * chainLen, chainLen * sizeof(float));
+            }
+            writer.writeData(padded.data(), padded.size(), key, thread_idx);
+        }
+    }
+
+    writer.close(true);
+    seqDb.close();
+    caDb.close();
+
+    return EXIT_SUCCESS;
+}
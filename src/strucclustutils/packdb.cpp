@@ -0,0 +1,81 @@
+#include "LocalParameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "FileUtil.h"
+#include "PackedSequence.h"
+
+#include <cstdio>
+
+// Writes the entries of a sequence DB with 5 bits per residue and a soft mask bitmap (see PackedSequence.h).
+// The index keeps the lengths of the plain entries, so sequence lengths stay available without decoding.
+static void packSequenceDb(const std::string &in, const std::string &out) {
+    std::string inIndex = in + ".index";
+    DBReader<unsigned int> reader(in.c_str(), inIndex.c_str(), 1, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    reader.open(DBReader<unsigned int>::NOSORT);
+    if (reader.isCompressed() || reader.isPacked()) {
+        Debug(Debug::ERROR) << "Database " << in << " is compressed or already packed\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (DBReader<unsigned int>::getExtendedDbtype(FileUtil::parseDbType(in.c_str())) & Parameters::DBTYPE_EXTENDED_INTERLEAVED) {
+        Debug(Debug::ERROR) << "Interleaved database " << in << " cannot be packed\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (Parameters::isEqualDbtype(reader.getDbtype(), Parameters::DBTYPE_AMINO_ACIDS) == false) {
+        Debug(Debug::ERROR) << "Database " << in << " is not an amino acid database\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    std::string outIndex = out + ".index";
+    FILE *dataFile = FileUtil::openAndDelete(out.c_str(), "wb");
+    FILE *indexFile = FileUtil::openAndDelete(outIndex.c_str(), "w");
+
+    std::string packed;
+    char buffer[1024];
+    size_t offset = 0;
+    Debug::Progress progress(reader.getSize());
+    for (size_t i = 0; i < reader.getSize(); i++) {
+        progress.updateProgress();
+        const unsigned int key = reader.getDbKey(i);
+        const size_t length = reader.getSeqLen(i);
+        packed.clear();
+        if (PackedSequence::pack(reader.getData(i, 0), length, packed) == false) {
+            Debug(Debug::ERROR) << "Entry " << key << " of " << in << " contains a residue that cannot be packed\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (fwrite(packed.c_str(), sizeof(char), packed.size(), dataFile) != packed.size()) {
+            Debug(Debug::ERROR) << "Cannot write to data file " << out << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        int written = snprintf(buffer, sizeof(buffer), "%u\t%zu\t%zu\n", key, offset, length + 2);
+        if (fwrite(buffer, sizeof(char), written, indexFile) != static_cast<size_t>(written)) {
+            Debug(Debug::ERROR) << "Cannot write to index file " << outIndex << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        offset += packed.size();
+    }
+
+    if (fclose(dataFile) != 0) {
+        Debug(Debug::ERROR) << "Cannot close data file " << out << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (fclose(indexFile) != 0) {
+        Debug(Debug::ERROR) << "Cannot close index file " << outIndex << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    DBWriter::writeDbtypeFile(out.c_str(), DBReader<unsigned int>::setExtendedDbtype(reader.getDbtype(), Parameters::DBTYPE_EXTENDED_PACKED), false);
+    reader.close();
+}
+
+int packdb(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    packSequenceDb(par.db1, par.db2);
+    packSequenceDb(par.db1 + "_ss", par.db2 + "_ss");
+    DBReader<unsigned int>::copyDb(par.db1 + "_ca", par.db2 + "_ca", DBFiles::GENERIC);
+    DBReader<unsigned int>::copyDb(par.db1, par.db2, DBFiles::SEQUENCE_ANCILLARY);
+
+    return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #include "SubstitutionMatrix.h"
 #include "GemmiWrapper.h"
 #include "PulchraWrapper.h"
+#include "DescriptorFormat.h"
 #include "microtar.h"
 #include "PatternCompiler.h"
 #include "Coordinate16.h"
@@ -71,7 +72,8 @@ size_t
 writeStructureEntry(SubstitutionMatrix & mat, GemmiWrapper & readStructure, StructureTo3Di & structureTo3Di,
                     PulchraWrapper & pulchra, std::vector<char> & alphabet3di, std::vector<char> & alphabetAA,
                     std::vector<int8_t> & camol, std::string & header, std::string & name,
-                    DBWriter & aadbw, DBWriter & hdbw, DBWriter & torsiondbw, DBWriter & cadbw, int chainNameMode,
+                    DBWriter & aadbw, DBWriter & hdbw, DBWriter & torsiondbw, DBWriter & cadbw,
+                    DBWriter * descriptordbw, int descriptorFormat, std::string & descriptor, int chainNameMode,
                     float maskBfactorThreshold, size_t & tooShort, size_t &globalCnt, int thread_idx, int coordStoreMode,
                     std::string & filename,  size_t  &fileidCnt,
                     std::map<std::string, size_t> & entrynameToFileId,
@@ -135,6 +137,12 @@ writeStructureEntry(SubstitutionMatrix & mat, GemmiWrapper & readStructure, Stru
             header.push_back(' ');
             header.append(readStructure.title);
         }
+        if (descriptordbw != NULL) {
+            descriptor.clear();
+            DescriptorFormat::append(descriptor, descriptorFormat, header.c_str(), header.size(), &readStructure.ami[chainStart],
+                                     states, mat.num2aa, structureTo3Di, chainLen);
+            descriptordbw->writeData(descriptor.c_str(), descriptor.size(), dbKey, thread_idx, false);
+        }
         header.push_back('\n');
         std::string entryName = Util::parseFastaHeader(header.c_str());
 #pragma omp critical
@@ -155,7 +163,14 @@ writeStructureEntry(SubstitutionMatrix & mat, GemmiWrapper & readStructure, Stru
         name.clear();
 
         float* camolf32;
-        if (coordStoreMode == LocalParameters::COORD_STORE_MODE_CA_DIFF) {
+        if (coordStoreMode == LocalParameters::COORD_STORE_MODE_CA_PACKED) {
+            const double* ca = (const double*)(readStructure.ca.data() + chainStart);
+            if (Coordinate16::convertToPackedDiff(chainLen, ca + 0, ca + 1, ca + 2, 3, camol)) {
+                cadbw.writeData((const char*)camol.data(), camol.size(), dbKey, thread_idx);
+                goto cleanup;
+            }
+        }
+        if (coordStoreMode == LocalParameters::COORD_STORE_MODE_CA_DIFF || coordStoreMode == LocalParameters::COORD_STORE_MODE_CA_PACKED) {
             camol.resize((chainLen - 1) * 3 * sizeof(int16_t) + 3 * sizeof(float));
             int16_t* camolf16 = reinterpret_cast<int16_t*>(camol.data());
             // check if any of the coordinates is too large to be stored as int16_t
@@ -212,7 +227,20 @@ void sortDatafileByIdOrder(DBWriter & dbw,
     }
 }
 
-
+// rewrites an uncompressed database compressed, optionally with a dictionary trained on its entries
+void compressDb(const std::string &name, int dbtype, int threads, bool dictionary) {
+    DBReader<unsigned int> reader(name.c_str(), (name + ".index").c_str(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+    reader.open(DBReader<unsigned int>::NOSORT);
+    reader.readMmapedDataInMemory();
+    DBWriter writer(name.c_str(), (name + ".index").c_str(), static_cast<unsigned int>(threads), Parameters::WRITER_COMPRESSED_MODE, dbtype);
+    writer.open();
+    if (dictionary) {
+        writer.setDictionary(DBWriter::trainDictionary(reader));
+    }
+    writer.sortDatafileByIdOrder(reader);
+    writer.close(true);
+    reader.close();
+}
 
 int createdb(int argc, const char **argv, const Command& command) {
     LocalParameters& par = LocalParameters::getLocalInstance();
@@ -247,14 +275,19 @@ int createdb(int argc, const char **argv, const Command& command) {
     Debug(Debug::INFO) << "Output file: " << outputName << "\n";
     SORT_PARALLEL(par.filenames.begin(), par.filenames.end());
 
-    DBWriter torsiondbw((outputName+"_ss").c_str(), (outputName+"_ss.index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_AMINO_ACIDS);
+    DBWriter torsiondbw((outputName+"_ss").c_str(), (outputName+"_ss.index").c_str(), static_cast<unsigned int>(par.threads), false, Parameters::DBTYPE_AMINO_ACIDS);
     torsiondbw.open();
-    DBWriter hdbw((outputName+"_h").c_str(), (outputName+"_h.index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter hdbw((outputName+"_h").c_str(), (outputName+"_h.index").c_str(), static_cast<unsigned int>(par.threads), false, Parameters::DBTYPE_GENERIC_DB);
     hdbw.open();
-    DBWriter cadbw((outputName+"_ca").c_str(), (outputName+"_ca.index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, LocalParameters::DBTYPE_CA_ALPHA);
+    DBWriter cadbw((outputName+"_ca").c_str(), (outputName+"_ca.index").c_str(), static_cast<unsigned int>(par.threads), false, LocalParameters::DBTYPE_CA_ALPHA);
     cadbw.open();
-    DBWriter aadbw((outputName).c_str(), (outputName+".index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_AMINO_ACIDS);
+    DBWriter aadbw((outputName).c_str(), (outputName+".index").c_str(), static_cast<unsigned int>(par.threads), false, Parameters::DBTYPE_AMINO_ACIDS);
     aadbw.open();
+    DBWriter* descriptordbw = NULL;
+    if (par.writeDescriptors) {
+        descriptordbw = new DBWriter((outputName+"_3didescriptor").c_str(), (outputName+"_3didescriptor.index").c_str(), static_cast<unsigned int>(par.threads), false, Parameters::DBTYPE_GENERIC_DB);
+        descriptordbw->open();
+    }
     SubstitutionMatrix mat(par.scoringMatrixFile.values.aminoacid().c_str(), 2.0, par.scoreBias);
     Debug::Progress progress(par.filenames.size());
     std::map<std::string, size_t> entrynameToFileId;
@@ -316,7 +349,7 @@ int createdb(int argc, const char **argv, const Command& command) {
         }
 #endif
 
-#pragma omp parallel default(none) shared(tar, par, torsiondbw, hdbw, cadbw, aadbw, mat, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName) num_threads(localThreads) reduction(+:incorrectFiles, tooShort)
+#pragma omp parallel default(none) shared(tar, par, torsiondbw, hdbw, cadbw, aadbw, descriptordbw, mat, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName) num_threads(localThreads) reduction(+:incorrectFiles, tooShort)
         {
             unsigned int thread_idx = 0;
 #ifdef OPENMP
@@ -348,6 +381,7 @@ int createdb(int argc, const char **argv, const Command& command) {
             std::vector<int8_t> camol;
             std::string header;
             std::string name;
+            std::string descriptor;
             std::string pdbFile;
             mtar_header_t tarHeader;
             size_t bufferSize = 1024 * 1024;
@@ -447,6 +481,7 @@ int createdb(int argc, const char **argv, const Command& command) {
                     }
                     writeStructureEntry(mat, readStructure, structureTo3Di, pulchra,
                                         alphabet3di, alphabetAA, camol, header, name, aadbw, hdbw, torsiondbw, cadbw,
+                                        descriptordbw, par.descriptorFormat, descriptor,
                                         par.chainNameMode, par.maskBfactorThreshold, tooShort, globalCnt, thread_idx, par.coordStoreMode,
                                         name, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName);
                 }
@@ -459,7 +494,7 @@ int createdb(int argc, const char **argv, const Command& command) {
 
 
     //===================== single_process ===================//__110710__//
-#pragma omp parallel default(none) shared(par, torsiondbw, hdbw, cadbw, aadbw, mat, looseFiles, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName) reduction(+:incorrectFiles, tooShort)
+#pragma omp parallel default(none) shared(par, torsiondbw, hdbw, cadbw, aadbw, descriptordbw, mat, looseFiles, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName) reduction(+:incorrectFiles, tooShort)
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
@@ -474,6 +509,7 @@ int createdb(int argc, const char **argv, const Command& command) {
         std::vector<int8_t> camol;
         std::string header;
         std::string name;
+        std::string descriptor;
 
 
 #pragma omp for schedule(static)
@@ -487,6 +523,7 @@ int createdb(int argc, const char **argv, const Command& command) {
             // clear memory
             writeStructureEntry(mat, readStructure, structureTo3Di,  pulchra,
                                 alphabet3di, alphabetAA, camol, header, name, aadbw, hdbw, torsiondbw, cadbw,
+                                descriptordbw, par.descriptorFormat, descriptor,
                                 par.chainNameMode, par.maskBfactorThreshold, tooShort, globalCnt, thread_idx, par.coordStoreMode,
                                 looseFiles[i], globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName);
         }
@@ -512,7 +549,7 @@ int createdb(int argc, const char **argv, const Command& command) {
             filter = parts[2][0];
         }
         progress.reset(SIZE_MAX);
-#pragma omp parallel default(none) shared(par, torsiondbw, hdbw, cadbw, aadbw, mat, gcsPaths, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName, client, bucket_name, filter) reduction(+:incorrectFiles, tooShort)
+#pragma omp parallel default(none) shared(par, torsiondbw, hdbw, cadbw, aadbw, descriptordbw, mat, gcsPaths, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName, client, bucket_name, filter) reduction(+:incorrectFiles, tooShort)
         {
             StructureTo3Di structureTo3Di;
             PulchraWrapper pulchra;
@@ -522,11 +559,12 @@ int createdb(int argc, const char **argv, const Command& command) {
             std::vector<int8_t> camol;
             std::string header;
             std::string name;
+            std::string descriptor;
 
 #pragma omp single
             for (auto&& object_metadata : client.ListObjects(bucket_name, gcs::Projection::NoAcl(), gcs::MaxResults(15000))) {
                 std::string obj_name = object_metadata->name();
-#pragma omp task firstprivate(obj_name, alphabet3di, alphabetAA, camol, header, name, filter) private(structureTo3Di, pulchra, readStructure)
+#pragma omp task firstprivate(obj_name, alphabet3di, alphabetAA, camol, header, name, descriptor, filter) private(structureTo3Di, pulchra, readStructure)
                 {
                     bool skipFilter = filter != '\0' && obj_name.length() >= 9 && obj_name[8] == filter;
                     bool allowedSuffix = Util::endsWith(".cif", obj_name) || Util::endsWith(".pdb", obj_name);
@@ -547,6 +585,7 @@ int createdb(int argc, const char **argv, const Command& command) {
                             } else {
                                 writeStructureEntry(mat, readStructure, structureTo3Di,  pulchra,
                                         alphabet3di, alphabetAA, camol, header, name, aadbw, hdbw, torsiondbw, cadbw,
+                                        descriptordbw, par.descriptorFormat, descriptor,
                                         par.chainNameMode, par.maskBfactorThreshold, tooShort, globalCnt, thread_idx, par.coordStoreMode,
                                         obj_name, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName);
                             }
@@ -562,7 +601,7 @@ int createdb(int argc, const char **argv, const Command& command) {
         DBReader<unsigned int> reader(dbs[i].c_str(), (dbs[i]+".index").c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_LOOKUP);
         reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
         progress.reset(reader.getSize());
-#pragma omp parallel default(none) shared(par, torsiondbw, hdbw, cadbw, aadbw, mat, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName, reader) reduction(+:incorrectFiles, tooShort)
+#pragma omp parallel default(none) shared(par, torsiondbw, hdbw, cadbw, aadbw, descriptordbw, mat, progress, globalCnt, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName, reader) reduction(+:incorrectFiles, tooShort)
         {
             StructureTo3Di structureTo3Di;
             PulchraWrapper pulchra;
@@ -572,6 +611,7 @@ int createdb(int argc, const char **argv, const Command& command) {
             std::vector<int8_t> camol;
             std::string header;
             std::string name;
+            std::string descriptor;
 
             std::string dbname = reader.getDataFileName();
 
@@ -594,6 +634,7 @@ int createdb(int argc, const char **argv, const Command& command) {
                 } else {
                     writeStructureEntry(mat, readStructure, structureTo3Di,  pulchra,
                             alphabet3di, alphabetAA, camol, header, name, aadbw, hdbw, torsiondbw, cadbw,
+                            descriptordbw, par.descriptorFormat, descriptor,
                             par.chainNameMode, par.maskBfactorThreshold, tooShort, globalCnt, thread_idx, par.coordStoreMode,
                             dbname, globalFileidCnt, entrynameToFileId, filenameToFileId, fileIdToName);
                 }
@@ -606,6 +647,12 @@ int createdb(int argc, const char **argv, const Command& command) {
     hdbw.close(true);
     cadbw.close(true);
     aadbw.close(true);
+    if (descriptordbw != NULL) {
+        // a flat file like the output of structureto3didescriptor
+        descriptordbw->close(true);
+        FileUtil::remove((outputName+"_3didescriptor.index").c_str());
+        delete descriptordbw;
+    }
 
 
     if(needsReorderingAtTheEnd) {
@@ -648,6 +695,9 @@ int createdb(int argc, const char **argv, const Command& command) {
 
         DBWriter hdbw_reorder((outputName+"_h").c_str(), (outputName+"_h.index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_GENERIC_DB);
         hdbw_reorder.open();
+        if (par.compressed && par.compressDictionary) {
+            hdbw_reorder.setDictionary(DBWriter::trainDictionary(header_reorder));
+        }
         sortDatafileByIdOrder(hdbw_reorder, header_reorder, mappingOrder);
         hdbw_reorder.close(true);
         header_reorder.close();
@@ -657,6 +707,9 @@ int createdb(int argc, const char **argv, const Command& command) {
         torsiondbr_reorder.readMmapedDataInMemory();
         DBWriter torsiondbw_reorder((outputName+"_ss").c_str(), (outputName+"_ss.index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_AMINO_ACIDS);
         torsiondbw_reorder.open();
+        if (par.compressed && par.compressDictionary) {
+            torsiondbw_reorder.setDictionary(DBWriter::trainDictionary(torsiondbr_reorder));
+        }
         sortDatafileByIdOrder(torsiondbw_reorder, torsiondbr_reorder, mappingOrder);
         torsiondbw_reorder.close(true);
         torsiondbr_reorder.close();
@@ -666,6 +719,9 @@ int createdb(int argc, const char **argv, const Command& command) {
         cadbr_reorder.readMmapedDataInMemory();
         DBWriter cadbw_reorder((outputName+"_ca").c_str(), (outputName+"_ca.index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, LocalParameters::DBTYPE_CA_ALPHA);
         cadbw_reorder.open();
+        if (par.compressed && par.compressDictionary) {
+            cadbw_reorder.setDictionary(DBWriter::trainDictionary(cadbr_reorder));
+        }
         sortDatafileByIdOrder(cadbw_reorder, cadbr_reorder, mappingOrder);
         cadbw_reorder.close(true);
         cadbr_reorder.close();
@@ -675,6 +731,9 @@ int createdb(int argc, const char **argv, const Command& command) {
         aadbr_reorder.readMmapedDataInMemory();
         DBWriter aadbw_reorder((outputName).c_str(), (outputName+".index").c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_AMINO_ACIDS);
         aadbw_reorder.open();
+        if (par.compressed && par.compressDictionary) {
+            aadbw_reorder.setDictionary(DBWriter::trainDictionary(aadbr_reorder));
+        }
         sortDatafileByIdOrder(aadbw_reorder, aadbr_reorder, mappingOrder);
         aadbw_reorder.close(true);
         aadbr_reorder.close();
@@ -683,6 +742,14 @@ int createdb(int argc, const char **argv, const Command& command) {
         DBWriter::createRenumberedDB((outputName+"_h").c_str(), (outputName+"_h.index").c_str(), "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
         DBWriter::createRenumberedDB((outputName+"_ca").c_str(), (outputName+"_ca.index").c_str(), "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
         DBWriter::createRenumberedDB((outputName).c_str(), (outputName+".index").c_str(), "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
+        if (par.compressed) {
+            const bool dictionary = par.compressDictionary;
+            Debug(Debug::INFO) << (dictionary ? "Compressing with trained dictionaries\n" : "Compressing\n");
+            compressDb(outputName + "_ss", Parameters::DBTYPE_AMINO_ACIDS, par.threads, dictionary);
+            compressDb(outputName + "_h", Parameters::DBTYPE_GENERIC_DB, par.threads, dictionary);
+            compressDb(outputName + "_ca", LocalParameters::DBTYPE_CA_ALPHA, par.threads, dictionary);
+            compressDb(outputName, Parameters::DBTYPE_AMINO_ACIDS, par.threads, dictionary);
+        }
     }
 
     if (par.writeLookup == true) {
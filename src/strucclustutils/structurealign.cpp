@@ -12,6 +12,13 @@
 #include "TMaligner.h"
 #include "Coordinate16.h"
 #include "LDDT.h"
+#include "MMseqsMPI.h"
+#include "FileUtil.h"
+#include "Timer.h"
+#include "ByteParser.h"
+#include "TimingReport.h"
+
+#include <sys/mman.h>
 
 #ifdef OPENMP
 #include <omp.h>
@@ -34,21 +41,31 @@ int alignStructure(StructureSmithWaterman & structureSmithWaterman,
                    unsigned int querySeqLen, unsigned int targetSeqLen,
                    EvalueNeuralNet & evaluer, std::pair<double, double> muLambda,
                    Matcher::result_t & res, std::string & backtrace,
-                   Parameters & par) {
+                   Parameters & par, AlignmentMap * alnMap = NULL,
+                   TimingReport::Thread * timing = NULL) {
 
     float seqId = 0.0;
     backtrace.clear();
+    if (alnMap != NULL) {
+        alnMap->clear(0, 0);
+    }
     // align only score and end pos
-    StructureSmithWaterman::s_align align = structureSmithWaterman.alignScoreEndPos(tSeqAA.numSequence, tSeq3Di.numSequence, targetSeqLen, par.gapOpen.values.aminoacid(),
-                                                                                    par.gapExtend.values.aminoacid(), querySeqLen / 2);
+    StructureSmithWaterman::s_align align;
+    {
+        TimingReport::Scope scope(timing, TimingReport::SW_SCORE);
+        align = structureSmithWaterman.alignScoreEndPos(tSeqAA.numSequence, tSeq3Di.numSequence, targetSeqLen, par.gapOpen.values.aminoacid(),
+                                                        par.gapExtend.values.aminoacid(), querySeqLen / 2);
+    }
     bool hasLowerCoverage = !(Util::hasCoverage(par.covThr, par.covMode, align.qCov, align.tCov));
     if(hasLowerCoverage){
+        TimingReport::count(timing, TimingReport::COVERAGE_REJECTED);
         return -1;
     }
     StructureSmithWaterman::s_align revAlign;
     if(structureSmithWaterman.isProfileSearch()){
         revAlign.score1 = 0;
     } else {
+        TimingReport::Scope scope(timing, TimingReport::REVERSE_ALIGNMENT);
         revAlign = reverseStructureSmithWaterman.alignScoreEndPos(tSeqAA.numSequence, tSeq3Di.numSequence,
                                                                   targetSeqLen, par.gapOpen.values.aminoacid(),
                                                                   par.gapExtend.values.aminoacid(), querySeqLen / 2);
@@ -57,11 +74,15 @@ int alignStructure(StructureSmithWaterman & structureSmithWaterman,
     align.evalue = evaluer.computeEvalueCorr(score, muLambda.first, muLambda.second);
     bool hasLowerEvalue = align.evalue > par.evalThr;
     if (hasLowerEvalue) {
+        TimingReport::count(timing, TimingReport::EVALUE_REJECTED);
         return -1;
     }
 
-    align = structureSmithWaterman.alignStartPosBacktrace(tSeqAA.numSequence, tSeq3Di.numSequence, targetSeqLen, par.gapOpen.values.aminoacid(),
-                                                          par.gapExtend.values.aminoacid(), par.alignmentMode, backtrace,  align, par.covMode, par.covThr, querySeqLen / 2);
+    {
+        TimingReport::Scope scope(timing, TimingReport::SW_BACKTRACE);
+        align = structureSmithWaterman.alignStartPosBacktrace(tSeqAA.numSequence, tSeq3Di.numSequence, targetSeqLen, par.gapOpen.values.aminoacid(),
+                                                              par.gapExtend.values.aminoacid(), par.alignmentMode, backtrace,  align, par.covMode, par.covThr, querySeqLen / 2, alnMap);
+    }
 
     unsigned int alnLength = Matcher::computeAlnLength(align.qStartPos1, align.qEndPos1, align.dbStartPos1, align.dbEndPos1);
     if(backtrace.size() > 0){
@@ -101,7 +122,179 @@ int computeAlternativeAlignment(StructureSmithWaterman & structureSmithWaterman,
 }
 
 
+// page aligned memory ranges of the entries of reader that belong to the target ids [fromId, toId) of keyReader,
+// entries that are adjacent in memory are merged into one range
+static std::vector<std::pair<char *, size_t>> targetSplitRanges(DBReader<unsigned int> *reader, DBReader<unsigned int> *keyReader,
+                                                               size_t fromId, size_t toId) {
+    std::vector<std::pair<char *, size_t>> ranges;
+    const uintptr_t pageSize = Util::getPageSize();
+    uintptr_t rangeStart = 0;
+    uintptr_t rangeEnd = 0;
+    for (size_t id = fromId; id < toId; id++) {
+        const size_t entryId = (reader == keyReader) ? id : reader->getId(keyReader->getDbKey(id));
+        if (entryId == UINT_MAX) {
+            continue;
+        }
+        const uintptr_t start = reinterpret_cast<uintptr_t>(reader->getDataUncompressed(entryId)) & ~(pageSize - 1);
+        const uintptr_t end = reinterpret_cast<uintptr_t>(reader->getDataUncompressed(entryId)) + reader->getEntryLen(entryId);
+        if (rangeEnd != 0 && start >= rangeStart && start <= rangeEnd) {
+            rangeEnd = std::max(rangeEnd, end);
+            continue;
+        }
+        if (rangeEnd != 0) {
+            ranges.emplace_back(reinterpret_cast<char *>(rangeStart), rangeEnd - rangeStart);
+        }
+        rangeStart = start;
+        rangeEnd = end;
+    }
+    if (rangeEnd != 0) {
+        ranges.emplace_back(reinterpret_cast<char *>(rangeStart), rangeEnd - rangeStart);
+    }
+    return ranges;
+}
+
+// number of prefilter hits for which the target entries are requested ahead of their alignment
+static const int TARGET_PREFETCH_DISTANCE = 16;
+
+// asks the kernel to read the pages of an entry asynchronously, so that a cold mmaped database
+// does not block the alignment on a page fault
+static void prefetchEntry(DBReader<unsigned int> *reader, size_t id) {
+#ifdef HAVE_POSIX_MADVISE
+    static const uintptr_t pageSize = Util::getPageSize();
+    char *data = reader->getDataUncompressed(id);
+    const uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+    const size_t length = reinterpret_cast<uintptr_t>(data) + reader->getEntryLen(id) - start;
+    posix_madvise(reinterpret_cast<void *>(start), length, POSIX_MADV_WILLNEED);
+#endif
+}
+
+// requests the 3Di, amino acid and C-alpha (if tcadbr is not NULL) entries of the hit at data, unless the
+// hit is rejected by its length anyway. Returns the next hit.
+static char *prefetchTarget(char *data, IndexReader *t3DiDbr, IndexReader *tAADbr, IndexReader *tcadbr,
+                            size_t targetFrom, size_t targetTo, Parameters &par, unsigned int queryLen) {
+    const unsigned int dbKey = (unsigned int) strtoul(data, NULL, 10);
+    const size_t targetId = t3DiDbr->sequenceReader->getId(dbKey);
+    if (targetId >= targetFrom && targetId < targetTo
+        && Util::canBeCovered(par.covThr, par.covMode, queryLen, t3DiDbr->sequenceReader->getSeqLen(targetId))) {
+        prefetchEntry(t3DiDbr->sequenceReader, targetId);
+        prefetchEntry(tAADbr->sequenceReader, targetId);
+        if (tcadbr != NULL) {
+            const size_t caId = tcadbr->sequenceReader->getId(dbKey);
+            if (caId != UINT_MAX) {
+                prefetchEntry(tcadbr->sequenceReader, caId);
+            }
+        }
+    }
+    return Util::skipLine(data);
+}
+
+struct SplitHit {
+    SplitHit(const Matcher::result_t &result, const char *data, size_t position)
+            : result(result), data(data), position(position) {}
+    Matcher::result_t result;
+    // text: the line and its length, binary: the block and the record index
+    const char *data;
+    size_t position;
+};
+
+static bool compareSplitHits(const SplitHit &first, const SplitHit &second) {
+    return Matcher::compareHits(first.result, second.result);
+}
+
+static bool compareSplitHitsByStructureBits(const SplitHit &first, const SplitHit &second) {
+    return compareHitsByStructureBits(first.result, second.result);
+}
+
+static int alignmentDbtype(const LocalParameters &par) {
+    if (par.binaryAlignmentDb) {
+        return DBReader<unsigned int>::setExtendedDbtype(Parameters::DBTYPE_ALIGNMENT_RES, Parameters::DBTYPE_EXTENDED_BINARY_ALIGNMENT);
+    }
+    return Parameters::DBTYPE_ALIGNMENT_RES;
+}
+
+// merges the results of all target splits per query and sorts them again (see Prefiltering::mergeTargetSplits).
+// The hits are only parsed for sorting and are copied verbatim, since parsing and writing the text format
+// again would not be exact.
+static void mergeTargetSplits(const std::string &outDb, const std::string &outDbIndex,
+                              const std::vector<std::pair<std::string, std::string>> &fileNames,
+                              LocalParameters &par, bool mergeOutput) {
+    Timer timer;
+    Debug(Debug::INFO) << "Merging " << fileNames.size() << " target splits to " << FileUtil::baseName(outDb) << "\n";
+    std::vector<DBReader<unsigned int> *> readers;
+    for (size_t i = 0; i < fileNames.size(); i++) {
+        DBReader<unsigned int> *reader = new DBReader<unsigned int>(fileNames[i].first.c_str(), fileNames[i].second.c_str(), par.threads,
+                                                                    DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_INDEX);
+        reader->open(DBReader<unsigned int>::NOSORT);
+        readers.push_back(reader);
+    }
+
+    DBWriter writer(outDb.c_str(), outDbIndex.c_str(), static_cast<unsigned int>(par.threads), par.compressed, alignmentDbtype(par));
+    writer.open();
+    Debug::Progress progress(readers[0]->getSize());
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+        std::vector<SplitHit> hits;
+        std::vector<std::pair<const char *, size_t>> records;
+        std::string resultBuffer;
+#pragma omp for schedule(dynamic, 10)
+        for (size_t id = 0; id < readers[0]->getSize(); id++) {
+            progress.updateProgress();
+            // every split contains an entry for every query, the indices are sorted by key
+            for (size_t i = 0; i < readers.size(); i++) {
+                char *data = readers[i]->getData(id, thread_idx);
+                while (*data != '\0') {
+                    if (Matcher::isBinaryResultBlock(data)) {
+                        const size_t count = Matcher::binaryResultCount(data);
+                        for (size_t record = 0; record < count; record++) {
+                            hits.emplace_back(Matcher::parseBinaryRecord(data, record, true), data, record);
+                        }
+                        data = const_cast<char *>(Matcher::skipBinaryResultBlock(data));
+                    } else {
+                        char *next = Util::skipLine(data);
+                        hits.emplace_back(Matcher::parseAlignmentRecord(data, true), data, next - data);
+                        data = next;
+                    }
+                }
+            }
+            if (hits.size() > 1) {
+                if (par.sortByStructureBits) {
+                    SORT_SERIAL(hits.begin(), hits.end(), compareSplitHitsByStructureBits);
+                } else {
+                    SORT_SERIAL(hits.begin(), hits.end(), compareSplitHits);
+                }
+            }
+            if (par.binaryAlignmentDb) {
+                for (size_t i = 0; i < hits.size(); i++) {
+                    records.emplace_back(hits[i].data, hits[i].position);
+                }
+                Matcher::binaryRecordsToBuffer(resultBuffer, records);
+                records.clear();
+            } else {
+                for (size_t i = 0; i < hits.size(); i++) {
+                    resultBuffer.append(hits[i].data, hits[i].position);
+                }
+            }
+            writer.writeData(resultBuffer.c_str(), resultBuffer.length(), readers[0]->getDbKey(id), thread_idx);
+            resultBuffer.clear();
+            hits.clear();
+        }
+    }
+    writer.close(mergeOutput);
+
+    for (size_t i = 0; i < readers.size(); i++) {
+        readers[i]->close();
+        delete readers[i];
+        DBReader<unsigned int>::removeDb(fileNames[i].first);
+    }
+    Debug(Debug::INFO) << "Time for merging target splits: " << timer.lap() << "\n";
+}
+
 int structurealign(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
     LocalParameters &par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_ALIGN);
     if((par.alignmentMode == 1 || par.alignmentMode == 2) && par.sortByStructureBits){
@@ -128,8 +321,21 @@ int structurealign(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter dbw(par.db4.c_str(), par.db4Index.c_str(), static_cast<unsigned int>(par.threads), par.compressed,  Parameters::DBTYPE_ALIGNMENT_RES);
-    dbw.open();
+    size_t dbFrom = 0;
+    size_t dbSize = resultReader.getSize();
+    std::string outDb = par.db4;
+    std::string outDbIndex = par.db4Index;
+#ifdef HAVE_MPI
+    // every rank aligns a range of queries (balanced by result size) into its own split, merged by the master
+    resultReader.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
+    std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(par.db4, par.db4Index, MMseqsMPI::rank);
+    outDb = tmpOutput.first;
+    outDbIndex = tmpOutput.second;
+    // the master merges the output of every rank, which has to be a single data file
+    const bool mergeOutput = true;
+#else
+    const bool mergeOutput = false;
+#endif
 
     bool needTMaligner = (par.tmScoreThr > 0);
     bool needLDDT = (par.lddtThr > 0);
@@ -175,8 +381,35 @@ int structurealign(int argc, const char **argv, const Command& command) {
         }
     }
     SubstitutionMatrix subMatAA(blosum.c_str(), 1.4, par.scoreBias);
-    //temporary output file
-    Debug::Progress progress(resultReader.getSize());
+
+    // Split the target database into consecutive id ranges whose 3Di, amino acid and C-alpha entries
+    // fit into the memory limit. Every split aligns all queries against its targets only and the
+    // results are merged per query at the end.
+    std::vector<std::pair<size_t, size_t>> targetSplits;
+    {
+        const size_t memoryLimit = Util::computeMemory(par.splitMemoryLimit);
+        DBReader<unsigned int> *keyReader = t3DiDbr->sequenceReader;
+        size_t splitFrom = 0;
+        size_t splitBytes = 0;
+        for (size_t id = 0; id < keyReader->getSize(); id++) {
+            size_t entryBytes = keyReader->getEntryLen(id) + tAADbr->sequenceReader->getEntryLen(id);
+            if (needCalpha) {
+                size_t caId = tcadbr->sequenceReader->getId(keyReader->getDbKey(id));
+                entryBytes += (caId != UINT_MAX) ? tcadbr->sequenceReader->getEntryLen(caId) : 0;
+            }
+            if (splitBytes + entryBytes > memoryLimit && id > splitFrom) {
+                targetSplits.emplace_back(splitFrom, id - splitFrom);
+                splitFrom = id;
+                splitBytes = 0;
+            }
+            splitBytes += entryBytes;
+        }
+        targetSplits.emplace_back(splitFrom, keyReader->getSize() - splitFrom);
+        if (targetSplits.size() > 1) {
+            Debug(Debug::INFO) << "Target database does not fit into " << ByteParser::format(memoryLimit)
+                               << ". Aligning against " << targetSplits.size() << " target splits\n";
+        }
+    }
 
     // sub. mat needed for query profile
     int8_t * tinySubMatAA = (int8_t*) mem_align(ALIGN_INT, subMatAA.alphabetSize * 32);
@@ -193,186 +426,291 @@ int structurealign(int argc, const char **argv, const Command& command) {
         }
     }
 
-#pragma omp parallel
-    {
-        unsigned int thread_idx = 0;
-#ifdef OPENMP
-        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
-#endif
-        EvalueNeuralNet evaluer(tAADbr->sequenceReader->getAminoAcidDBSize(), &subMat3Di);
-        std::vector<Matcher::result_t> alignmentResult;
-        StructureSmithWaterman structureSmithWaterman(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
-        StructureSmithWaterman reverseStructureSmithWaterman(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
-        TMaligner *tmaligner = NULL;
-        if(needTMaligner) {
-            tmaligner = new TMaligner(
-                    std::max(qdbr3Di.sequenceReader->getMaxSeqLen() + 1, t3DiDbr->sequenceReader->getMaxSeqLen() + 1), false);
-        }
-        LDDTCalculator *lddtcalculator = NULL;
-        if(needLDDT) {
-            lddtcalculator = new LDDTCalculator(qdbr3Di.sequenceReader->getMaxSeqLen() + 1,  t3DiDbr->sequenceReader->getMaxSeqLen() + 1);
+    TimingReport timing(par.timingReport, par.threads);
+    std::vector<std::pair<std::string, std::string>> splitFiles;
+    for (size_t split = 0; split < targetSplits.size(); split++) {
+        const size_t targetFrom = targetSplits[split].first;
+        const size_t targetTo = targetFrom + targetSplits[split].second;
+        std::string splitDb = outDb;
+        std::string splitDbIndex = outDbIndex;
+        std::vector<std::pair<char *, size_t>> splitRanges;
+        if (targetSplits.size() > 1) {
+            Debug(Debug::INFO) << "Target split " << (split + 1) << " of " << targetSplits.size() << "\n";
+            std::pair<std::string, std::string> splitOutput = Util::createTmpFileNames(outDb, outDbIndex, split);
+            splitDb = splitOutput.first;
+            splitDbIndex = splitOutput.second;
+            splitFiles.push_back(splitOutput);
+
+            DBReader<unsigned int> *keyReader = t3DiDbr->sequenceReader;
+            splitRanges = targetSplitRanges(keyReader, keyReader, targetFrom, targetTo);
+            std::vector<std::pair<char *, size_t>> aaRanges = targetSplitRanges(tAADbr->sequenceReader, keyReader, targetFrom, targetTo);
+            splitRanges.insert(splitRanges.end(), aaRanges.begin(), aaRanges.end());
+            if (needCalpha) {
+                std::vector<std::pair<char *, size_t>> caRanges = targetSplitRanges(tcadbr->sequenceReader, keyReader, targetFrom, targetTo);
+                splitRanges.insert(splitRanges.end(), caRanges.begin(), caRanges.end());
+            }
+            // only the targets of the current split are loaded into memory
+            if (touch) {
+                for (size_t i = 0; i < splitRanges.size(); i++) {
+                    Util::touchMemory(splitRanges[i].first, splitRanges[i].second);
+                }
+            }
         }
-        Sequence qSeqAA(par.maxSeqLen, qdbrAA.getDbtype(), (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
-        Sequence qSeq3Di(par.maxSeqLen, qdbr3Di.getDbtype(), (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
-        Sequence tSeqAA(par.maxSeqLen, Parameters::DBTYPE_AMINO_ACIDS, (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
-        Sequence tSeq3Di(par.maxSeqLen, Parameters::DBTYPE_AMINO_ACIDS, (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
-        std::string backtrace;
-        char buffer[1024+32768];
-        std::string resultBuffer;
 
-        Coordinate16 qcoords;
-        Coordinate16 tcoords;
+        DBWriter dbw(splitDb.c_str(), splitDbIndex.c_str(), static_cast<unsigned int>(par.threads), par.compressed, alignmentDbtype(par));
+        dbw.open();
+        Debug::Progress progress(dbSize);
 
-        TMaligner::TMscoreResult tmres;
-        LDDTCalculator::LDDTScoreResult lddtres;
-        // write output file
+#pragma omp parallel
+        {
+            unsigned int thread_idx = 0;
+#ifdef OPENMP
+            thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+            TimingReport::Thread *threadTiming = timing.thread(thread_idx);
+            EvalueNeuralNet evaluer(tAADbr->sequenceReader->getAminoAcidDBSize(), &subMat3Di);
+            std::vector<Matcher::result_t> alignmentResult;
+            StructureSmithWaterman structureSmithWaterman(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
+            StructureSmithWaterman reverseStructureSmithWaterman(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
+            TMaligner *tmaligner = NULL;
+            if(needTMaligner) {
+                tmaligner = new TMaligner(
+                        std::max(qdbr3Di.sequenceReader->getMaxSeqLen() + 1, t3DiDbr->sequenceReader->getMaxSeqLen() + 1), false);
+            }
+            LDDTCalculator *lddtcalculator = NULL;
+            if(needLDDT) {
+                lddtcalculator = new LDDTCalculator(qdbr3Di.sequenceReader->getMaxSeqLen() + 1,  t3DiDbr->sequenceReader->getMaxSeqLen() + 1);
+            }
+            Sequence qSeqAA(par.maxSeqLen, qdbrAA.getDbtype(), (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
+            Sequence qSeq3Di(par.maxSeqLen, qdbr3Di.getDbtype(), (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
+            Sequence tSeqAA(par.maxSeqLen, Parameters::DBTYPE_AMINO_ACIDS, (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
+            Sequence tSeq3Di(par.maxSeqLen, Parameters::DBTYPE_AMINO_ACIDS, (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
+            std::string backtrace;
+            AlignmentMap alnMap;
+            char buffer[1024+32768];
+            std::string resultBuffer;
+
+            Coordinate16 qcoords;
+            Coordinate16 tcoords;
+
+            TMaligner::TMscoreResult tmres;
+            LDDTCalculator::LDDTScoreResult lddtres;
+            // write output file
 
 #pragma omp for schedule(dynamic, 1)
-        for (size_t id = 0; id < resultReader.getSize(); id++) {
-            progress.updateProgress();
-            char *data = resultReader.getData(id, thread_idx);
-            size_t queryKey = resultReader.getDbKey(id);
-            if(*data != '\0') {
-                unsigned int queryId = qdbr3Di.sequenceReader->getId(queryKey);
-
-                char *querySeqAA = qdbrAA.sequenceReader->getData(queryId, thread_idx);
-                char *querySeq3Di = qdbr3Di.sequenceReader->getData(queryId, thread_idx);
-                unsigned int querySeqLen = qdbr3Di.sequenceReader->getSeqLen(queryId);
-                qSeq3Di.mapSequence(id, queryKey, querySeq3Di, querySeqLen);
-                qSeqAA.mapSequence(id, queryKey, querySeqAA, querySeqLen);
-                if(needCalpha){
-                    size_t qId = qcadbr->sequenceReader->getId(queryKey);
-                    char *qcadata = qcadbr->sequenceReader->getData(qId, thread_idx);
-                    size_t qCaLength = qcadbr->sequenceReader->getEntryLen(qId);
-                    float* queryCaData = qcoords.read(qcadata, qSeq3Di.L, qCaLength);
-                    if(needTMaligner){
-                        tmaligner->initQuery(queryCaData, &queryCaData[qSeq3Di.L], &queryCaData[qSeq3Di.L+qSeq3Di.L], NULL, qSeq3Di.L);
-                    }
-                    if(needLDDT){
-                        lddtcalculator->initQuery(qSeq3Di.L, queryCaData, &queryCaData[qSeq3Di.L], &queryCaData[qSeq3Di.L+qSeq3Di.L]);
-                    }
+            for (size_t id = dbFrom; id < (dbFrom + dbSize); id++) {
+                progress.updateProgress();
+                char *data;
+                {
+                    TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                    data = resultReader.getData(id, thread_idx);
                 }
-                std::pair<double, double> muLambda = evaluer.predictMuLambda(qSeq3Di.numSequence, qSeq3Di.L);
-                structureSmithWaterman.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
-                qSeq3Di.reverse();
-                qSeqAA.reverse();
-                reverseStructureSmithWaterman.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
-                int passedNum = 0;
-                int rejected = 0;
-                while (*data != '\0' && passedNum < par.maxAccept && rejected < par.maxRejected) {
-                    char dbKeyBuffer[255 + 1];
-                    Util::parseKey(data, dbKeyBuffer);
-                    data = Util::skipLine(data);
-                    const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
-                    unsigned int targetId = t3DiDbr->sequenceReader->getId(dbKey);
-                    const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameDB))? true : false;
-
-                    char * targetSeq3Di = t3DiDbr->sequenceReader->getData(targetId, thread_idx);
-                    char * targetSeqAA = tAADbr->sequenceReader->getData(targetId, thread_idx);
-                    const int targetSeqLen = static_cast<int>(t3DiDbr->sequenceReader->getSeqLen(targetId));
-
-                    tSeq3Di.mapSequence(targetId, dbKey, targetSeq3Di, targetSeqLen);
-                    tSeqAA.mapSequence(targetId, dbKey, targetSeqAA, targetSeqLen);
-                    if(Util::canBeCovered(par.covThr, par.covMode, qSeq3Di.L, targetSeqLen) == false){
-                        rejected++;
-                        continue;
+                size_t queryKey = resultReader.getDbKey(id);
+                if(*data != '\0') {
+                    unsigned int queryId = qdbr3Di.sequenceReader->getId(queryKey);
+                    unsigned int querySeqLen = qdbr3Di.sequenceReader->getSeqLen(queryId);
+                    {
+                        TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                        qSeq3Di.mapSequence(id, queryKey, *qdbr3Di.sequenceReader, queryId, thread_idx);
+                        qSeqAA.mapSequence(id, queryKey, *qdbrAA.sequenceReader, queryId, thread_idx);
                     }
-                    Matcher::result_t res;
-                    if(alignStructure(structureSmithWaterman, reverseStructureSmithWaterman,
-                                      tSeqAA, tSeq3Di, querySeqLen, targetSeqLen,
-                                      evaluer, muLambda, res, backtrace, par) == -1){
-                        rejected++;
-                        continue;
+                    if(needCalpha){
+                        size_t qId = qcadbr->sequenceReader->getId(queryKey);
+                        char *qcadata = qcadbr->sequenceReader->getData(qId, thread_idx);
+                        size_t qCaLength = qcadbr->sequenceReader->getEntryLen(qId);
+                        float* queryCaData;
+                        {
+                            TimingReport::Scope scope(threadTiming, TimingReport::COORD_DECODE);
+                            queryCaData = qcoords.read(qcadata, qSeq3Di.L, qCaLength);
+                        }
+                        if(needTMaligner){
+                            tmaligner->initQuery(queryCaData, &queryCaData[qSeq3Di.L], &queryCaData[qSeq3Di.L+qSeq3Di.L], NULL, qSeq3Di.L);
+                        }
+                        if(needLDDT){
+                            lddtcalculator->initQuery(qSeq3Di.L, queryCaData, &queryCaData[qSeq3Di.L], &queryCaData[qSeq3Di.L+qSeq3Di.L]);
+                        }
+                    }
+                    std::pair<double, double> muLambda = evaluer.predictMuLambda(qSeq3Di.numSequence, qSeq3Di.L);
+                    structureSmithWaterman.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
+                    qSeq3Di.reverse();
+                    qSeqAA.reverse();
+                    reverseStructureSmithWaterman.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
+                    int passedNum = 0;
+                    int rejected = 0;
+                    // the targets of the next hits are read in while the current one is aligned
+                    char *prefetchData = data;
+                    for (int i = 0; i < TARGET_PREFETCH_DISTANCE && *prefetchData != '\0'; i++) {
+                        prefetchData = prefetchTarget(prefetchData, t3DiDbr, tAADbr, tcadbr, targetFrom, targetTo, par, qSeq3Di.L);
                     }
+                    while (*data != '\0' && passedNum < par.maxAccept && rejected < par.maxRejected) {
+                        if (*prefetchData != '\0') {
+                            prefetchData = prefetchTarget(prefetchData, t3DiDbr, tAADbr, tcadbr, targetFrom, targetTo, par, qSeq3Di.L);
+                        }
+                        char dbKeyBuffer[255 + 1];
+                        Util::parseKey(data, dbKeyBuffer);
+                        data = Util::skipLine(data);
+                        const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+                        unsigned int targetId = t3DiDbr->sequenceReader->getId(dbKey);
+                        // hits to other target splits are neither accepted nor rejected
+                        if (targetId < targetFrom || targetId >= targetTo) {
+                            continue;
+                        }
+                        TimingReport::count(threadTiming, TimingReport::PREFILTER_HITS);
+                        const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameDB))? true : false;
+
+                        // the length is known from the index, the target data is only read if the hit can be covered
+                        const int targetSeqLen = static_cast<int>(t3DiDbr->sequenceReader->getSeqLen(targetId));
+                        if(Util::canBeCovered(par.covThr, par.covMode, qSeq3Di.L, targetSeqLen) == false){
+                            TimingReport::count(threadTiming, TimingReport::COVERAGE_REJECTED);
+                            rejected++;
+                            continue;
+                        }
+                        {
+                            TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                            tSeq3Di.mapSequence(targetId, dbKey, *t3DiDbr->sequenceReader, targetId, thread_idx);
+                            tSeqAA.mapSequence(targetId, dbKey, *tAADbr->sequenceReader, targetId, thread_idx);
+                        }
+                        Matcher::result_t res;
+                        if(alignStructure(structureSmithWaterman, reverseStructureSmithWaterman,
+                                          tSeqAA, tSeq3Di, querySeqLen, targetSeqLen,
+                                          evaluer, muLambda, res, backtrace, par, &alnMap, threadTiming) == -1){
+                            rejected++;
+                            continue;
+                        }
 
-                    if (Alignment::checkCriteria(res, isIdentity, par.evalThr, par.seqIdThr, par.alnLenThr, par.covMode, par.covThr)) {
-                        if(needCalpha) {
-                            size_t tId = tcadbr->sequenceReader->getId(res.dbKey);
-                            char *tcadata = tcadbr->sequenceReader->getData(tId, thread_idx);
-                            size_t tCaLength = tcadbr->sequenceReader->getEntryLen(tId);
-                            float* targetCaData = tcoords.read(tcadata, res.dbLen, tCaLength);
-                            if(needTMaligner) {
-                                tmres = tmaligner->computeTMscore(targetCaData,
-                                                                  &targetCaData[res.dbLen],
-                                                                  &targetCaData[res.dbLen +
-                                                                                res.dbLen],
-                                                                  res.dbLen,
-                                                                  res.qStartPos,
-                                                                  res.dbStartPos,
-                                                                          res.backtrace);
-                                if (tmres.tmscore < par.tmScoreThr) {
-                                    continue;
+                        if (Alignment::checkCriteria(res, isIdentity, par.evalThr, par.seqIdThr, par.alnLenThr, par.covMode, par.covThr)) {
+                            if(needCalpha) {
+                                size_t tId = tcadbr->sequenceReader->getId(res.dbKey);
+                                char *tcadata = tcadbr->sequenceReader->getData(tId, thread_idx);
+                                size_t tCaLength = tcadbr->sequenceReader->getEntryLen(tId);
+                                size_t tStride;
+                                float* targetCaData;
+                                {
+                                    TimingReport::Scope scope(threadTiming, TimingReport::COORD_DECODE);
+                                    targetCaData = tcoords.readAligned(tcadata, res.dbLen, tCaLength, tStride);
+                                }
+                                if(needTMaligner) {
+                                    {
+                                        TimingReport::Scope scope(threadTiming, TimingReport::TMSCORE);
+                                        tmres = tmaligner->computeTMscore(targetCaData,
+                                                                          &targetCaData[tStride],
+                                                                          &targetCaData[tStride +
+                                                                                        tStride],
+                                                                          res.dbLen,
+                                                                          alnMap);
+                                    }
+                                    if (tmres.tmscore < par.tmScoreThr) {
+                                        TimingReport::count(threadTiming, TimingReport::THRESHOLD_REJECTED);
+                                        continue;
+                                    }
+                                }
+                                if(needLDDT){
+                                    {
+                                        TimingReport::Scope scope(threadTiming, TimingReport::LDDT);
+                                        lddtres = lddtcalculator->computeLDDTScore(res.dbLen, alnMap,
+                                                                                   targetCaData, &targetCaData[tStride],
+                                                                                   &targetCaData[tStride+tStride]);
+                                    }
+
+                                    if(lddtres.avgLddtScore < par.lddtThr){
+                                        TimingReport::count(threadTiming, TimingReport::THRESHOLD_REJECTED);
+                                        continue;
+                                    }
+                                    res.dbcov = lddtres.avgLddtScore;
+                                }
+                                if(par.sortByStructureBits && needTMaligner && needLDDT){
+                                    res.score = res.score * sqrt(lddtres.avgLddtScore * tmres.tmscore);
                                 }
                             }
-                            if(needLDDT){
-                                lddtres = lddtcalculator->computeLDDTScore(res.dbLen, res.qStartPos, res.dbStartPos,
-                                                                           res.backtrace,
-                                                                           targetCaData, &targetCaData[res.dbLen],
-                                                                           &targetCaData[res.dbLen+res.dbLen]);
 
-                                if(lddtres.avgLddtScore < par.lddtThr){
+
+                            TimingReport::count(threadTiming, TimingReport::ACCEPTED);
+                            alignmentResult.emplace_back(res);
+                            int altAli = par.altAlignment;
+                            bool moreAltAli = true;
+                            while(altAli && moreAltAli){
+                                Matcher::result_t altRes;
+                                if(computeAlternativeAlignment(structureSmithWaterman, reverseStructureSmithWaterman,
+                                                               tSeqAA, tSeq3Di, querySeqLen, targetSeqLen,
+                                                               evaluer, muLambda, res, altRes,
+                                                               backtrace, par) == -1) {
+                                    moreAltAli = false;
                                     continue;
                                 }
-                                res.dbcov = lddtres.avgLddtScore;
-                            }
-                            if(par.sortByStructureBits && needTMaligner && needLDDT){
-                                res.score = res.score * sqrt(lddtres.avgLddtScore * tmres.tmscore);
+                                alignmentResult.push_back(altRes);
+                                res = altRes;
+                                altAli--;
                             }
+                            passedNum++;
+                            rejected = 0;
+                        } else {
+                            TimingReport::count(threadTiming, TimingReport::THRESHOLD_REJECTED);
+                            rejected++;
                         }
+                    }
+                }
 
 
-                        alignmentResult.emplace_back(res);
-                        int altAli = par.altAlignment;
-                        bool moreAltAli = true;
-                        while(altAli && moreAltAli){
-                            Matcher::result_t altRes;
-                            if(computeAlternativeAlignment(structureSmithWaterman, reverseStructureSmithWaterman,
-                                                           tSeqAA, tSeq3Di, querySeqLen, targetSeqLen,
-                                                           evaluer, muLambda, res, altRes,
-                                                           backtrace, par) == -1) {
-                                moreAltAli = false;
-                                continue;
-                            }
-                            alignmentResult.push_back(altRes);
-                            res = altRes;
-                            altAli--;
+                {
+                    TimingReport::Scope scope(threadTiming, TimingReport::OUTPUT_FORMAT);
+                    if (alignmentResult.size() > 1) {
+                        if(par.sortByStructureBits) {
+                            SORT_SERIAL(alignmentResult.begin(), alignmentResult.end(), compareHitsByStructureBits);
+                        } else {
+                            SORT_SERIAL(alignmentResult.begin(), alignmentResult.end(), Matcher::compareHits);
                         }
-                        passedNum++;
-                        rejected = 0;
+                    }
+                    if (par.binaryAlignmentDb) {
+                        Matcher::resultsToBinaryBuffer(resultBuffer, alignmentResult, par.addBacktrace);
                     } else {
-                        rejected++;
+                        for (size_t result = 0; result < alignmentResult.size(); result++) {
+                            size_t len = Matcher::resultToBuffer(buffer, alignmentResult[result], par.addBacktrace);
+                            resultBuffer.append(buffer, len);
+                        }
                     }
                 }
-            }
-
-
-            if (alignmentResult.size() > 1) {
-                if(par.sortByStructureBits) {
-                    SORT_SERIAL(alignmentResult.begin(), alignmentResult.end(), compareHitsByStructureBits);
-                } else {
-                    SORT_SERIAL(alignmentResult.begin(), alignmentResult.end(), Matcher::compareHits);
+                {
+                    TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                    dbw.writeData(resultBuffer.c_str(), resultBuffer.length(), queryKey, thread_idx);
                 }
+                resultBuffer.clear();
+                alignmentResult.clear();
             }
-            for (size_t result = 0; result < alignmentResult.size(); result++) {
-                size_t len = Matcher::resultToBuffer(buffer, alignmentResult[result], par.addBacktrace);
-                resultBuffer.append(buffer, len);
+            if(needTMaligner){
+                delete tmaligner;
+            }
+            if(needLDDT){
+                delete lddtcalculator;
             }
-            dbw.writeData(resultBuffer.c_str(), resultBuffer.length(), queryKey, thread_idx);
-            resultBuffer.clear();
-            alignmentResult.clear();
-        }
-        if(needTMaligner){
-            delete tmaligner;
         }
-        if(needLDDT){
-            delete lddtcalculator;
+
+        dbw.close(targetSplits.size() == 1 && mergeOutput);
+        // release the pages of this split before the next one is loaded
+#ifdef MADV_DONTNEED
+        for (size_t i = 0; i < splitRanges.size(); i++) {
+            madvise(splitRanges[i].first, splitRanges[i].second, MADV_DONTNEED);
         }
+#endif
     }
 
     free(tinySubMatAA);
     free(tinySubMat3Di);
+    timing.write("structurealign");
+
+    if (targetSplits.size() > 1) {
+        mergeTargetSplits(outDb, outDbIndex, splitFiles, par, mergeOutput);
+    }
 
-    dbw.close();
+#ifdef HAVE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (MMseqsMPI::isMaster()) {
+        std::vector<std::pair<std::string, std::string>> rankFiles;
+        for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
+            rankFiles.push_back(Util::createTmpFileNames(par.db4, par.db4Index, proc));
+        }
+        DBWriter::mergeResults(par.db4, par.db4Index, rankFiles);
+    }
+#endif
     resultReader.close();
 
     if(needCalpha){
@@ -13,6 +13,10 @@
 #include "NcbiTaxonomy.h"
 #include "MappingReader.h"
 #include "Coordinate16.h"
+#include "AlignmentMap.h"
+#include "TimingReport.h"
+#include "NumberFormat.h"
+#include "ColumnarFormat.h"
 
 #define ZSTD_STATIC_LINKING_ONLY
 
@@ -80,51 +84,42 @@ const char *singleLetterToThree(char singleLetterAminoacid) {
 
 
 
-void caToStr(float *ca, size_t len, std::string & ret) {
+void caToStr(float *ca, size_t len, size_t stride, std::string & ret) {
     for (size_t i = 0; i < len; i++) {
-        ret.append(SSTR(ca[i]));
+        NumberFormat::append(ret, ca[i]);
         ret.push_back(',');
-        ret.append(SSTR(ca[len+i]));
+        NumberFormat::append(ret, ca[stride+i]);
         ret.push_back(',');
-        ret.append(SSTR(ca[2*len+i]));
+        NumberFormat::append(ret, ca[2*stride+i]);
         ret.push_back(',');
     }
 }
 
 void structurePrintSeqBasedOnAln(std::string &out, const char *seq, unsigned int offset,
-                        const std::string &bt, bool reverse, bool isReverseStrand,
+                        const AlignmentMap &alnMap, bool reverse, bool isReverseStrand,
                         bool translateSequence, const TranslateNucl &translateNucl) {
     unsigned int seqPos = 0;
     char codon[3];
-    for (uint32_t i = 0; i < bt.size(); ++i) {
-        char seqChar = (isReverseStrand == true) ? Orf::complement(seq[offset - seqPos]) : seq[offset + seqPos];
-        if (translateSequence) {
-            codon[0] = (isReverseStrand == true) ? Orf::complement(seq[offset - seqPos])     : seq[offset + seqPos];
-            codon[1] = (isReverseStrand == true) ? Orf::complement(seq[offset - (seqPos+1)]) : seq[offset + (seqPos+1)];
-            codon[2] = (isReverseStrand == true) ? Orf::complement(seq[offset - (seqPos+2)]) : seq[offset + (seqPos+2)];
-            seqChar = translateNucl.translateSingleCodon(codon);
+    for (size_t run = 0; run < alnMap.runs.size(); ++run) {
+        const char op = alnMap.runs[run].op;
+        // gap columns of the printed sequence
+        if ((op == 'I' && reverse == true) || (op == 'D' && reverse == false)) {
+            out.append(alnMap.runs[run].length, '-');
+            continue;
         }
-        switch (bt[i]) {
-            case 'M':
-                out.append(1, seqChar);
-                seqPos += (translateSequence) ?  3 : 1;
-                break;
-            case 'I':
-                if (reverse == true) {
-                    out.append(1, '-');
-                } else {
-                    out.append(1, seqChar);
-                    seqPos += (translateSequence) ?  3 : 1;
-                }
-                break;
-            case 'D':
-                if (reverse == true) {
-                    out.append(1, seqChar);
-                    seqPos += (translateSequence) ?  3 : 1;
-                } else {
-                    out.append(1, '-');
-                }
-                break;
+        if (op != 'M' && op != 'I' && op != 'D') {
+            continue;
+        }
+        for (uint32_t i = 0; i < alnMap.runs[run].length; ++i) {
+            char seqChar = (isReverseStrand == true) ? Orf::complement(seq[offset - seqPos]) : seq[offset + seqPos];
+            if (translateSequence) {
+                codon[0] = (isReverseStrand == true) ? Orf::complement(seq[offset - seqPos])     : seq[offset + seqPos];
+                codon[1] = (isReverseStrand == true) ? Orf::complement(seq[offset - (seqPos+1)]) : seq[offset + (seqPos+1)];
+                codon[2] = (isReverseStrand == true) ? Orf::complement(seq[offset - (seqPos+2)]) : seq[offset + (seqPos+2)];
+                seqChar = translateNucl.translateSingleCodon(codon);
+            }
+            out.append(1, seqChar);
+            seqPos += (translateSequence) ?  3 : 1;
         }
     }
 }
@@ -370,6 +365,19 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
     const bool isDb = par.dbOut;
     TranslateNucl translateNucl(static_cast<TranslateNucl::GenCode>(par.translationTable));
 
+    if (format == LocalParameters::FORMAT_ALIGNMENT_COLUMNAR) {
+        if (isDb) {
+            Debug(Debug::ERROR) << "Columnar output cannot be written as a database (--db-output)\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (outcodes.empty()) {
+            Debug(Debug::ERROR) << "Columnar output needs the columns in --format-output\n";
+            EXIT(EXIT_FAILURE);
+        }
+        std::string header = ColumnarFormat::header(outcodes, Util::split(par.outfmt, ","));
+        resultWriter.writeData(header.c_str(), header.length(), 0, 0, false, false);
+    }
+
     if (format == Parameters::FORMAT_ALIGNMENT_SAM) {
         char buffer[1024];
         unsigned int lastKey = tDbr->sequenceReader->getLastKey();
@@ -381,10 +389,10 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
 
         for (size_t i = 0; i < alnDbr.getSize(); i++) {
             char *data = alnDbr.getData(i, 0);
-            while (*data != '\0') {
-                char dbKeyBuffer[255 + 1];
-                Util::parseKey(data, dbKeyBuffer);
-                const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+            std::vector<Matcher::result_t> alnResults;
+            Matcher::readAlignmentResults(alnResults, data, true);
+            for (size_t resIdx = 0; resIdx < alnResults.size(); resIdx++) {
+                const unsigned int dbKey = alnResults[resIdx].dbKey;
                 if (headerWritten[dbKey] == false) {
                     headerWritten[dbKey] = true;
                     unsigned int tId = tDbr->sequenceReader->getId(dbKey);
@@ -401,7 +409,6 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                     resultWriter.writeAdd(buffer, count, 0);
                 }
                 resultWriter.writeEnd(0, 0, false, 0);
-                data = Util::skipLine(data);
             }
         }
         delete[] headerWritten;
@@ -425,12 +432,14 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
     }
 
     Debug::Progress progress(alnDbr.getSize());
+    TimingReport timing(par.timingReport, localThreads);
 #pragma omp parallel num_threads(localThreads)
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
 #endif
+        TimingReport::Thread *threadTiming = timing.thread(thread_idx);
         char buffer[1024];
 
         TMaligner *tmaligner = NULL;
@@ -449,6 +458,9 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
         std::string caStr;
         caStr.reserve(1024*1024);
 
+        std::vector<Matcher::result_t> alnResults;
+        alnResults.reserve(300);
+
         std::string queryProfData;
         queryProfData.reserve(1024);
 
@@ -469,6 +481,8 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
 
         Coordinate16 qcoords;
         Coordinate16 tcoords;
+        AlignmentMap alnMap;
+        ColumnarFormat::RowGroup rowGroup(outcodes);
 
 #pragma omp  for schedule(dynamic, 10)
         for (size_t i = 0; i < alnDbr.getSize(); i++) {
@@ -482,7 +496,7 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                 size_t qId = qDbr.sequenceReader->getId(queryKey);
                 querySeqData = qDbr.sequenceReader->getData(qId, thread_idx);
                 querySeqLen = qDbr.sequenceReader->getSeqLen(qId);
-                if(sameDB && qDbr.sequenceReader->isCompressed()){
+                if(sameDB && (qDbr.sequenceReader->isCompressed() || qDbr.sequenceReader->isPacked())){
                     queryBuffer.assign(querySeqData, querySeqLen);
                     querySeqData = (char*) queryBuffer.c_str();
                 }
@@ -493,10 +507,14 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
             }
             float *queryCaData = NULL;
             if (needCA) {
+                // the length cannot be derived from 16-bit diff encoded C-alpha entries
+                if (needSequenceDB == false) {
+                    querySeqLen = qDbr.sequenceReader->getSeqLen(qDbr.sequenceReader->getId(queryKey));
+                }
                 size_t qId = qcadbr->sequenceReader->getId(queryKey);
-		        querySeqLen =  (qcadbr->sequenceReader->getEntryLen(qId)-1)/(3*sizeof(float));
                 char *qcadata = qcadbr->sequenceReader->getData(qId, thread_idx);
                 size_t qCaLength = qcadbr->sequenceReader->getEntryLen(qId);
+                TimingReport::Scope scope(threadTiming, TimingReport::COORD_DECODE);
                 queryCaData = qcoords.read(qcadata, querySeqLen, qCaLength);
             }
             size_t qHeaderId = qDbrHeader.sequenceReader->getId(queryKey);
@@ -526,15 +544,22 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                 }
                 result.append("\", \"qca\": \"");
                 caStr.clear();
-                caToStr(queryCaData, querySeqLen, caStr);
+                caToStr(queryCaData, querySeqLen, querySeqLen, caStr);
                 result.append(caStr, 0, caStr.size()-1);
                 result.append("\"}, \"alignments\": [\n");
             }
 
-            char *data = alnDbr.getData(i, thread_idx);
-            while (*data != '\0') {
-                Matcher::result_t res = Matcher::parseAlignmentRecord(data, true);
-                data = Util::skipLine(data);
+            // text and binary alignment results
+            char *data;
+            {
+                TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                data = alnDbr.getData(i, thread_idx);
+            }
+            alnResults.clear();
+            Matcher::readAlignmentResults(alnResults, data, true);
+            TimingReport::count(threadTiming, TimingReport::ACCEPTED, alnResults.size());
+            for (size_t resIdx = 0; resIdx < alnResults.size(); resIdx++) {
+                Matcher::result_t &res = alnResults[resIdx];
 
                 if (res.backtrace.empty() && needBacktrace == true) {
                     Debug(Debug::ERROR) << "Backtrace cigar is missing in the alignment result. Please recompute the alignment with the -a flag.\n"
@@ -546,11 +571,13 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                 const char *tHeader = tDbrHeader->sequenceReader->getData(tHeaderId, thread_idx);
                 size_t tHeaderLen = tDbrHeader->sequenceReader->getSeqLen(tHeaderId);
                 float *targetCaData = NULL;
+                size_t tCaStride = 0;
                 if (needCA) {
                     size_t tId = tcadbr->sequenceReader->getId(res.dbKey);
                     char *tcadata = tcadbr->sequenceReader->getData(tId, thread_idx);
                     size_t tCaLength = tcadbr->sequenceReader->getEntryLen(tId);
-                    targetCaData = tcoords.read(tcadata, res.dbLen, tCaLength);
+                    TimingReport::Scope scope(threadTiming, TimingReport::COORD_DECODE);
+                    targetCaData = tcoords.readAligned(tcadata, res.dbLen, tCaLength, tCaStride);
                 }
 
                 std::string targetId = Util::parseFastaHeader(tHeader);
@@ -559,29 +586,12 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                 unsigned int alnLen = res.alnLength;
                 unsigned int missMatchCount = 0;
                 unsigned int identical = 0;
+                // parsed once, used for the statistics, TM-score, LDDT and the aligned sequences
+                alnMap.parse(res.backtrace, res.qStartPos, res.dbStartPos);
                 if (res.backtrace.empty() == false) {
-                    size_t matchCount = 0;
-                    alnLen = 0;
-                    for (size_t pos = 0; pos < res.backtrace.size(); pos++) {
-                        int cnt = 0;
-                        if (isdigit(res.backtrace[pos])) {
-                            cnt += Util::fast_atoi<int>(res.backtrace.c_str() + pos);
-                            while (isdigit(res.backtrace[pos])) {
-                                pos++;
-                            }
-                        }
-                        alnLen += cnt;
-
-                        switch (res.backtrace[pos]) {
-                            case 'M':
-                                matchCount += cnt;
-                                break;
-                            case 'D':
-                            case 'I':
-                                gapOpenCount += 1;
-                                break;
-                        }
-                    }
+                    size_t matchCount = alnMap.matches;
+                    alnLen = alnMap.columns;
+                    gapOpenCount = alnMap.gapOpenCount();
 //                res.seqId = X / alnLen;
                     identical = static_cast<unsigned int>(res.seqId * static_cast<float>(alnLen) + 0.5);
                     //res.alnLength = alnLen;
@@ -593,14 +603,18 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                     missMatchCount = static_cast<unsigned int>(bestMatchEstimate * (1.0f - res.seqId) + 0.5);
                 }
                 if(needTMaligner){
+                    TimingReport::Scope scope(threadTiming, TimingReport::TMSCORE);
                     tmaligner->initQuery(queryCaData, &queryCaData[res.qLen], &queryCaData[res.qLen+res.qLen], NULL, res.qLen);
-                    tmres = tmaligner->computeTMscore(targetCaData, &targetCaData[res.dbLen], &targetCaData[res.dbLen+res.dbLen], res.dbLen,
-                                                      res.qStartPos, res.dbStartPos, Matcher::uncompressAlignment(res.backtrace));
+                    tmres = tmaligner->computeTMscore(targetCaData, &targetCaData[tCaStride], &targetCaData[tCaStride+tCaStride], res.dbLen,
+                                                      alnMap);
                 }
                 LDDTCalculator::LDDTScoreResult lddtres;
                 if(needLDDT) {
-                    lddtres = lddtcalculator->computeLDDTScore(res.dbLen, res.qStartPos, res.dbStartPos, Matcher::uncompressAlignment(res.backtrace), targetCaData, &targetCaData[res.dbLen], &targetCaData[res.dbLen+res.dbLen]);
+                    TimingReport::Scope scope(threadTiming, TimingReport::LDDT);
+                    lddtres = lddtcalculator->computeLDDTScore(res.dbLen, alnMap, targetCaData, &targetCaData[tCaStride], &targetCaData[tCaStride+tCaStride]);
                 }
+                // covers the rest of the iteration
+                TimingReport::Scope formatScope(threadTiming, TimingReport::OUTPUT_FORMAT);
                 switch (format) {
                     case Parameters::FORMAT_ALIGNMENT_BLAST_TAB: {
                         if (outcodes.empty()) {
@@ -646,46 +660,46 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                                         result.append(targetId);
                                         break;
                                     case Parameters::OUTFMT_EVALUE:
-                                        result.append(SSTR(res.eval));
+                                        NumberFormat::append(result, res.eval);
                                         break;
                                     case Parameters::OUTFMT_GAPOPEN:
-                                        result.append(SSTR(gapOpenCount));
+                                        NumberFormat::append(result, gapOpenCount);
                                         break;
                                     case Parameters::OUTFMT_FIDENT:
-                                        result.append(SSTR(res.seqId));
+                                        NumberFormat::append(result, res.seqId);
                                         break;
                                     case Parameters::OUTFMT_PIDENT:
-                                        result.append(SSTR(res.seqId*100));
+                                        NumberFormat::append(result, res.seqId*100);
                                         break;
                                     case Parameters::OUTFMT_NIDENT:
-                                        result.append(SSTR(identical));
+                                        NumberFormat::append(result, identical);
                                         break;
                                     case Parameters::OUTFMT_QSTART:
-                                        result.append(SSTR(res.qStartPos + 1));
+                                        NumberFormat::append(result, res.qStartPos + 1);
                                         break;
                                     case Parameters::OUTFMT_QEND:
-                                        result.append(SSTR(res.qEndPos + 1));
+                                        NumberFormat::append(result, res.qEndPos + 1);
                                         break;
                                     case Parameters::OUTFMT_QLEN:
-                                        result.append(SSTR(res.qLen));
+                                        NumberFormat::append(result, res.qLen);
                                         break;
                                     case Parameters::OUTFMT_TSTART:
-                                        result.append(SSTR(res.dbStartPos + 1));
+                                        NumberFormat::append(result, res.dbStartPos + 1);
                                         break;
                                     case Parameters::OUTFMT_TEND:
-                                        result.append(SSTR(res.dbEndPos + 1));
+                                        NumberFormat::append(result, res.dbEndPos + 1);
                                         break;
                                     case Parameters::OUTFMT_TLEN:
-                                        result.append(SSTR(res.dbLen));
+                                        NumberFormat::append(result, res.dbLen);
                                         break;
                                     case Parameters::OUTFMT_ALNLEN:
-                                        result.append(SSTR(alnLen));
+                                        NumberFormat::append(result, alnLen);
                                         break;
                                     case Parameters::OUTFMT_RAW:
-                                        result.append(SSTR(static_cast<int>(evaluer->computeRawScoreFromBitScore(res.score) + 0.5)));
+                                        NumberFormat::append(result, static_cast<int>(evaluer->computeRawScoreFromBitScore(res.score) + 0.5));
                                         break;
                                     case Parameters::OUTFMT_BITS:
-                                        result.append(SSTR(res.score));
+                                        NumberFormat::append(result, res.score);
                                         break;
                                     case Parameters::OUTFMT_CIGAR:
                                         if(isTranslatedSearch == true && targetNucs == true && queryNucs == true ){
@@ -718,36 +732,36 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                                     case Parameters::OUTFMT_QALN:
                                         if (queryProfile) {
                                             structurePrintSeqBasedOnAln(result, queryProfData.c_str(), res.qStartPos,
-                                                               Matcher::uncompressAlignment(res.backtrace), false, (res.qStartPos > res.qEndPos),
+                                                               alnMap, false, (res.qStartPos > res.qEndPos),
                                                                (isTranslatedSearch == true && queryNucs == true), translateNucl);
                                         } else {
                                             structurePrintSeqBasedOnAln(result, querySeqData, res.qStartPos,
-                                                               Matcher::uncompressAlignment(res.backtrace), false, (res.qStartPos > res.qEndPos),
+                                                               alnMap, false, (res.qStartPos > res.qEndPos),
                                                                (isTranslatedSearch == true && queryNucs == true), translateNucl);
                                         }
                                         break;
                                     case Parameters::OUTFMT_TALN: {
                                         if (targetProfile) {
                                             structurePrintSeqBasedOnAln(result, targetProfData.c_str(), res.dbStartPos,
-                                                               Matcher::uncompressAlignment(res.backtrace), true,
+                                                               alnMap, true,
                                                                (res.dbStartPos > res.dbEndPos),
                                                                (isTranslatedSearch == true && targetNucs == true), translateNucl);
                                         } else {
                                             structurePrintSeqBasedOnAln(result, targetSeqData, res.dbStartPos,
-                                                               Matcher::uncompressAlignment(res.backtrace), true,
+                                                               alnMap, true,
                                                                (res.dbStartPos > res.dbEndPos),
                                                                (isTranslatedSearch == true && targetNucs == true), translateNucl);
                                         }
                                         break;
                                     }
                                     case Parameters::OUTFMT_MISMATCH:
-                                        result.append(SSTR(missMatchCount));
+                                        NumberFormat::append(result, missMatchCount);
                                         break;
                                     case Parameters::OUTFMT_QCOV:
-                                        result.append(SSTR(res.qcov));
+                                        NumberFormat::append(result, res.qcov);
                                         break;
                                     case Parameters::OUTFMT_TCOV:
-                                        result.append(SSTR(res.dbcov));
+                                        NumberFormat::append(result, res.dbcov);
                                         break;
                                     case Parameters::OUTFMT_QSET:
                                         result.append(SSTR(qSetToSource[qKeyToSet[queryKey]]));
@@ -762,7 +776,7 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                                         result.append(SSTR(tKeyToSet[res.dbKey]));
                                         break;
                                     case Parameters::OUTFMT_TAXID:
-                                        result.append(SSTR(taxon));
+                                        NumberFormat::append(result, taxon);
                                         break;
                                     case Parameters::OUTFMT_TAXNAME:
                                         result.append((taxonNode != NULL) ? t->getString(taxonNode->nameIdx) : "unclassified");
@@ -774,72 +788,72 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                                         result.push_back('-');
                                         break;
                                     case Parameters::OUTFMT_QORFSTART:
-                                        result.append(SSTR(res.queryOrfStartPos));
+                                        NumberFormat::append(result, res.queryOrfStartPos);
                                         break;
                                     case Parameters::OUTFMT_QORFEND:
-                                        result.append(SSTR(res.queryOrfEndPos));
+                                        NumberFormat::append(result, res.queryOrfEndPos);
                                         break;
                                     case Parameters::OUTFMT_TORFSTART:
-                                        result.append(SSTR(res.dbOrfStartPos));
+                                        NumberFormat::append(result, res.dbOrfStartPos);
                                         break;
                                     case Parameters::OUTFMT_TORFEND:
-                                        result.append(SSTR(res.dbOrfEndPos));
+                                        NumberFormat::append(result, res.dbOrfEndPos);
                                         break;
                                     case LocalParameters::OUTFMT_QCA:
                                         caStr.clear();
-                                        caToStr(queryCaData, res.qLen, caStr);
+                                        caToStr(queryCaData, res.qLen, res.qLen, caStr);
                                         result.append(caStr, 0, caStr.size()-1);
                                         break;
                                     case LocalParameters::OUTFMT_TCA:
                                         caStr.clear();
-                                        caToStr(targetCaData, res.dbLen, caStr);
+                                        caToStr(targetCaData, res.dbLen, tCaStride, caStr);
                                         result.append(caStr, 0, caStr.size()-1);
                                         break;
                                     case LocalParameters::OUTFMT_U:
-                                        result.append(SSTR(tmres.u[0][0]));
+                                        NumberFormat::append(result, tmres.u[0][0]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[0][1]));
+                                        NumberFormat::append(result, tmres.u[0][1]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[0][2]));
+                                        NumberFormat::append(result, tmres.u[0][2]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[1][0]));
+                                        NumberFormat::append(result, tmres.u[1][0]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[1][1]));
+                                        NumberFormat::append(result, tmres.u[1][1]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[1][2]));
+                                        NumberFormat::append(result, tmres.u[1][2]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[2][0]));
+                                        NumberFormat::append(result, tmres.u[2][0]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[2][1]));
+                                        NumberFormat::append(result, tmres.u[2][1]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.u[2][2]));
+                                        NumberFormat::append(result, tmres.u[2][2]);
                                         break;
                                     case LocalParameters::OUTFMT_T:
-                                        result.append(SSTR(tmres.t[0]));
+                                        NumberFormat::append(result, tmres.t[0]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.t[1]));
+                                        NumberFormat::append(result, tmres.t[1]);
                                         result.push_back(',');
-                                        result.append(SSTR(tmres.t[2]));
+                                        NumberFormat::append(result, tmres.t[2]);
                                         break;
                                     case LocalParameters::OUTFMT_ALNTMSCORE:
-                                        result.append(SSTR(tmres.tmscore));
+                                        NumberFormat::append(result, tmres.tmscore);
                                         break;
                                     case LocalParameters::OUTFMT_RMSD:
-                                        result.append(SSTR(tmres.rmsd));
+                                        NumberFormat::append(result, tmres.rmsd);
                                         break;
                                     case LocalParameters::OUTFMT_LDDT:
                                         // TODO: make SSTR_approx that outputs %2f, not %3f
-                                        result.append(SSTR(lddtres.avgLddtScore));
+                                        NumberFormat::append(result, lddtres.avgLddtScore);
                                         break;
                                     case LocalParameters::OUTFMT_LDDT_FULL:
                                         for(int i = 0; i < lddtres.scoreLength - 1; i++) {
-                                            result.append(SSTR(lddtres.perCaLddtScore[i]));
+                                            NumberFormat::append(result, lddtres.perCaLddtScore[i]);
                                             result.push_back(',');
                                         }
-                                        result.append(SSTR(lddtres.perCaLddtScore[lddtres.scoreLength - 1]));
+                                        NumberFormat::append(result, lddtres.perCaLddtScore[lddtres.scoreLength - 1]);
                                         break;
                                     case LocalParameters::OUTFMT_PROBTP:
-                                        result.append(SSTR(CalcProbTP::calculate(res.score)));
+                                        NumberFormat::append(result, CalcProbTP::calculate(res.score));
                                         break;
                                 }
                                 if (i < outcodes.size() - 1) {
@@ -850,6 +864,202 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                         }
                         break;
                     }
+                    case LocalParameters::FORMAT_ALIGNMENT_COLUMNAR: {
+                        char *targetSeqData = NULL;
+                        targetProfData.clear();
+                        unsigned int taxon = 0;
+                        if (needTaxonomy || needTaxonomyMapping) {
+                            taxon = mapping->lookup(res.dbKey);
+                            if (taxon == 0) {
+                                taxonNode = NULL;
+                            } else if (needTaxonomy) {
+                                taxonNode = t->taxonNode(taxon, false);
+                            }
+                        }
+                        if (needSequenceDB) {
+                            size_t tId = tDbr->sequenceReader->getId(res.dbKey);
+                            targetSeqData = tDbr->sequenceReader->getData(tId, thread_idx);
+                            if (targetProfile) {
+                                size_t targetEntryLen = tDbr->sequenceReader->getEntryLen(tId);
+                                Sequence::extractProfileConsensus(targetSeqData, targetEntryLen, *subMat, targetProfData);
+                            }
+                        }
+                        for (size_t col = 0; col < outcodes.size(); col++) {
+                            std::string &str = rowGroup.stringBuffer(col);
+                            switch (outcodes[col]) {
+                                case Parameters::OUTFMT_QUERY:
+                                    str.append(queryId);
+                                    break;
+                                case Parameters::OUTFMT_TARGET:
+                                    str.append(targetId);
+                                    break;
+                                case Parameters::OUTFMT_EVALUE:
+                                    rowGroup.addDouble(col, res.eval);
+                                    break;
+                                case Parameters::OUTFMT_GAPOPEN:
+                                    rowGroup.addInt(col, gapOpenCount);
+                                    break;
+                                case Parameters::OUTFMT_FIDENT:
+                                    rowGroup.addFloat(col, res.seqId);
+                                    break;
+                                case Parameters::OUTFMT_PIDENT:
+                                    rowGroup.addFloat(col, res.seqId * 100);
+                                    break;
+                                case Parameters::OUTFMT_NIDENT:
+                                    rowGroup.addInt(col, identical);
+                                    break;
+                                case Parameters::OUTFMT_QSTART:
+                                    rowGroup.addInt(col, res.qStartPos + 1);
+                                    break;
+                                case Parameters::OUTFMT_QEND:
+                                    rowGroup.addInt(col, res.qEndPos + 1);
+                                    break;
+                                case Parameters::OUTFMT_QLEN:
+                                    rowGroup.addInt(col, res.qLen);
+                                    break;
+                                case Parameters::OUTFMT_TSTART:
+                                    rowGroup.addInt(col, res.dbStartPos + 1);
+                                    break;
+                                case Parameters::OUTFMT_TEND:
+                                    rowGroup.addInt(col, res.dbEndPos + 1);
+                                    break;
+                                case Parameters::OUTFMT_TLEN:
+                                    rowGroup.addInt(col, res.dbLen);
+                                    break;
+                                case Parameters::OUTFMT_ALNLEN:
+                                    rowGroup.addInt(col, alnLen);
+                                    break;
+                                case Parameters::OUTFMT_RAW:
+                                    rowGroup.addInt(col, static_cast<int>(evaluer->computeRawScoreFromBitScore(res.score) + 0.5));
+                                    break;
+                                case Parameters::OUTFMT_BITS:
+                                    rowGroup.addInt(col, res.score);
+                                    break;
+                                case Parameters::OUTFMT_CIGAR:
+                                    if (isTranslatedSearch == true && targetNucs == true && queryNucs == true) {
+                                        Matcher::result_t::protein2nucl(res.backtrace, newBacktrace);
+                                        res.backtrace = newBacktrace;
+                                    }
+                                    str.append(res.backtrace);
+                                    newBacktrace.clear();
+                                    break;
+                                case Parameters::OUTFMT_QSEQ:
+                                    if (queryProfile) {
+                                        str.append(queryProfData.c_str(), res.qLen);
+                                    } else {
+                                        str.append(querySeqData, res.qLen);
+                                    }
+                                    break;
+                                case Parameters::OUTFMT_TSEQ:
+                                    if (targetProfile) {
+                                        str.append(targetProfData.c_str(), res.dbLen);
+                                    } else {
+                                        str.append(targetSeqData, res.dbLen);
+                                    }
+                                    break;
+                                case Parameters::OUTFMT_QHEADER:
+                                    str.append(qHeader, qHeaderLen);
+                                    break;
+                                case Parameters::OUTFMT_THEADER:
+                                    str.append(tHeader, tHeaderLen);
+                                    break;
+                                case Parameters::OUTFMT_QALN:
+                                    structurePrintSeqBasedOnAln(str, queryProfile ? queryProfData.c_str() : querySeqData, res.qStartPos,
+                                                                alnMap, false, (res.qStartPos > res.qEndPos),
+                                                                (isTranslatedSearch == true && queryNucs == true), translateNucl);
+                                    break;
+                                case Parameters::OUTFMT_TALN:
+                                    structurePrintSeqBasedOnAln(str, targetProfile ? targetProfData.c_str() : targetSeqData, res.dbStartPos,
+                                                                alnMap, true, (res.dbStartPos > res.dbEndPos),
+                                                                (isTranslatedSearch == true && targetNucs == true), translateNucl);
+                                    break;
+                                case Parameters::OUTFMT_MISMATCH:
+                                    rowGroup.addInt(col, missMatchCount);
+                                    break;
+                                case Parameters::OUTFMT_QCOV:
+                                    rowGroup.addFloat(col, res.qcov);
+                                    break;
+                                case Parameters::OUTFMT_TCOV:
+                                    rowGroup.addFloat(col, res.dbcov);
+                                    break;
+                                case Parameters::OUTFMT_QSET:
+                                    str.append(qSetToSource[qKeyToSet[queryKey]]);
+                                    break;
+                                case Parameters::OUTFMT_QSETID:
+                                    rowGroup.addInt(col, qKeyToSet[queryKey]);
+                                    break;
+                                case Parameters::OUTFMT_TSET:
+                                    str.append(tSetToSource[tKeyToSet[res.dbKey]]);
+                                    break;
+                                case Parameters::OUTFMT_TSETID:
+                                    rowGroup.addInt(col, tKeyToSet[res.dbKey]);
+                                    break;
+                                case Parameters::OUTFMT_TAXID:
+                                    rowGroup.addInt(col, taxon);
+                                    break;
+                                case Parameters::OUTFMT_TAXNAME:
+                                    str.append((taxonNode != NULL) ? t->getString(taxonNode->nameIdx) : "unclassified");
+                                    break;
+                                case Parameters::OUTFMT_TAXLIN:
+                                    str.append((taxonNode != NULL) ? t->taxLineage(taxonNode, true) : "unclassified");
+                                    break;
+                                case Parameters::OUTFMT_EMPTY:
+                                    str.push_back('-');
+                                    break;
+                                case Parameters::OUTFMT_QORFSTART:
+                                    rowGroup.addInt(col, res.queryOrfStartPos);
+                                    break;
+                                case Parameters::OUTFMT_QORFEND:
+                                    rowGroup.addInt(col, res.queryOrfEndPos);
+                                    break;
+                                case Parameters::OUTFMT_TORFSTART:
+                                    rowGroup.addInt(col, res.dbOrfStartPos);
+                                    break;
+                                case Parameters::OUTFMT_TORFEND:
+                                    rowGroup.addInt(col, res.dbOrfEndPos);
+                                    break;
+                                case LocalParameters::OUTFMT_QCA:
+                                case LocalParameters::OUTFMT_TCA: {
+                                    const bool isQuery = outcodes[col] == LocalParameters::OUTFMT_QCA;
+                                    const float *ca = isQuery ? queryCaData : targetCaData;
+                                    const size_t len = isQuery ? res.qLen : res.dbLen;
+                                    const size_t stride = isQuery ? res.qLen : tCaStride;
+                                    for (size_t pos = 0; pos < len; pos++) {
+                                        const float xyz[3] = { ca[pos], ca[stride + pos], ca[2 * stride + pos] };
+                                        str.append(reinterpret_cast<const char *>(xyz), sizeof(xyz));
+                                    }
+                                    rowGroup.endValue(col);
+                                    break;
+                                }
+                                case LocalParameters::OUTFMT_U:
+                                    rowGroup.addFloats(col, &tmres.u[0][0], 9);
+                                    break;
+                                case LocalParameters::OUTFMT_T:
+                                    rowGroup.addFloats(col, tmres.t, 3);
+                                    break;
+                                case LocalParameters::OUTFMT_ALNTMSCORE:
+                                    rowGroup.addDouble(col, tmres.tmscore);
+                                    break;
+                                case LocalParameters::OUTFMT_RMSD:
+                                    rowGroup.addDouble(col, tmres.rmsd);
+                                    break;
+                                case LocalParameters::OUTFMT_LDDT:
+                                    rowGroup.addDouble(col, lddtres.avgLddtScore);
+                                    break;
+                                case LocalParameters::OUTFMT_LDDT_FULL:
+                                    rowGroup.addFloats(col, lddtres.perCaLddtScore, lddtres.scoreLength);
+                                    break;
+                                case LocalParameters::OUTFMT_PROBTP:
+                                    rowGroup.addFloat(col, CalcProbTP::calculate(res.score));
+                                    break;
+                            }
+                            if (ColumnarFormat::columnType(outcodes[col]) == ColumnarFormat::STRING) {
+                                rowGroup.endValue(col);
+                            }
+                        }
+                        rowGroup.endRow();
+                        break;
+                    }
                     case Parameters::FORMAT_ALIGNMENT_BLAST_WITH_LEN: {
                         int count = snprintf(buffer, sizeof(buffer),
                                              "%s\t%s\t%1.3f\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%.2E\t%d\t%d\t%d\n",
@@ -922,9 +1132,9 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                             int count = snprintf(buffer, sizeof(buffer),
                                    "ATOM  %5d %4s %3s %1s%4d    %8.3f%8.3f%8.3f%6.2f%6.2f\n",
                                    tpos+1, "CA", singleLetterToThree(targetSeqData[tpos]), "A", tpos+1,
-                                   tmres.t[0] + targetCaData[tpos] * tmres.u[0][0] + targetCaData[res.dbLen+tpos] * tmres.u[0][1] + targetCaData[res.dbLen+res.dbLen+tpos] * tmres.u[0][2],
-                                   tmres.t[1] + targetCaData[tpos] * tmres.u[1][0] + targetCaData[res.dbLen+tpos] * tmres.u[1][1] + targetCaData[res.dbLen+res.dbLen+tpos] * tmres.u[1][2],
-                                   tmres.t[2] + targetCaData[tpos] * tmres.u[2][0] + targetCaData[res.dbLen+tpos] * tmres.u[2][1] + targetCaData[res.dbLen+res.dbLen+tpos] * tmres.u[2][2],
+                                   tmres.t[0] + targetCaData[tpos] * tmres.u[0][0] + targetCaData[tCaStride+tpos] * tmres.u[0][1] + targetCaData[tCaStride+tCaStride+tpos] * tmres.u[0][2],
+                                   tmres.t[1] + targetCaData[tpos] * tmres.u[1][0] + targetCaData[tCaStride+tpos] * tmres.u[1][1] + targetCaData[tCaStride+tCaStride+tpos] * tmres.u[1][2],
+                                   tmres.t[2] + targetCaData[tpos] * tmres.u[2][0] + targetCaData[tCaStride+tpos] * tmres.u[2][1] + targetCaData[tCaStride+tCaStride+tpos] * tmres.u[2][2],
                                    1.0, 0.0);
                             if (count < 0 || static_cast<size_t>(count) >= sizeof(buffer)) {
                                 Debug(Debug::WARNING) << "Truncated line in entry" << i << "!\n";
@@ -955,11 +1165,11 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                         result.append(buffer, count);
                         if (queryProfile) {
                             structurePrintSeqBasedOnAln(result, queryProfData.c_str(), res.qStartPos,
-                                               Matcher::uncompressAlignment(res.backtrace), false, (res.qStartPos > res.qEndPos),
+                                               alnMap, false, (res.qStartPos > res.qEndPos),
                                                (isTranslatedSearch == true && queryNucs == true), translateNucl);
                         } else {
                             structurePrintSeqBasedOnAln(result, querySeqData, res.qStartPos,
-                                               Matcher::uncompressAlignment(res.backtrace), false, (res.qStartPos > res.qEndPos),
+                                               alnMap, false, (res.qStartPos > res.qEndPos),
                                                (isTranslatedSearch == true && queryNucs == true), translateNucl);
                         }
                         result.append("\", \"dbAln\": \"");
@@ -969,18 +1179,18 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
                             size_t targetEntryLen = tDbr->sequenceReader->getEntryLen(tId);
                             Sequence::extractProfileConsensus(targetSeqData, targetEntryLen, *subMat, targetProfData);
                             structurePrintSeqBasedOnAln(result, targetProfData.c_str(), res.dbStartPos,
-                                               Matcher::uncompressAlignment(res.backtrace), true,
+                                               alnMap, true,
                                                (res.dbStartPos > res.dbEndPos),
                                                (isTranslatedSearch == true && targetNucs == true), translateNucl);
                         } else {
                             structurePrintSeqBasedOnAln(result, targetSeqData, res.dbStartPos,
-                                               Matcher::uncompressAlignment(res.backtrace), true,
+                                               alnMap, true,
                                                (res.dbStartPos > res.dbEndPos),
                                                (isTranslatedSearch == true && targetNucs == true), translateNucl);
                         }
                         result.append("\", \"tca\": \"");
                         caStr.clear();
-                        caToStr(targetCaData, res.dbLen, caStr);
+                        caToStr(targetCaData, res.dbLen, tCaStride, caStr);
                         result.append(caStr, 0, caStr.size()-1);
                         
                         result.append("\", \"tseq\": \"");
@@ -999,7 +1209,18 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
             if (format == Parameters::FORMAT_ALIGNMENT_HTML) {
                 result.append("]},\n");
             }
-            resultWriter.writeData(result.c_str(), result.size(), queryKey, thread_idx, isDb);
+            if (rowGroup.full()) {
+                rowGroup.serialize(result);
+            }
+            {
+                TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                resultWriter.writeData(result.c_str(), result.size(), queryKey, thread_idx, isDb);
+            }
+            result.clear();
+        }
+        if (rowGroup.empty() == false) {
+            rowGroup.serialize(result);
+            resultWriter.writeData(result.c_str(), result.size(), 0, thread_idx, false, false);
             result.clear();
         }
         if(tmaligner != NULL){
@@ -1013,6 +1234,7 @@ int structureconvertalis(int argc, const char **argv, const Command &command) {
         const char* endBlock = "]);</script>";
         resultWriter.writeData(endBlock, strlen(endBlock), 0, localThreads - 1, false, false);
     }
+    timing.write("convertalis");
     // tsv output
     resultWriter.close(true);
     if (isDb == false) {
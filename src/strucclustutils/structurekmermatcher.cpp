@@ -0,0 +1,77 @@
+#include "LocalParameters.h"
+#include "DBReader.h"
+#include "Debug.h"
+#include "Util.h"
+#include "SubstitutionMatrix.h"
+#include "ReducedMatrix.h"
+#include "MMseqsMPI.h"
+#include "kmermatcher.h"
+
+// kmermatcher on the 3Di database (<db>_ss) of a structure database.
+// If --kmer-aa-alph-size is set, the (reduced) amino acid letters at the same
+// k-mer positions are appended to every 3Di k-mer key, so only k-mers that agree
+// in structure and sequence end up in the same group. Keys longer than 63 bits are hashed.
+int structurekmermatcher(int argc, const char **argv, const Command &command) {
+    MMseqsMPI::init(argc, argv);
+
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    setLinearFilterDefault(&par);
+    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_CLUSTLINEAR);
+
+    std::string ssDb = par.db1 + "_ss";
+    std::string ssDbIndex = par.db1 + "_ss.index";
+    DBReader<unsigned int> seqDbr(ssDb.c_str(), ssDbIndex.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    seqDbr.open(DBReader<unsigned int>::NOSORT);
+
+    setKmerLengthAndAlphabet(par, seqDbr.getAminoAcidDBSize(), seqDbr.getDbtype());
+    par.printParameters(command.cmd, argc, argv, *command.params);
+    Debug(Debug::INFO) << "Database size: " << seqDbr.getSize() << " type: " << seqDbr.getDbTypeName() << "\n";
+
+    DBReader<unsigned int> *aaDbr = NULL;
+    BaseMatrix *subMatAA = NULL;
+    KmerPairedDb *pairedDb = NULL;
+    if (par.kmerAAAlphabetSize > 0) {
+        aaDbr = new DBReader<unsigned int>(par.db1.c_str(), par.db1Index.c_str(), par.threads,
+                                           DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+        aaDbr->open(DBReader<unsigned int>::NOSORT);
+
+        std::string blosum;
+        for (size_t i = 0; i < par.substitutionMatrices.size(); i++) {
+            if (par.substitutionMatrices[i].name == "blosum62.out") {
+                std::string matrixData((const char *)par.substitutionMatrices[i].subMatData, par.substitutionMatrices[i].subMatDataLen);
+                std::string matrixName = par.substitutionMatrices[i].name;
+                char * serializedMatrix = BaseMatrix::serialize(matrixName, matrixData);
+                blosum.assign(serializedMatrix);
+                free(serializedMatrix);
+                break;
+            }
+        }
+        if (par.kmerAAAlphabetSize == 21) {
+            subMatAA = new SubstitutionMatrix(blosum.c_str(), 2.0, 0.0);
+        } else {
+            SubstitutionMatrix sMat(blosum.c_str(), 8.0, -0.2f);
+            subMatAA = new ReducedMatrix(sMat.probMatrix, sMat.subMatrixPseudoCounts, sMat.aa2num, sMat.num2aa, sMat.alphabetSize, par.kmerAAAlphabetSize, 2.0);
+        }
+        pairedDb = new KmerPairedDb(aaDbr, subMatAA);
+        if (pairedKmerNeedsHash(par.kmerSize, par.alphabetSize.values.aminoacid() - 1, subMatAA->alphabetSize - 1)) {
+            Debug(Debug::INFO) << "3Di+AA k-mers of length " << par.kmerSize << " do not fit into 63 bits, their keys are hashed\n";
+        }
+    }
+
+    if (seqDbr.getMaxSeqLen() < SHRT_MAX) {
+        kmermatcherInner<short>(par, seqDbr, pairedDb);
+    } else {
+        kmermatcherInner<int>(par, seqDbr, pairedDb);
+    }
+
+    if (pairedDb != NULL) {
+        delete pairedDb;
+        delete subMatAA;
+        aaDbr->close();
+        delete aaDbr;
+    }
+    seqDbr.close();
+
+    return EXIT_SUCCESS;
+}
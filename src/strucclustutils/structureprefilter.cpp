@@ -0,0 +1,78 @@
+#include "LocalParameters.h"
+#include "Prefiltering.h"
+#include "PrefilteringIndexReader.h"
+#include "SubstitutionMatrix.h"
+#include "StructureUtil.h"
+#include "MMseqsMPI.h"
+#include "FileUtil.h"
+#include "Debug.h"
+#include "Util.h"
+
+#include <ctime>
+
+// k-mer prefilter on the 3Di databases (<db>_ss) of a structure database. The k-mer matching is
+// the same as in prefilter, but the ungapped diagonal scores of the k-mer hits are computed with
+// the 3Di and the amino acid substitution matrix (the amino acids of the target are stored next to
+// the 3Di letters in the sequence lookup of the prefilter).
+int structureprefilter(int argc, const char **argv, const Command &command) {
+    MMseqsMPI::init(argc, argv);
+
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_PREFILTER);
+
+    const std::string queryDb = par.db1 + "_ss";
+    const std::string queryDbIndex = par.db1 + "_ss.index";
+    const std::string targetDb = StructureUtil::getIndexWithSuffix(par.db2, "_ss");
+    const std::string targetDbIndex = targetDb + ".index";
+    std::string targetAADb = PrefilteringIndexReader::dbPathWithoutIndex(par.db2);
+    const std::string targetAADbIndex = targetAADb + ".index";
+
+    int queryDbType = FileUtil::parseDbType(queryDb.c_str());
+    int targetDbType = FileUtil::parseDbType(targetDb.c_str());
+    if (Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_INDEX_DB) == true) {
+        DBReader<unsigned int> dbr(targetDb.c_str(), targetDbIndex.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+        dbr.open(DBReader<unsigned int>::NOSORT);
+        PrefilteringIndexData data = PrefilteringIndexReader::getMetadata(&dbr);
+        targetDbType = data.seqType;
+        dbr.close();
+    }
+    if (queryDbType == -1 || targetDbType == -1) {
+        Debug(Debug::ERROR) << "Please recreate your database or add a .dbtype file to your sequence/profile database.\n";
+        return EXIT_FAILURE;
+    }
+    if (Parameters::isEqualDbtype(queryDbType, Parameters::DBTYPE_HMM_PROFILE) || Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_HMM_PROFILE)) {
+        Debug(Debug::ERROR) << "structureprefilter does not support profile databases. Please use prefilter.\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string blosum;
+    for (size_t i = 0; i < par.substitutionMatrices.size(); i++) {
+        if (par.substitutionMatrices[i].name == "blosum62.out") {
+            std::string matrixData((const char *)par.substitutionMatrices[i].subMatData, par.substitutionMatrices[i].subMatDataLen);
+            std::string matrixName = par.substitutionMatrices[i].name;
+            char * serializedMatrix = BaseMatrix::serialize(matrixName, matrixData);
+            blosum.assign(serializedMatrix);
+            free(serializedMatrix);
+            break;
+        }
+    }
+    // same weight of the amino acid scores relative to the 3Di scores as in structurealign
+    SubstitutionMatrix subMatAA(blosum.c_str(), 1.4, 0.0);
+
+    PrefilterPairedDb pairedDb(par.db1, par.db1Index, targetAADb, targetAADbIndex, &subMatAA);
+    Prefiltering pref(queryDb, queryDbIndex, targetDb, targetDbIndex, queryDbType, targetDbType, par, &pairedDb);
+
+#ifdef HAVE_MPI
+    int runRandomId = 0;
+    if (par.localTmp != "") {
+        std::srand(std::time(nullptr)); // use current time as seed for random generator
+        runRandomId = std::rand();
+        runRandomId = runRandomId / 2; // to avoid the unlikely case of overflowing later
+    }
+    pref.runMpiSplits(par.db3, par.db3Index, par.localTmp, runRandomId);
+#else
+    pref.runAllSplits(par.db3, par.db3Index);
+#endif
+
+    return EXIT_SUCCESS;
+}
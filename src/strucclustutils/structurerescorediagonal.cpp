@@ -9,45 +9,18 @@
 #include "structureto3diseqdist.h"
 #include "StructureSmithWaterman.h"
 #include "StructureUtil.h"
+#include "UngappedDiagonal.h"
 #include "DistanceCalculator.h"
 #include "QueryMatcher.h"
 #include "TMaligner.h"
 #include "Coordinate16.h"
+#include "MMseqsMPI.h"
 
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
 
-template<typename T>
-static DistanceCalculator::LocalAlignment ungappedAlignment(const T *seq3Di1,
-                                                            const T *seqAA1,
-                                                            const T *seq3Di2,
-                                                            const T *seqAA2,
-                                                            const unsigned int length,
-                                                            short **sub3DiMat,
-                                                            short **subAAMat) {
-    int maxScore = 0;
-    int maxEndPos = 0;
-    int maxStartPos = 0;
-    int minPos = -1;
-//        int maxMinPos = 0;
-    int score = 0;
-    for(unsigned int pos = 0; pos < length; pos++){
-        int curr3Di = sub3DiMat[static_cast<int>(seq3Di1[pos])][static_cast<int>(seq3Di2[pos])];
-        int currAAi = subAAMat[static_cast<int>(seqAA1[pos])][static_cast<int>(seqAA2[pos])];
-        score = curr3Di + currAAi + score;
-        const bool isMinScore = (score <= 0);
-        score =  (isMinScore) ? 0 : score;
-        minPos = (isMinScore) ? pos : minPos;
-        const bool isNewMaxScore = (score > maxScore);
-        maxEndPos = (isNewMaxScore) ? pos : maxEndPos;
-        maxStartPos = (isNewMaxScore) ? minPos + 1 : maxStartPos;
-        maxScore = (isNewMaxScore)? score : maxScore;
-    }
-    return DistanceCalculator::LocalAlignment(maxStartPos, maxEndPos, maxScore);
-}
-
 Matcher::result_t ungappedAlignStructure(Sequence & qSeqAA, Sequence & qSeq3Di, Sequence & qRevSeqAA, Sequence & qRevSeq3Di,
                                          Sequence & tSeqAA, Sequence & tSeq3Di, int diagonal, SubstitutionMatrix & subAAMat,
                                          SubstitutionMatrix & sub3DiMat, EvalueNeuralNet & evaluer,
@@ -57,50 +30,15 @@ Matcher::result_t ungappedAlignStructure(Sequence & qSeqAA, Sequence & qSeq3Di,
     int32_t score = 0;
     backtrace.clear();
     unsigned int minDistToDiagonal = abs(diagonal);
+    DistanceCalculator::LocalAlignment revTmp;
+    if (UngappedDiagonal::alignDiagonal(qSeq3Di.numSequence, qSeqAA.numSequence, qRevSeq3Di.numSequence, qRevSeqAA.numSequence,
+                                        static_cast<unsigned int>(qSeqAA.L), tSeq3Di.numSequence, tSeqAA.numSequence,
+                                        static_cast<unsigned int>(tSeqAA.L), diagonal, sub3DiMat.subMatrix, subAAMat.subMatrix,
+                                        res, revTmp)) {
+        score = static_cast<int32_t>(res.score) - static_cast<int32_t>(revTmp.score);
+    }
     res.distToDiagonal = minDistToDiagonal;
     res.diagonal = diagonal;
-    if (diagonal >= 0 && minDistToDiagonal < static_cast<unsigned int>(qSeqAA.L)) {
-        unsigned int minSeqLen = std::min(static_cast<unsigned int>(tSeqAA.L), static_cast<unsigned int>(qSeqAA.L) - minDistToDiagonal);
-        res.diagonalLen = minSeqLen;
-        DistanceCalculator::LocalAlignment tmp = ungappedAlignment(qSeq3Di.numSequence + minDistToDiagonal,
-                                                                   qSeqAA.numSequence + minDistToDiagonal,
-                                                                   tSeq3Di.numSequence,
-                                                                   tSeqAA.numSequence,
-                                                                   minSeqLen, sub3DiMat.subMatrix, subAAMat.subMatrix);
-
-        res.score = tmp.score;
-        res.startPos = tmp.startPos;
-        res.endPos = tmp.endPos;
-
-        DistanceCalculator::LocalAlignment revTmp = ungappedAlignment(qRevSeq3Di.numSequence + minDistToDiagonal,
-                                                                      qRevSeqAA.numSequence + minDistToDiagonal,
-                                                                      tSeq3Di.numSequence,
-                                                                      tSeqAA.numSequence,
-                                                                      minSeqLen, sub3DiMat.subMatrix, subAAMat.subMatrix);
-
-        score = static_cast<int32_t>(tmp.score) - static_cast<int32_t>(revTmp.score);
-
-
-    } else if (diagonal < 0 && minDistToDiagonal < static_cast<unsigned int>(tSeqAA.L)) {
-        unsigned int minSeqLen = std::min(tSeqAA.L - minDistToDiagonal, static_cast<unsigned int>(qSeqAA.L));
-        res.diagonalLen = minSeqLen;
-        DistanceCalculator::LocalAlignment tmp = ungappedAlignment(qSeq3Di.numSequence, qSeqAA.numSequence,
-                                                                   tSeq3Di.numSequence + minDistToDiagonal,
-                                                                   tSeqAA.numSequence + minDistToDiagonal,
-                                                                   minSeqLen,sub3DiMat.subMatrix, subAAMat.subMatrix);
-        res.score = tmp.score;
-        res.startPos = tmp.startPos;
-        res.endPos = tmp.endPos;
-
-        DistanceCalculator::LocalAlignment revTmp = ungappedAlignment(qRevSeq3Di.numSequence, qSeqAA.numSequence,
-                                                                      qRevSeqAA.numSequence + minDistToDiagonal,
-                                                                      tSeqAA.numSequence + minDistToDiagonal,
-                                                                      minSeqLen, sub3DiMat.subMatrix, subAAMat.subMatrix);
-
-
-        score = static_cast<int32_t>(tmp.score) - static_cast<int32_t>(revTmp.score);
-
-    }
 
     double evalue = evaluer.computeEvalueCorr(score, muLambda.first, muLambda.second);
 
@@ -158,6 +96,7 @@ Matcher::result_t ungappedAlignStructure(Sequence & qSeqAA, Sequence & qSeq3Di,
 
 
 int structureungappedalign(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
     LocalParameters &par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_ALIGN);
 
@@ -206,7 +145,17 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
     DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter dbw(par.db4.c_str(), par.db4Index.c_str(), static_cast<unsigned int>(par.threads), par.compressed,  Parameters::DBTYPE_ALIGNMENT_RES);
+    size_t dbFrom = 0;
+    size_t dbSize = resultReader.getSize();
+    std::string outDb = par.db4;
+    std::string outDbIndex = par.db4Index;
+#ifdef HAVE_MPI
+    resultReader.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
+    std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(par.db4, par.db4Index, MMseqsMPI::rank);
+    outDb = tmpOutput.first;
+    outDbIndex = tmpOutput.second;
+#endif
+    DBWriter dbw(outDb.c_str(), outDbIndex.c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
     dbw.open();
 
     SubstitutionMatrix subMat3Di(par.scoringMatrixFile.values.aminoacid().c_str(), 2.1, par.scoreBias);
@@ -222,23 +171,7 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
         }
     }
     SubstitutionMatrix subMatAA(blosum.c_str(), 1.4, par.scoreBias);
-    //temporary output file
-    Debug::Progress progress(resultReader.getSize());
-
-    // sub. mat needed for query profile
-    int8_t * tinySubMatAA = (int8_t*) mem_align(ALIGN_INT, subMatAA.alphabetSize * 32);
-    int8_t * tinySubMat3Di = (int8_t*) mem_align(ALIGN_INT, subMat3Di.alphabetSize * 32);
-
-    for (int i = 0; i < subMat3Di.alphabetSize; i++) {
-        for (int j = 0; j < subMat3Di.alphabetSize; j++) {
-            tinySubMat3Di[i * subMat3Di.alphabetSize + j] = subMat3Di.subMatrix[i][j]; // for farrar profile
-        }
-    }
-    for (int i = 0; i < subMatAA.alphabetSize; i++) {
-        for (int j = 0; j < subMatAA.alphabetSize; j++) {
-            tinySubMatAA[i * subMatAA.alphabetSize + j] = subMatAA.subMatrix[i][j];
-        }
-    }
+    Debug::Progress progress(dbSize);
 
 #pragma omp parallel
     {
@@ -248,8 +181,6 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
 #endif
         EvalueNeuralNet evaluer(tAADbr->sequenceReader->getAminoAcidDBSize(), &subMat3Di);
         std::vector<Matcher::result_t> alignmentResult;
-        StructureSmithWaterman structureSmithWaterman(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
-        StructureSmithWaterman reverseStructureSmithWaterman(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
 
         Sequence qSeqAA(par.maxSeqLen, qdbrAA.getDbtype(), (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
         Sequence qSeq3Di(par.maxSeqLen, qdbr3Di.getDbtype(), (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
@@ -273,19 +204,15 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
         // write output file
 
 #pragma omp for schedule(dynamic, 1)
-        for (size_t id = 0; id < resultReader.getSize(); id++) {
+        for (size_t id = dbFrom; id < (dbFrom + dbSize); id++) {
             progress.updateProgress();
             char *data = resultReader.getData(id, thread_idx);
             size_t queryKey = resultReader.getDbKey(id);
             if(*data != '\0') {
                 unsigned int queryId = qdbr3Di.sequenceReader->getId(queryKey);
 
-                char *querySeqAA = qdbrAA.sequenceReader->getData(queryId, thread_idx);
-                char *querySeq3Di = qdbr3Di.sequenceReader->getData(queryId, thread_idx);
-
-                unsigned int querySeqLen = qdbr3Di.sequenceReader->getSeqLen(queryId);
-                qSeq3Di.mapSequence(id, queryKey, querySeq3Di, querySeqLen);
-                qSeqAA.mapSequence(id, queryKey, querySeqAA, querySeqLen);
+                qSeq3Di.mapSequence(id, queryKey, *qdbr3Di.sequenceReader, queryId, thread_idx);
+                qSeqAA.mapSequence(id, queryKey, *qdbrAA.sequenceReader, queryId, thread_idx);
                 if(needTMaligner){
                     size_t qId = qcadbr->sequenceReader->getId(queryKey);
                     char *qcadata = qcadbr->sequenceReader->getData(qId, thread_idx);
@@ -293,13 +220,11 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
                     float* queryCaData = qcoords.read(qcadata, qSeq3Di.L, qCaLength);
                     tmaligner->initQuery(queryCaData, &queryCaData[qSeq3Di.L], &queryCaData[qSeq3Di.L+qSeq3Di.L], NULL, qSeq3Di.L);
                 }
-                qRevSeq3Di.mapSequence(id, queryKey, querySeq3Di, querySeqLen);
-                qRevSeqAA.mapSequence(id, queryKey, querySeqAA, querySeqLen);
+                qRevSeq3Di.mapSequence(id, queryKey, *qdbr3Di.sequenceReader, queryId, thread_idx);
+                qRevSeqAA.mapSequence(id, queryKey, *qdbrAA.sequenceReader, queryId, thread_idx);
                 std::pair<double, double> muLambda = evaluer.predictMuLambda(qSeq3Di.numSequence, qSeq3Di.L);
-                structureSmithWaterman.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
                 qRevSeq3Di.reverse();
                 qRevSeqAA.reverse();
-                reverseStructureSmithWaterman.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
                 int passedNum = 0;
                 int rejected = 0;
                 while (*data != '\0' && passedNum < par.maxAccept && rejected < par.maxRejected) {
@@ -309,12 +234,10 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
                     unsigned int targetId = t3DiDbr->sequenceReader->getId(dbKey);
                     const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameDB))? true : false;
 
-                    char * targetSeq3Di = t3DiDbr->sequenceReader->getData(targetId, thread_idx);
-                    char * targetSeqAA = tAADbr->sequenceReader->getData(targetId, thread_idx);
                     const int targetSeqLen = static_cast<int>(t3DiDbr->sequenceReader->getSeqLen(targetId));
 
-                    tSeq3Di.mapSequence(targetId, dbKey, targetSeq3Di, targetSeqLen);
-                    tSeqAA.mapSequence(targetId, dbKey, targetSeqAA, targetSeqLen);
+                    tSeq3Di.mapSequence(targetId, dbKey, *t3DiDbr->sequenceReader, targetId, thread_idx);
+                    tSeqAA.mapSequence(targetId, dbKey, *tAADbr->sequenceReader, targetId, thread_idx);
                     if(Util::canBeCovered(par.covThr, par.covMode, qSeq3Di.L, targetSeqLen) == false){
                         rejected++;
                         continue;
@@ -330,9 +253,10 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
                         size_t tId = tcadbr->sequenceReader->getId(res.dbKey);
                         char *tcadata = tcadbr->sequenceReader->getData(tId, thread_idx);
                         size_t tCaLength = tcadbr->sequenceReader->getEntryLen(tId);
-                        float* targetCaData = tcoords.read(tcadata, res.dbLen, tCaLength);
-                        TMaligner::TMscoreResult tmres = tmaligner->computeTMscore(targetCaData, &targetCaData[res.dbLen], &targetCaData[res.dbLen+res.dbLen], res.dbLen,
-                                                                                   res.qStartPos, res.dbStartPos, Matcher::uncompressAlignment(res.backtrace));
+                        size_t tStride;
+                        float* targetCaData = tcoords.readAligned(tcadata, res.dbLen, tCaLength, tStride);
+                        TMaligner::TMscoreResult tmres = tmaligner->computeTMscore(targetCaData, &targetCaData[tStride], &targetCaData[tStride+tStride], res.dbLen,
+                                                                                   res.qStartPos, res.dbStartPos, res.backtrace);
                         if(tmres.tmscore < par.tmScoreThr){
                             continue;
                         }
@@ -365,10 +289,19 @@ int structureungappedalign(int argc, const char **argv, const Command& command)
         }
     }
 
-    free(tinySubMatAA);
-    free(tinySubMat3Di);
-
+#ifdef HAVE_MPI
+    dbw.close(true);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (MMseqsMPI::isMaster()) {
+        std::vector<std::pair<std::string, std::string>> splitFiles;
+        for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
+            splitFiles.push_back(Util::createTmpFileNames(par.db4, par.db4Index, proc));
+        }
+        DBWriter::mergeResults(par.db4, par.db4Index, splitFiles);
+    }
+#else
     dbw.close();
+#endif
     resultReader.close();
     if (sameDB == false) {
         delete t3DiDbr;
@@ -11,6 +11,7 @@
 #include "SubstitutionMatrix.h"
 #include "GemmiWrapper.h"
 #include "PulchraWrapper.h"
+#include "DescriptorFormat.h"
 
 #include <iostream>
 #include <dirent.h>
@@ -134,25 +135,9 @@ int structureto3didescriptor(int argc, const char **argv, const Command& command
                                                                &readStructure.c[chainStart],
                                                                &readStructure.cb[chainStart],
                                                                chainLen);
-                std::vector<StructureTo3Di::Feature> features = structureTo3Di.getFeatures();
                 result.clear();
-                result.append(header);
-                result.push_back('\t');
-                for (size_t j = 0; j < chainLen; j++) {
-                    result.push_back(readStructure.ami[chainStart+j]);
-                }
-                result.push_back('\t');
-                for (size_t j = 0; j < chainLen; j++) {
-                    result.push_back(mat.num2aa[(size_t)seq3di[j]]);
-                }
-                result.push_back('\t');
-                for (size_t j = 0; j < features.size(); j++) {
-                    for(size_t f = 0; f < Alphabet3Di::FEATURE_CNT; f++){
-                        result.append(SSTR(features[j].f[f]));
-                        result.push_back(',');
-                    }
-                }
-                result[result.size() - 1] = '\n';
+                DescriptorFormat::append(result, par.descriptorFormat, header.c_str(), header.size(), &readStructure.ami[chainStart],
+                                         seq3di, mat.num2aa, structureTo3Di, chainLen);
                 vec3di.writeData((const char*)result.data(), result.size(), dbKey, thread_idx, false);
             }
         }
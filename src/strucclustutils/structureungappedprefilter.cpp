@@ -0,0 +1,174 @@
+#include "DBReader.h"
+#include "IndexReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "Util.h"
+#include "LocalParameters.h"
+#include "QueryMatcher.h"
+#include "StructureSmithWaterman.h"
+#include "StructureUtil.h"
+#include "EvalueNeuralNet.h"
+#include "FastSort.h"
+#include "MMseqsMPI.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// Exhaustive k-mer free prefilter: every query is scored against every target with the best
+// ungapped 3Di+AA diagonal. Like ungappedprefilter the diagonal of the hits is not reported (0).
+int doStructureUngappedPrefilter(LocalParameters &par, IndexReader &qdbrAA, IndexReader &qdbr3Di,
+                                 DBWriter &resultWriter, size_t dbStart, size_t dbSize) {
+    const bool touch = (par.preloadMode != Parameters::PRELOAD_MODE_MMAP);
+    IndexReader *t3DiDbr = NULL;
+    IndexReader *tAADbr = NULL;
+    bool sameDB = false;
+    if (par.db1.compare(par.db2) == 0) {
+        sameDB = true;
+        t3DiDbr = &qdbr3Di;
+        tAADbr = &qdbrAA;
+    } else {
+        tAADbr = new IndexReader(par.db2, par.threads, IndexReader::SEQUENCES, touch ? IndexReader::PRELOAD_INDEX : 0);
+        t3DiDbr = new IndexReader(StructureUtil::getIndexWithSuffix(par.db2, "_ss"), par.threads, IndexReader::SEQUENCES, touch ? IndexReader::PRELOAD_INDEX : 0);
+    }
+
+    SubstitutionMatrix subMat3Di(par.scoringMatrixFile.values.aminoacid().c_str(), 2.1, par.scoreBias);
+    std::string blosum;
+    for (size_t i = 0; i < par.substitutionMatrices.size(); i++) {
+        if (par.substitutionMatrices[i].name == "blosum62.out") {
+            std::string matrixData((const char *)par.substitutionMatrices[i].subMatData, par.substitutionMatrices[i].subMatDataLen);
+            std::string matrixName = par.substitutionMatrices[i].name;
+            char * serializedMatrix = BaseMatrix::serialize(matrixName, matrixData);
+            blosum.assign(serializedMatrix);
+            free(serializedMatrix);
+            break;
+        }
+    }
+    SubstitutionMatrix subMatAA(blosum.c_str(), 1.4, par.scoreBias);
+
+    // sub. mat needed for query profile
+    int8_t * tinySubMatAA = (int8_t*) mem_align(ALIGN_INT, subMatAA.alphabetSize * 32);
+    int8_t * tinySubMat3Di = (int8_t*) mem_align(ALIGN_INT, subMat3Di.alphabetSize * 32);
+    for (int i = 0; i < subMat3Di.alphabetSize; i++) {
+        for (int j = 0; j < subMat3Di.alphabetSize; j++) {
+            tinySubMat3Di[i * subMat3Di.alphabetSize + j] = subMat3Di.subMatrix[i][j];
+        }
+    }
+    for (int i = 0; i < subMatAA.alphabetSize; i++) {
+        for (int j = 0; j < subMatAA.alphabetSize; j++) {
+            tinySubMatAA[i * subMatAA.alphabetSize + j] = subMatAA.subMatrix[i][j];
+        }
+    }
+
+    DBReader<unsigned int> *t3DiReader = t3DiDbr->sequenceReader;
+    DBReader<unsigned int> *tAAReader = tAADbr->sequenceReader;
+    Debug::Progress progress(dbSize);
+
+#pragma omp parallel
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+        char buffer[1024+32768];
+        std::vector<hit_t> shortResults;
+        shortResults.reserve(std::max(static_cast<size_t>(1), t3DiReader->getSize() / 5));
+        EvalueNeuralNet evaluer(tAAReader->getAminoAcidDBSize(), &subMat3Di);
+        StructureSmithWaterman aligner(par.maxSeqLen, subMat3Di.alphabetSize, par.compBiasCorrection, par.compBiasCorrectionScale);
+        Sequence qSeqAA(par.maxSeqLen, qdbrAA.getDbtype(), (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
+        Sequence qSeq3Di(par.maxSeqLen, qdbr3Di.getDbtype(), (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
+        Sequence tSeqAA(par.maxSeqLen, Parameters::DBTYPE_AMINO_ACIDS, (const BaseMatrix *) &subMatAA, 0, false, par.compBiasCorrection);
+        Sequence tSeq3Di(par.maxSeqLen, Parameters::DBTYPE_AMINO_ACIDS, (const BaseMatrix *) &subMat3Di, 0, false, par.compBiasCorrection);
+
+        std::string resultBuffer;
+        resultBuffer.reserve(262144);
+#pragma omp for schedule(dynamic, 1)
+        for (size_t id = dbStart; id < (dbStart + dbSize); id++) {
+            progress.updateProgress();
+            size_t queryKey = qdbr3Di.sequenceReader->getDbKey(id);
+            qSeq3Di.mapSequence(id, queryKey, *qdbr3Di.sequenceReader, id, thread_idx);
+            qSeqAA.mapSequence(id, queryKey, *qdbrAA.sequenceReader, id, thread_idx);
+            aligner.ssw_init(&qSeqAA, &qSeq3Di, tinySubMatAA, tinySubMat3Di, &subMatAA);
+            std::pair<double, double> muLambda = evaluer.predictMuLambda(qSeq3Di.numSequence, qSeq3Di.L);
+
+            for (size_t tId = 0; tId < t3DiReader->getSize(); tId++) {
+                unsigned int targetKey = t3DiReader->getDbKey(tId);
+                const bool isIdentity = (queryKey == targetKey && (par.includeIdentity || sameDB)) ? true : false;
+                const unsigned int targetSeqLen = t3DiReader->getSeqLen(tId);
+                if (Util::canBeCovered(par.covThr, par.covMode, qSeq3Di.L, targetSeqLen) == false) {
+                    continue;
+                }
+                tSeq3Di.mapSequence(tId, targetKey, *t3DiReader, tId, thread_idx);
+                tSeqAA.mapSequence(tId, targetKey, *tAAReader, tId, thread_idx);
+
+                int score = aligner.ungapped_alignment(tSeqAA.numSequence, tSeq3Di.numSequence, tSeq3Di.L);
+                bool hasDiagScore = (score > par.minDiagScoreThr);
+                double evalue = evaluer.computeEvalueCorr(score, muLambda.first, muLambda.second);
+                bool hasEvalue = (evalue <= par.evalThr);
+                if (isIdentity || (hasDiagScore && hasEvalue)) {
+                    hit_t hit;
+                    hit.seqId = targetKey;
+                    hit.prefScore = score;
+                    hit.diagonal = 0;
+                    shortResults.emplace_back(hit);
+                }
+            }
+
+            SORT_SERIAL(shortResults.begin(), shortResults.end(), hit_t::compareHitsByScoreAndId);
+            size_t maxSeqs = std::min(par.maxResListLen, shortResults.size());
+            for (size_t i = 0; i < maxSeqs; ++i) {
+                size_t len = QueryMatcher::prefilterHitToBuffer(buffer, shortResults[i]);
+                resultBuffer.append(buffer, len);
+            }
+
+            resultWriter.writeData(resultBuffer.c_str(), resultBuffer.length(), queryKey, thread_idx);
+            resultBuffer.clear();
+            shortResults.clear();
+        }
+    }
+
+    free(tinySubMatAA);
+    free(tinySubMat3Di);
+    if (sameDB == false) {
+        delete t3DiDbr;
+        delete tAADbr;
+    }
+    return EXIT_SUCCESS;
+}
+
+int structureungappedprefilter(int argc, const char **argv, const Command &command) {
+    MMseqsMPI::init(argc, argv);
+    LocalParameters &par = LocalParameters::getLocalInstance();
+    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_PREFILTER);
+
+    const bool touch = (par.preloadMode != Parameters::PRELOAD_MODE_MMAP);
+    IndexReader qdbrAA(par.db1, par.threads, IndexReader::SEQUENCES, touch ? IndexReader::PRELOAD_INDEX : 0);
+    IndexReader qdbr3Di(StructureUtil::getIndexWithSuffix(par.db1, "_ss"), par.threads, IndexReader::SEQUENCES, touch ? IndexReader::PRELOAD_INDEX : 0);
+
+#ifdef HAVE_MPI
+    size_t dbFrom = 0;
+    size_t dbSize = 0;
+    qdbr3Di.sequenceReader->decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
+    std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(par.db3, par.db3Index, MMseqsMPI::rank);
+    DBWriter resultWriter(tmpOutput.first.c_str(), tmpOutput.second.c_str(), par.threads, par.compressed, Parameters::DBTYPE_PREFILTER_RES);
+    resultWriter.open();
+    int status = doStructureUngappedPrefilter(par, qdbrAA, qdbr3Di, resultWriter, dbFrom, dbSize);
+    resultWriter.close();
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (MMseqsMPI::rank == 0) {
+        std::vector<std::pair<std::string, std::string>> splitFiles;
+        for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
+            std::pair<std::string, std::string> tmpFile = Util::createTmpFileNames(par.db3, par.db3Index, proc);
+            splitFiles.push_back(std::make_pair(tmpFile.first, tmpFile.second));
+        }
+        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles);
+    }
+#else
+    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_PREFILTER_RES);
+    resultWriter.open();
+    int status = doStructureUngappedPrefilter(par, qdbrAA, qdbr3Di, resultWriter, 0, qdbr3Di.sequenceReader->getSize());
+    resultWriter.close();
+#endif
+    return status;
+}
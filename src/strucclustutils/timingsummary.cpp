@@ -0,0 +1,14 @@
+#include "LocalParameters.h"
+#include "Debug.h"
+#include "Util.h"
+#include "TimingReport.h"
+
+// Last step of the workflows with --timing-report: sums the records of every module into one summary record.
+int timingsummary(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    TimingReport::summarize(par.db1);
+
+    return EXIT_SUCCESS;
+}
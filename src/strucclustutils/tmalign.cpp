@@ -10,6 +10,8 @@
 #include "StructureSmithWaterman.h"
 #include "TMaligner.h"
 #include "Coordinate16.h"
+#include "MMseqsMPI.h"
+#include "TimingReport.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -31,6 +33,7 @@ bool compareHitsByTMScore(const Matcher::result_t &first, const Matcher::result_
 
 
 int tmalign(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
     LocalParameters &par = LocalParameters::getLocalInstance();
     par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_ALIGN);
 
@@ -69,28 +72,45 @@ int tmalign(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter dbw(par.db4.c_str(), par.db4Index.c_str(), static_cast<unsigned int>(par.threads), par.compressed,  Parameters::DBTYPE_ALIGNMENT_RES);
+    size_t dbFrom = 0;
+    size_t dbSize = resultReader.getSize();
+    std::string outDb = par.db4;
+    std::string outDbIndex = par.db4Index;
+#ifdef HAVE_MPI
+    resultReader.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
+    std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(par.db4, par.db4Index, MMseqsMPI::rank);
+    outDb = tmpOutput.first;
+    outDbIndex = tmpOutput.second;
+#endif
+    int alignmentDbtype = Parameters::DBTYPE_ALIGNMENT_RES;
+    if (par.binaryAlignmentDb) {
+        alignmentDbtype = DBReader<unsigned int>::setExtendedDbtype(alignmentDbtype, Parameters::DBTYPE_EXTENDED_BINARY_ALIGNMENT);
+    }
+    DBWriter dbw(outDb.c_str(), outDbIndex.c_str(), static_cast<unsigned int>(par.threads), par.compressed, alignmentDbtype);
     dbw.open();
 
-    Debug::Progress progress(resultReader.getSize());
+    Debug::Progress progress(dbSize);
+    TimingReport timing(par.timingReport, par.threads);
 #pragma omp parallel
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
 #endif
+        TimingReport::Thread *threadTiming = timing.thread(thread_idx);
         TMaligner tmaln(std::max(qdbr.sequenceReader->getMaxSeqLen() + 1,tdbr->sequenceReader->getMaxSeqLen() + 1), par.tmAlignFast);
         std::vector<Matcher::result_t> swResults;
         swResults.reserve(300);
         std::string backtrace;
         std::string resultBuffer;
+        std::string queryBuffer;
         resultBuffer.reserve(1024*1024);
         Coordinate16 qcoords;
         Coordinate16 tcoords;
 
         char buffer[1024+32768];
 #pragma omp for schedule(dynamic, 1)
-        for (size_t id = 0; id < resultReader.getSize(); id++) {
+        for (size_t id = dbFrom; id < (dbFrom + dbSize); id++) {
             progress.updateProgress();
             char *data = resultReader.getData(id, thread_idx);
             if(*data != '\0') {
@@ -98,42 +118,80 @@ int tmalign(int argc, const char **argv, const Command& command) {
                 unsigned int queryId = qdbr.sequenceReader->getId(queryKey);
                 char *querySeq = qdbr.sequenceReader->getData(queryId, thread_idx);
                 int queryLen = static_cast<int>(qdbr.sequenceReader->getSeqLen(queryId));
+                // the target entries are decoded into the same buffer
+                if (sameDB && (qdbr.sequenceReader->isCompressed() || qdbr.sequenceReader->isPacked())) {
+                    queryBuffer.assign(querySeq, queryLen);
+                    querySeq = (char*) queryBuffer.c_str();
+                }
                 char *qcadata = qcadbr.sequenceReader->getData(queryId, thread_idx);
                 size_t qCaLength = qcadbr.sequenceReader->getEntryLen(queryId);
-                float* qdata = qcoords.read(qcadata, queryLen, qCaLength);
+                float* qdata;
+                {
+                    TimingReport::Scope scope(threadTiming, TimingReport::COORD_DECODE);
+                    qdata = qcoords.read(qcadata, queryLen, qCaLength);
+                }
                 tmaln.initQuery(qdata, &qdata[queryLen], &qdata[queryLen+queryLen], querySeq, queryLen);
 
                 int passedNum = 0;
                 int rejected = 0;
+                // next record if data points to a binary result block
+                size_t binaryPos = 0;
                 while (*data != '\0' && passedNum < par.maxAccept && rejected < par.maxRejected) {
-                    char dbKeyBuffer[255 + 1];
-                    Util::parseKey(data, dbKeyBuffer);
-                    data = Util::skipLine(data);
-                    const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+                    unsigned int dbKey;
+                    if (Matcher::isBinaryResultBlock(data)) {
+                        if (binaryPos >= Matcher::binaryResultCount(data)) {
+                            data = const_cast<char *>(Matcher::skipBinaryResultBlock(data));
+                            binaryPos = 0;
+                            continue;
+                        }
+                        dbKey = Matcher::binaryResultAt(data, binaryPos).dbKey;
+                        binaryPos++;
+                    } else {
+                        char dbKeyBuffer[255 + 1];
+                        Util::parseKey(data, dbKeyBuffer);
+                        data = Util::skipLine(data);
+                        dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+                    }
                     unsigned int targetId = tdbr->sequenceReader->getId(dbKey);
+                    TimingReport::count(threadTiming, TimingReport::PREFILTER_HITS);
                     const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameDB))? true : false;
                     if(isIdentity == true){
+                        TimingReport::count(threadTiming, TimingReport::ACCEPTED);
                         backtrace.append(SSTR(queryLen));
                         backtrace.append(1, 'M');
                         Matcher::result_t result(dbKey, 0 , 1.0, 1.0, 1.0, 1.0, std::max(queryLen,queryLen), 0, queryLen-1, queryLen, 0, queryLen-1, queryLen, backtrace);
-                        size_t len = Matcher::resultToBuffer(buffer, result, par.addBacktrace, false);
-                        resultBuffer.append(buffer, len);
+                        if (par.binaryAlignmentDb) {
+                            Matcher::resultsToBinaryBuffer(resultBuffer, std::vector<Matcher::result_t>(1, result), par.addBacktrace, false);
+                        } else {
+                            size_t len = Matcher::resultToBuffer(buffer, result, par.addBacktrace, false);
+                            resultBuffer.append(buffer, len);
+                        }
                         backtrace.clear();
                         continue;
                     }
                     char * targetSeq = tdbr->sequenceReader->getData(targetId, thread_idx);
                     int targetLen = static_cast<int>(tdbr->sequenceReader->getSeqLen(targetId));
                     if(Util::canBeCovered(par.covThr, par.covMode, queryLen, targetLen)==false){
+                        TimingReport::count(threadTiming, TimingReport::COVERAGE_REJECTED);
                         continue;
                     }
 
                     char *tcadata = tcadbr->sequenceReader->getData(targetId, thread_idx);
                     size_t tCaLength = tcadbr->sequenceReader->getEntryLen(targetId);
-                    float* tdata = tcoords.read(tcadata, targetLen, tCaLength);
+                    size_t tStride;
+                    float* tdata;
+                    {
+                        TimingReport::Scope scope(threadTiming, TimingReport::COORD_DECODE);
+                        tdata = tcoords.readAligned(tcadata, targetLen, tCaLength, tStride);
+                    }
 
                     // align here
                     float TMscore;
-                    Matcher::result_t result = tmaln.align(dbKey, tdata, &tdata[targetLen], &tdata[targetLen+targetLen], targetSeq, targetLen, TMscore);
+                    Matcher::result_t result;
+                    {
+                        TimingReport::Scope scope(threadTiming, TimingReport::TMSCORE);
+                        result = tmaln.align(dbKey, tdata, &tdata[tStride], &tdata[tStride+tStride], targetSeq, targetLen, TMscore);
+                    }
                     float qTM = (static_cast<float>(result.score) / 100000);
                     float tTM = result.eval;
                     switch(par.tmAlignHitOrder){
@@ -158,28 +216,53 @@ int tmalign(int argc, const char **argv, const Command& command) {
                     bool hasSeqId = result.seqId >= (par.seqIdThr - std::numeric_limits<float>::epsilon());
                     bool hasTMscore = (TMscore >= par.tmScoreThr);
                     if(hasCov && hasSeqId  && hasTMscore){
+                        TimingReport::count(threadTiming, TimingReport::ACCEPTED);
                         swResults.emplace_back(result);
                         passedNum++;
                         rejected = 0;
                     }else{
+                        TimingReport::count(threadTiming, TimingReport::THRESHOLD_REJECTED);
                         rejected++;
                     }
                 }
-                SORT_SERIAL(swResults.begin(), swResults.end(), compareHitsByTMScore);
+                {
+                    TimingReport::Scope scope(threadTiming, TimingReport::OUTPUT_FORMAT);
+                    SORT_SERIAL(swResults.begin(), swResults.end(), compareHitsByTMScore);
 
-                for(size_t i = 0; i < swResults.size(); i++){
-                    size_t len = Matcher::resultToBuffer(buffer, swResults[i], par.addBacktrace, false);
-                    resultBuffer.append(buffer, len);
+                    if (par.binaryAlignmentDb) {
+                        Matcher::resultsToBinaryBuffer(resultBuffer, swResults, par.addBacktrace, false);
+                    } else {
+                        for(size_t i = 0; i < swResults.size(); i++){
+                            size_t len = Matcher::resultToBuffer(buffer, swResults[i], par.addBacktrace, false);
+                            resultBuffer.append(buffer, len);
+                        }
+                    }
                 }
 
-                dbw.writeData(resultBuffer.c_str(), resultBuffer.size(), queryKey, thread_idx);
+                {
+                    TimingReport::Scope scope(threadTiming, TimingReport::IO_WAIT);
+                    dbw.writeData(resultBuffer.c_str(), resultBuffer.size(), queryKey, thread_idx);
+                }
                 resultBuffer.clear();
                 swResults.clear();
             }
         }
     }
+    timing.write("tmalign");
 
+#ifdef HAVE_MPI
+    dbw.close(true);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (MMseqsMPI::isMaster()) {
+        std::vector<std::pair<std::string, std::string>> splitFiles;
+        for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
+            splitFiles.push_back(Util::createTmpFileNames(par.db4, par.db4Index, proc));
+        }
+        DBWriter::mergeResults(par.db4, par.db4Index, splitFiles);
+    }
+#else
     dbw.close();
+#endif
     resultReader.close();
     if(sameDB == false){
         delete tdbr;
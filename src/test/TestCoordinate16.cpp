@@ -0,0 +1,122 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Coordinate16.h"
+#include "Debug.h"
+
+const char* binary_name = "test_coordinate16";
+
+// the packed entry keeps 10^-PACKED_EXPONENT Angstrom, so every decoded value is off by at most half of it
+static const float tolerance = 0.005f + 1e-4f;
+
+static bool close(float expected, float actual) {
+    if (std::isnan(expected)) {
+        return actual == 0.0f;
+    }
+    return std::fabs(expected - actual) <= tolerance;
+}
+
+// packs the chain and checks read and readAligned, returns false on a mismatch
+static bool roundTrip(const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z) {
+    const size_t len = x.size();
+    std::vector<int8_t> packed;
+    if (Coordinate16::convertToPackedDiff(len, x.data(), y.data(), z.data(), 1, packed) == false) {
+        Debug(Debug::ERROR) << "convertToPackedDiff failed for length " << len << "\n";
+        return false;
+    }
+    // DBWriter appends the '\0' that is part of the entry length
+    packed.push_back(0);
+    const char *mem = reinterpret_cast<const char *>(packed.data());
+    if (Coordinate16::isPackedDiff(len, packed.size()) == false) {
+        Debug(Debug::ERROR) << "Packed entry of length " << len << " is not detected as packed\n";
+        return false;
+    }
+
+    Coordinate16 coords;
+    const float *plain = coords.read(mem, len, packed.size());
+    for (size_t i = 0; i < len; i++) {
+        if (!close(x[i], plain[i]) || !close(y[i], plain[len + i]) || !close(z[i], plain[2 * len + i])) {
+            Debug(Debug::ERROR) << "read differs at residue " << i << " of " << len << "\n";
+            return false;
+        }
+    }
+    size_t stride;
+    const float *aligned = coords.readAligned(mem, len, packed.size(), stride);
+    for (size_t i = 0; i < len; i++) {
+        if (!close(x[i], aligned[i]) || !close(y[i], aligned[stride + i]) || !close(z[i], aligned[2 * stride + i])) {
+            Debug(Debug::ERROR) << "readAligned differs at residue " << i << " of " << len << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static void randomChain(size_t len, unsigned int &seed, std::vector<float> &x, std::vector<float> &y, std::vector<float> &z) {
+    x.resize(len);
+    y.resize(len);
+    z.resize(len);
+    float pos[3] = { -20.0f, 35.5f, 102.25f };
+    for (size_t i = 0; i < len; i++) {
+        for (size_t a = 0; a < 3; a++) {
+            // C-alpha atoms are about 3.8 Angstrom apart
+            pos[a] += (static_cast<float>(rand_r(&seed) % 4400) - 2200.0f) / 1000.0f;
+        }
+        x[i] = pos[0];
+        y[i] = pos[1];
+        z[i] = pos[2];
+    }
+}
+
+int main(int, const char**) {
+    unsigned int seed = 42;
+    std::vector<float> x, y, z;
+
+    // every tail length of the 16 residue blocks, shorter chains are not packed since the
+    // header of packed entries outweighs the savings
+    for (size_t len = 8; len <= 100; len++) {
+        randomChain(len, seed, x, y, z);
+        if (roundTrip(x, y, z) == false) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // chain breaks widen a single block, the following blocks have to go back to the narrow width
+    for (size_t breakPos = 1; breakPos < 40; breakPos += 3) {
+        randomChain(50, seed, x, y, z);
+        for (size_t i = breakPos; i < x.size(); i++) {
+            x[i] += 250.0f;
+            z[i] -= 180.0f;
+        }
+        if (roundTrip(x, y, z) == false) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // a missing residue is stored as 0 and must not shift the residues after it
+    randomChain(37, seed, x, y, z);
+    x[17] = NAN;
+    y[17] = NAN;
+    z[17] = NAN;
+    if (roundTrip(x, y, z) == false) {
+        return EXIT_FAILURE;
+    }
+
+    // single residues and coordinates beyond the quantization range are left to the 16-bit diff encoding
+    std::vector<int8_t> packed;
+    float one = 1.0f;
+    if (Coordinate16::convertToPackedDiff(1, &one, &one, &one, 1, packed)) {
+        Debug(Debug::ERROR) << "Single residue must not be packed\n";
+        return EXIT_FAILURE;
+    }
+    randomChain(20, seed, x, y, z);
+    x[10] = 1e8f;
+    if (Coordinate16::convertToPackedDiff(x.size(), x.data(), y.data(), z.data(), 1, packed)) {
+        Debug(Debug::ERROR) << "Out of range coordinate must not be packed\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Coordinate16 round trips passed\n";
+    return EXIT_SUCCESS;
+}
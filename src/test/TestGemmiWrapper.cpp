@@ -0,0 +1,156 @@
+// Checks that the PDB and mmCIF parsers of GemmiWrapper that skip building a gemmi::Structure read the
+// same chains, residues and coordinates as gemmi. Every structure given on the command line is compared
+// as is and after writing it with gemmi as PDB and mmCIF, with a second model, a second chain with
+// HETATM residues and insertion codes, alternative locations and CRLF line endings.
+// usage: test_gemmiwrapper example/*
+#define GEMMI_WRITE_IMPLEMENTATION
+#include "GemmiWrapper.h"
+#include "mmread.hpp"
+#include "polyheur.hpp"
+#include "to_cif.hpp"
+#include "to_mmcif.hpp"
+#include "to_pdb.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+const char* binary_name = "test_gemmiwrapper";
+
+static bool same(float a, float b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+static bool same(const Vec3 &a, const Vec3 &b) {
+    return same(a.x, b.x) && same(a.y, b.y) && same(a.z, b.z);
+}
+
+// loads the buffer with the fast parsers and with gemmi, returns false if the results differ
+// or the fast parsers reject a structure written by gemmi
+static bool compare(const std::string &buffer, const std::string &name) {
+    GemmiWrapper fast;
+    GemmiWrapper reference;
+    const int format = (int) gemmi::coor_format_from_ext(name);
+    if (fast.loadFast(buffer.c_str(), buffer.size(), name, format) == false) {
+        std::cerr << name << ": rejected by the fast parsers\n";
+        return false;
+    }
+    if (reference.loadFromBuffer(buffer.c_str(), buffer.size(), name, false) == false) {
+        std::cerr << name << ": cannot be read by gemmi\n";
+        return false;
+    }
+    bool equal = fast.title == reference.title && fast.names == reference.names
+                 && fast.chainNames == reference.chainNames && fast.chain == reference.chain
+                 && fast.ami == reference.ami && fast.ca.size() == reference.ca.size();
+    for (size_t i = 0; equal && i < fast.ca.size(); i++) {
+        equal = same(fast.ca[i], reference.ca[i]) && same(fast.cb[i], reference.cb[i])
+                && same(fast.n[i], reference.n[i]) && same(fast.c[i], reference.c[i])
+                && fast.ca_bfactor[i] == reference.ca_bfactor[i];
+    }
+    if (equal == false) {
+        std::cerr << name << ": fast parser differs from gemmi\n";
+    }
+    return equal;
+}
+
+static bool compareWritten(gemmi::Structure &st, const std::string &name) {
+    gemmi::setup_entities(st);
+    std::ostringstream pdb;
+    gemmi::write_pdb(st, pdb);
+    std::ostringstream cif;
+    gemmi::MmcifOutputGroups groups(true);
+    groups.group_pdb = true;
+    gemmi::cif::write_cif_to_stream(cif, gemmi::make_mmcif_document(st, groups), gemmi::cif::Style::Pdbx);
+
+    std::string crlf;
+    const std::string text = pdb.str();
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\n') {
+            crlf.push_back('\r');
+        }
+        crlf.push_back(text[i]);
+    }
+    return compare(pdb.str(), name + ".pdb") && compare(cif.str(), name + ".cif") && compare(crlf, name + "_crlf.pdb");
+}
+
+int main(int argc, const char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << binary_name << " <structure files>\n";
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; i++) {
+        const std::string file = argv[i];
+        std::ifstream in(file, std::ios::binary);
+        std::ostringstream original;
+        original << in.rdbuf();
+        // files without extension are read as PDB, like createdb does
+        const bool knownFormat = gemmi::coor_format_from_ext(file) != gemmi::CoorFormat::Unknown;
+        if (compare(original.str(), knownFormat ? file : file + ".pdb") == false) {
+            return EXIT_FAILURE;
+        }
+        gemmi::Structure st = gemmi::read_structure_file(file, gemmi::CoorFormat::Pdb);
+        if (st.models.empty() || st.models[0].chains.empty()) {
+            continue;
+        }
+        const std::string base = gemmi::path_basename(file, {});
+        st.info["_struct.title"] = "Test title for " + base;
+        if (compareWritten(st, base) == false) {
+            return EXIT_FAILURE;
+        }
+
+        gemmi::Structure models = st;
+        models.models.push_back(models.models[0]);
+        models.models[1].name = "2";
+        for (gemmi::Chain &ch : models.models[1].chains) {
+            for (gemmi::Residue &res : ch.residues) {
+                for (gemmi::Atom &atom : res.atoms) {
+                    atom.pos.x += 1.5;
+                }
+            }
+        }
+        if (compareWritten(models, base + "_models") == false) {
+            return EXIT_FAILURE;
+        }
+
+        gemmi::Structure chains = st;
+        gemmi::Chain second = chains.models[0].chains[0];
+        second.name = "B";
+        for (gemmi::Residue &res : second.residues) {
+            res.subchain = "B";
+            for (gemmi::Atom &atom : res.atoms) {
+                atom.pos.y -= 3.25;
+            }
+        }
+        if (second.residues.size() > 5) {
+            second.residues[3].name = "MSE";
+            second.residues[4].seqid.icode = 'A';
+            second.residues[4].het_flag = 'H';
+        }
+        chains.models[0].chains.push_back(second);
+        if (compareWritten(chains, base + "_chains") == false) {
+            return EXIT_FAILURE;
+        }
+
+        // the first alternative location of an atom is used
+        gemmi::Structure altloc = st;
+        for (gemmi::Residue &res : altloc.models[0].chains[0].residues) {
+            for (size_t j = 0; j < res.atoms.size(); j++) {
+                if (res.atoms[j].name == "CA") {
+                    gemmi::Atom other = res.atoms[j];
+                    res.atoms[j].altloc = 'A';
+                    other.altloc = 'B';
+                    other.pos.x += 0.5;
+                    res.atoms.insert(res.atoms.begin() + j + 1, other);
+                    break;
+                }
+            }
+        }
+        if (compareWritten(altloc, base + "_altloc") == false) {
+            return EXIT_FAILURE;
+        }
+    }
+    std::cout << "GemmiWrapper fast parsers match gemmi\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Debug.h"
+#include "PackedSequence.h"
+
+const char* binary_name = "test_packedsequence";
+
+static const char alphabet[] = "ACDEFGHIKLMNPQRSTVWYXBZJOU*-acdefghiklmnpqrstvwyxbzjou";
+
+// packs seq and checks that unpack and unpackCodes restore it, the SIMD loops handle 16 residues at
+// a time, so every length up to a few blocks covers a different tail
+static bool roundTrip(const std::string &seq) {
+    std::string packed;
+    if (PackedSequence::pack(seq.c_str(), seq.size(), packed) == false) {
+        Debug(Debug::ERROR) << "pack rejected " << seq << "\n";
+        return false;
+    }
+    if (packed.size() != PackedSequence::packedSize(seq.size())) {
+        Debug(Debug::ERROR) << "Wrong packed size for length " << seq.size() << "\n";
+        return false;
+    }
+
+    // guard bytes behind the output catch writes beyond len + 2
+    std::vector<char> unpacked(seq.size() + 2 + 16, 'G');
+    PackedSequence::unpack(packed.c_str(), seq.size(), unpacked.data());
+    if (std::string(unpacked.data(), seq.size()) != seq
+        || unpacked[seq.size()] != '\n' || unpacked[seq.size() + 1] != '\0'
+        || unpacked[seq.size() + 2] != 'G') {
+        Debug(Debug::ERROR) << "unpack failed for " << seq << "\n";
+        return false;
+    }
+
+    unsigned char table[32];
+    for (size_t i = 0; i < 32; i++) {
+        table[i] = static_cast<unsigned char>(100 + i);
+    }
+    std::vector<unsigned char> codes(seq.size() + 16, 0);
+    const size_t done = PackedSequence::unpackCodes(packed.c_str(), seq.size(), table, codes.data());
+    if (done % 16 != 0 || done > seq.size()) {
+        Debug(Debug::ERROR) << "unpackCodes returned " << done << " for length " << seq.size() << "\n";
+        return false;
+    }
+    for (size_t i = 0; i < seq.size(); i++) {
+        const char upper = static_cast<char>(seq[i] >= 'a' && seq[i] <= 'z' ? seq[i] - 'a' + 'A' : seq[i]);
+        if (PackedSequence::letters()[codes[i] - 100] != upper) {
+            Debug(Debug::ERROR) << "unpackCodes failed at " << i << " for " << seq << "\n";
+            return false;
+        }
+    }
+    if (codes[seq.size()] != 0) {
+        Debug(Debug::ERROR) << "unpackCodes wrote beyond length " << seq.size() << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int, const char**) {
+    unsigned int seed = 42;
+    for (size_t len = 0; len <= 130; len++) {
+        std::string seq;
+        for (size_t i = 0; i < len; i++) {
+            seq.push_back(alphabet[rand_r(&seed) % (sizeof(alphabet) - 1)]);
+        }
+        if (roundTrip(seq) == false) {
+            return EXIT_FAILURE;
+        }
+        // long runs of unmasked and masked residues
+        if (roundTrip(std::string(len, 'W')) == false || roundTrip(std::string(len, 'y')) == false) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    const char *invalid[] = { "ACD1", "AC D", "ACD\n", "\xC3\x84" };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        std::string packed = "prefix";
+        if (PackedSequence::pack(invalid[i], strlen(invalid[i]), packed) || packed != "prefix") {
+            Debug(Debug::ERROR) << "pack accepted invalid sequence " << invalid[i] << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "PackedSequence round trips passed\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#include <cstdlib>
+#include <vector>
+
+#include "UngappedDiagonal.h"
+#include "Debug.h"
+
+const char* binary_name = "test_ungappeddiagonal";
+
+static const int alphabetSize = 4;
+
+// best local ungapped score of query position i against target position i - diagonal,
+// with the query read from its last residue if reversed
+static int bruteForceScore(const std::vector<unsigned char> &q3Di, const std::vector<unsigned char> &qAA,
+                           const std::vector<unsigned char> &t3Di, const std::vector<unsigned char> &tAA,
+                           int diagonal, bool reversed, short **sub3DiMat, short **subAAMat) {
+    const int qLen = static_cast<int>(q3Di.size());
+    const int tLen = static_cast<int>(t3Di.size());
+    int best = 0;
+    int score = 0;
+    for (int i = 0; i < qLen; i++) {
+        const int j = i - diagonal;
+        if (j < 0 || j >= tLen) {
+            continue;
+        }
+        const int q = reversed ? qLen - 1 - i : i;
+        score += sub3DiMat[q3Di[q]][t3Di[j]] + subAAMat[qAA[q]][tAA[j]];
+        score = std::max(score, 0);
+        best = std::max(best, score);
+    }
+    return best;
+}
+
+static std::vector<unsigned char> randomSequence(int len) {
+    std::vector<unsigned char> seq(len);
+    for (int i = 0; i < len; i++) {
+        seq[i] = static_cast<unsigned char>(rand() % alphabetSize);
+    }
+    return seq;
+}
+
+int main(int, const char**) {
+    short sub3Di[alphabetSize][alphabetSize];
+    short subAA[alphabetSize][alphabetSize];
+    short *sub3DiMat[alphabetSize];
+    short *subAAMat[alphabetSize];
+    for (int i = 0; i < alphabetSize; i++) {
+        for (int j = 0; j < alphabetSize; j++) {
+            sub3Di[i][j] = (i == j) ? 4 : -2;
+            subAA[i][j] = (i == j) ? 2 : -1 - (i + j) % 2;
+        }
+        sub3DiMat[i] = sub3Di[i];
+        subAAMat[i] = subAA[i];
+    }
+
+    srand(1);
+    size_t checked = 0;
+    for (int iter = 0; iter < 2000; iter++) {
+        const int qLen = 1 + rand() % 60;
+        const int tLen = 1 + rand() % 60;
+        std::vector<unsigned char> q3Di = randomSequence(qLen);
+        std::vector<unsigned char> qAA = randomSequence(qLen);
+        std::vector<unsigned char> t3Di = randomSequence(tLen);
+        std::vector<unsigned char> tAA = randomSequence(tLen);
+        std::vector<unsigned char> qRev3Di(q3Di.rbegin(), q3Di.rend());
+        std::vector<unsigned char> qRevAA(qAA.rbegin(), qAA.rend());
+
+        for (int diagonal = -(tLen + 1); diagonal <= qLen + 1; diagonal++) {
+            DistanceCalculator::LocalAlignment forward;
+            DistanceCalculator::LocalAlignment reverse;
+            const bool onDiagonal = UngappedDiagonal::alignDiagonal(q3Di.data(), qAA.data(), qRev3Di.data(), qRevAA.data(), qLen,
+                                                                    t3Di.data(), tAA.data(), tLen, diagonal,
+                                                                    sub3DiMat, subAAMat, forward, reverse);
+            if (onDiagonal != (diagonal > -tLen && diagonal < qLen)) {
+                Debug(Debug::ERROR) << "Diagonal " << diagonal << " of a " << qLen << "x" << tLen << " matrix is "
+                                    << (onDiagonal ? "" : "not ") << "accepted\n";
+                return EXIT_FAILURE;
+            }
+            if (onDiagonal == false) {
+                continue;
+            }
+            const int expectedForward = bruteForceScore(q3Di, qAA, t3Di, tAA, diagonal, false, sub3DiMat, subAAMat);
+            const int expectedReverse = bruteForceScore(q3Di, qAA, t3Di, tAA, diagonal, true, sub3DiMat, subAAMat);
+            if (static_cast<int>(forward.score) != expectedForward || static_cast<int>(reverse.score) != expectedReverse) {
+                Debug(Debug::ERROR) << "Diagonal " << diagonal << " of a " << qLen << "x" << tLen << " matrix scores "
+                                    << forward.score << "/" << reverse.score << " instead of "
+                                    << expectedForward << "/" << expectedReverse << "\n";
+                return EXIT_FAILURE;
+            }
+            const int expectedLen = std::min(qLen - std::max(diagonal, 0), tLen - std::max(-diagonal, 0));
+            if (static_cast<int>(forward.diagonalLen) != expectedLen) {
+                Debug(Debug::ERROR) << "Diagonal " << diagonal << " has length " << forward.diagonalLen
+                                    << " instead of " << expectedLen << "\n";
+                return EXIT_FAILURE;
+            }
+            // the alignment ends on a residue pair inside the diagonal that accounts for its score
+            if (forward.score > 0) {
+                int score = 0;
+                for (int pos = forward.startPos; pos <= forward.endPos; pos++) {
+                    const int i = pos + std::max(diagonal, 0);
+                    const int j = pos + std::max(-diagonal, 0);
+                    score += sub3DiMat[q3Di[i]][t3Di[j]] + subAAMat[qAA[i]][tAA[j]];
+                }
+                if (forward.startPos < 0 || forward.endPos >= expectedLen || score != static_cast<int>(forward.score)) {
+                    Debug(Debug::ERROR) << "Alignment " << forward.startPos << "-" << forward.endPos << " on diagonal "
+                                        << diagonal << " does not give score " << forward.score << "\n";
+                    return EXIT_FAILURE;
+                }
+            }
+            checked++;
+        }
+    }
+    Debug(Debug::INFO) << "Checked " << checked << " diagonals\n";
+    return EXIT_SUCCESS;
+}
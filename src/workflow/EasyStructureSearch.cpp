@@ -9,6 +9,17 @@
 #include "Parameters.h"
 #include "easystructuresearch.sh.h"
 
+#define XXH_INLINE_ALL
+#include "xxhash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+extern const char* version;
+
 void setEasyStructureSearchDefaults(Parameters *p) {
     // TODO: 7-mer sensitivity is not optimized yet
     p->kmerSize = 6;
@@ -33,6 +44,120 @@ void setEasyStructureSearchMustPassAlong(Parameters *p) {
     p->PARAM_REMOVE_TMP_FILES.wasSet = true;
 }
 
+// Key of the query cache entry: the foldseek version, the names and contents of the query files and the createdb parameters.
+// Returns false for inputs that cannot be hashed up front (stdin, directories and databases).
+static bool hashQueryFiles(const std::vector<std::string> &files, const std::string &createdbPar, std::string &key) {
+    XXH64_state_t *state = XXH64_createState();
+    XXH64_reset(state, 0);
+    // the database format can change between versions
+    XXH64_update(state, version, strlen(version) + 1);
+    XXH64_update(state, createdbPar.c_str(), createdbPar.size());
+    std::vector<char> buffer(1024 * 1024);
+    bool success = true;
+    for (size_t i = 0; i < files.size() && success; ++i) {
+        if (files[i] == "stdin" || FileUtil::directoryExists(files[i].c_str())
+            || FileUtil::fileExists((files[i] + ".dbtype").c_str())) {
+            success = false;
+            break;
+        }
+        // headers are derived from the file names
+        std::string name = FileUtil::baseName(files[i]);
+        XXH64_update(state, name.c_str(), name.size() + 1);
+        FILE *handle = fopen(files[i].c_str(), "rb");
+        if (handle == NULL) {
+            success = false;
+            break;
+        }
+        size_t read;
+        while ((read = fread(buffer.data(), sizeof(char), buffer.size(), handle)) > 0) {
+            XXH64_update(state, buffer.data(), read);
+        }
+        success = ferror(handle) == 0;
+        fclose(handle);
+    }
+    key = SSTR(XXH64_digest(state));
+    XXH64_freeState(state);
+    return success;
+}
+
+static void removeCacheEntry(const std::string &entry) {
+    DIR *dir = opendir(entry.c_str());
+    if (dir == NULL) {
+        return;
+    }
+    while (dirent *file = readdir(dir)) {
+        std::string name(file->d_name);
+        if (name != "." && name != "..") {
+            FileUtil::remove((entry + "/" + name).c_str());
+        }
+    }
+    closedir(dir);
+    rmdir(entry.c_str());
+}
+
+// Removes the least recently used entries until the cache fits into maxSize.
+// Entries without a dbtype file are still being written by another run and are only removed after a day.
+// The entry of the current run and entries used within the last hour are kept, since other runs sharing
+// the cache directory read them in every step of their search.
+static void evictQueryCache(const std::string &cacheDir, size_t maxSize, const std::string &currentEntry) {
+    struct CacheEntry {
+        time_t lastUse;
+        size_t size;
+        std::string path;
+        bool operator<(const CacheEntry &other) const {
+            return lastUse < other.lastUse;
+        }
+    };
+    std::vector<CacheEntry> entries;
+    size_t totalSize = 0;
+    const time_t now = time(NULL);
+    DIR *dir = opendir(cacheDir.c_str());
+    if (dir == NULL) {
+        return;
+    }
+    while (dirent *entryDir = readdir(dir)) {
+        std::string name(entryDir->d_name);
+        if (name == "." || name == "..") {
+            continue;
+        }
+        CacheEntry entry;
+        entry.path = cacheDir + "/" + name;
+        struct stat st;
+        if (stat(entry.path.c_str(), &st) != 0 || S_ISDIR(st.st_mode) == false) {
+            continue;
+        }
+        entry.lastUse = st.st_mtime;
+        const bool complete = FileUtil::fileExists((entry.path + "/query.dbtype").c_str());
+        if (complete == false && now - entry.lastUse < 24 * 60 * 60) {
+            continue;
+        }
+        const bool inUse = entry.path == currentEntry || now - entry.lastUse < 60 * 60;
+        entry.size = 0;
+        DIR *files = opendir(entry.path.c_str());
+        if (files == NULL) {
+            continue;
+        }
+        while (dirent *file = readdir(files)) {
+            if (stat((entry.path + "/" + file->d_name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                entry.size += st.st_size;
+            }
+        }
+        closedir(files);
+        totalSize += entry.size;
+        if (inUse == false) {
+            entries.emplace_back(entry);
+        }
+    }
+    closedir(dir);
+
+    std::sort(entries.begin(), entries.end());
+    for (size_t i = 0; i < entries.size() && totalSize > maxSize; ++i) {
+        Debug(Debug::INFO) << "Evicting query cache entry " << entries[i].path << "\n";
+        removeCacheEntry(entries[i].path);
+        totalSize -= entries[i].size;
+    }
+}
+
 int easystructuresearch(int argc, const char **argv, const Command &command) {
     LocalParameters &par = LocalParameters::getLocalInstance();
     par.PARAM_ADD_BACKTRACE.addCategory(MMseqsParameter::COMMAND_EXPERT);
@@ -120,8 +245,39 @@ int easystructuresearch(int argc, const char **argv, const Command &command) {
 
     cmd.addVariable("RUNNER", par.runner.c_str());
     cmd.addVariable("VERBOSITY", par.createParameterString(par.onlyverbosity).c_str());
+    cmd.addVariable("TIMING_REPORT", par.timingReport.empty() ? NULL : par.timingReport.c_str());
 
     cmd.addVariable("CREATEDB_PAR", par.createParameterString(par.structurecreatedb).c_str());
+
+    std::string queryCacheEntry;
+    if (par.queryCache.empty() == false) {
+        // the number of threads and the verbosity do not change the query database
+        std::vector<MMseqsParameter*> createdbKeyPar;
+        for (size_t i = 0; i < par.structurecreatedb.size(); ++i) {
+            if (par.structurecreatedb[i] != &par.PARAM_THREADS && par.structurecreatedb[i] != &par.PARAM_V) {
+                createdbKeyPar.push_back(par.structurecreatedb[i]);
+            }
+        }
+        std::string key;
+        if (hashQueryFiles(par.filenames, par.createParameterString(createdbKeyPar), key) == false) {
+            Debug(Debug::INFO) << "Query cache is not used for stdin, directory or database input\n";
+        } else {
+            if (FileUtil::directoryExists(par.queryCache.c_str()) == false && FileUtil::makeDir(par.queryCache.c_str()) == false) {
+                Debug(Debug::ERROR) << "Cannot create query cache directory " << par.queryCache << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            queryCacheEntry = par.queryCache + "/" + key;
+            if (FileUtil::fileExists((queryCacheEntry + "/query.dbtype").c_str())) {
+                Debug(Debug::INFO) << "Using cached query database " << queryCacheEntry << "/query\n";
+                // the modification time orders the entries for eviction
+                utime(queryCacheEntry.c_str(), NULL);
+            }
+            if (par.queryCacheSize > 0) {
+                evictQueryCache(par.queryCache, par.queryCacheSize, queryCacheEntry);
+            }
+        }
+    }
+    cmd.addVariable("QUERY_CACHE", queryCacheEntry.empty() ? NULL : queryCacheEntry.c_str());
     cmd.addVariable("CONVERT_PAR", par.createParameterString(par.convertalignments).c_str());
     cmd.addVariable("SUMMARIZE_PAR", par.createParameterString(par.summarizeresult).c_str());
 
@@ -95,6 +95,11 @@ int structurecluster(int argc, const char **argv, const Command& command) {
 
     setStructuralClusterAutomagicParameters(par);
 
+    // the steps append their records to the timing report
+    if (par.timingReport.empty() == false && FileUtil::fileExists(par.timingReport.c_str())) {
+        FileUtil::remove(par.timingReport.c_str());
+    }
+
     std::string tmpDir = par.db3;
     std::string hash = SSTR(par.hashParameter(command.databases, par.filenames, par.clusterworkflow));
     if (par.reuseLatest) {
@@ -122,6 +127,7 @@ int structurecluster(int argc, const char **argv, const Command& command) {
     cmd.addVariable("RUNNER", par.runner.c_str());
     cmd.addVariable("MERGECLU_PAR", par.createParameterString(par.threadsandcompression).c_str());
     cmd.addVariable("VERBOSITY", par.createParameterString(par.onlyverbosity).c_str());
+    cmd.addVariable("TIMING_REPORT", par.timingReport.empty() ? NULL : par.timingReport.c_str());
     cmd.addVariable("VERBOSITYANDCOMPRESS", par.createParameterString(par.threadsandcompression).c_str());
 
     // Linclust parameter
@@ -130,7 +136,7 @@ int structurecluster(int argc, const char **argv, const Command& command) {
     //par.alphabetSize = 14;
     //par.kmerSize = 10;
     //par.spacedKmer = 1;
-    cmd.addVariable("KMERMATCHER_PAR", par.createParameterString(par.kmermatcher).c_str());
+    cmd.addVariable("KMERMATCHER_PAR", par.createParameterString(par.structurekmermatcher).c_str());
 
     cmd.addVariable("CLUSTER_PAR", par.createParameterString(par.clust).c_str());
     cmd.addVariable("ALIGNMENT_PAR", alnParam.c_str());
@@ -188,7 +194,11 @@ int structurecluster(int argc, const char **argv, const Command& command) {
         par.covMode = swapedCovMode;
         cmd.addVariable("PREFILTER_REASSIGN_PAR", par.createParameterString(par.prefilter).c_str());
         par.covMode = tmpCovMode;
+        // the reassignment alignment is read by filterdb, which only understands text results
+        int binaryAlignmentDb = par.binaryAlignmentDb;
+        par.binaryAlignmentDb = 0;
         cmd.addVariable("ALIGNMENT_REASSIGN_PAR", par.createParameterString(par.structurealign).c_str());
+        par.binaryAlignmentDb = binaryAlignmentDb;
         cmd.addVariable("MERGEDBS_PAR", par.createParameterString(par.mergedbs).c_str());
 
         std::string program = tmpDir + "/clustering.sh";
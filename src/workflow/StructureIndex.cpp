@@ -37,7 +37,7 @@ int structureindex(int argc, const char **argv, const Command& command) {
     setStructureSearchMustPassAlong(&par);
 
     std::string tmpDir = par.db2;
-    std::string hash = SSTR(par.hashParameter(command.databases, par.filenames, par.createindex));
+    std::string hash = SSTR(par.hashParameter(command.databases, par.filenames, par.structurecreateindex));
     if (par.reuseLatest) {
         hash = FileUtil::getHashFromSymLink(tmpDir + "/latest");
     }
@@ -57,6 +57,8 @@ int structureindex(int argc, const char **argv, const Command& command) {
     cmd.addVariable("CREATEINDEX_PAR", par.createParameterString(createIndexWithoutIndexSubset, true).c_str());
     cmd.addVariable("VERBOSITY_PAR", par.createParameterString(par.onlyverbosity).c_str());
     cmd.addVariable("INDEX_DB_CA_KEY", SSTR(LocalParameters::INDEX_DB_CA_KEY).c_str());
+    cmd.addVariable("INDEX_PADDED_CA", par.indexPaddedCa ? "TRUE" : NULL);
+    cmd.addVariable("THREADS_PAR", par.createParameterString(par.onlythreads).c_str());
 
     std::string program(tmpDir + "/structureindex.sh");
     FileUtil::writeFile(program, structureindex_sh, structureindex_sh_len);
@@ -55,6 +55,9 @@ int structurerbh(int argc, const char **argv, const Command &command) {
     par.filenames.pop_back();
     par.filenames.push_back(tmpDir);
 
+    // the results are read by filterdb and result2rbh, which only understand text results
+    par.binaryAlignmentDb = 0;
+
     CommandCaller cmd;
     cmd.addVariable("SEARCH_A_B_PAR", par.createParameterString(par.structuresearchworkflow).c_str());
     int originalCovMode = par.covMode;
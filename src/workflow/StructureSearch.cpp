@@ -78,6 +78,11 @@ int structuresearch(int argc, const char **argv, const Command &command) {
     }
 
 
+    // the steps append their records to the timing report
+    if (par.timingReport.empty() == false && FileUtil::fileExists(par.timingReport.c_str())) {
+        FileUtil::remove(par.timingReport.c_str());
+    }
+
     std::string tmpDir = par.filenames.back();
     std::string hash = SSTR(par.hashParameter(command.databases, par.filenames, *command.params));
     if (par.reuseLatest) {
@@ -91,10 +96,19 @@ int structuresearch(int argc, const char **argv, const Command &command) {
     cmd.addVariable("RESULTS", par.filenames.back().c_str());
     par.filenames.pop_back();
     std::string target = par.filenames.back().c_str();
-    cmd.addVariable("TARGET_PREFILTER", (target+"_ss").c_str());
     par.filenames.pop_back();
     std::string query = par.filenames.back().c_str();
-    cmd.addVariable("QUERY_PREFILTER", (query+"_ss").c_str());
+    // structureprefilter is opt-in with --prefilter-aa 1, the profile searches of the iterative search stay 3Di only
+    if (par.prefilterAA == 0 || par.alignmentType == LocalParameters::ALIGNMENT_TYPE_3DI || par.numIterations > 1) {
+        cmd.addVariable("PREFILTER_ALGO", "prefilter");
+        cmd.addVariable("TARGET_PREFILTER", (target+"_ss").c_str());
+        cmd.addVariable("QUERY_PREFILTER", (query+"_ss").c_str());
+    } else {
+        // k-mer matching on 3Di, ungapped diagonal scores on 3Di+AA
+        cmd.addVariable("PREFILTER_ALGO", "structureprefilter");
+        cmd.addVariable("TARGET_PREFILTER", target.c_str());
+        cmd.addVariable("QUERY_PREFILTER", query.c_str());
+    }
 
     const bool isIndex = PrefilteringIndexReader::searchForIndex(target).empty() == false;
     cmd.addVariable("INDEXEXT", isIndex ? ".idx" : NULL);
@@ -124,7 +138,10 @@ int structuresearch(int argc, const char **argv, const Command &command) {
     cmd.addVariable("REMOVE_TMP", par.removeTmpFiles ? "TRUE" : NULL);
     cmd.addVariable("RUNNER", par.runner.c_str());
     cmd.addVariable("VERBOSITY", par.createParameterString(par.onlyverbosity).c_str());
+    cmd.addVariable("TIMING_REPORT", par.timingReport.empty() ? NULL : par.timingReport.c_str());
     if(par.numIterations > 1){
+        // subtractdbs only reads text results
+        par.binaryAlignmentDb = 0;
         double originalEval = par.evalThr;
         par.evalThr = (par.evalThr < par.evalProfile) ? par.evalThr  : par.evalProfile;
         for (int i = 0; i < par.numIterations; i++) {